@@ -0,0 +1,144 @@
+﻿#include "CppUnitTest.h"
+
+#include <string>
+
+#include <YY/Base/Memory/Arena.h>
+#include <YY/Base/Containers/Array.h>
+#include <YY/Base/Strings/String.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(ArenaUnitTest)
+    {
+    public:
+        TEST_METHOD(基础分配与Reset)
+        {
+            Arena _oArena(1024);
+
+            auto _p1 = (byte_t*)_oArena.Alloc(100);
+            auto _p2 = (byte_t*)_oArena.Alloc(100);
+            Assert::IsNotNull(_p1);
+            Assert::IsNotNull(_p2);
+            Assert::IsTrue(_p2 >= _p1 + 100);
+            Assert::AreEqual(size_t(_p1) % alignof(std::max_align_t), size_t(0));
+
+            // 最后一块内存可以原地扩展
+            Assert::IsTrue(_oArena.TryExtend(_p2, 100, 200));
+            Assert::IsFalse(_oArena.TryExtend(_p1, 100, 200));
+
+            // 超过块大小的分配
+            auto _pLarge = _oArena.Alloc(4096);
+            Assert::IsNotNull(_pLarge);
+            memset(_pLarge, 0xCC, 4096);
+
+            // Reset 后复用第一个块
+            _oArena.Reset();
+            Assert::IsTrue((byte_t*)_oArena.Alloc(100) == _p1);
+        }
+
+        TEST_METHOD(显式使用Arena的容器)
+        {
+            Arena _oArena;
+
+            Array<int> _arrData(_oArena);
+            for (int i = 0; i != 1000; ++i)
+                Assert::IsTrue(SUCCEEDED(_arrData.Add(i)));
+
+            for (int i = 0; i != 1000; ++i)
+                Assert::AreEqual(_arrData[i], i);
+
+            aString _szData(_oArena);
+            for (int i = 0; i != 100; ++i)
+                Assert::IsTrue(SUCCEEDED(_szData.AppendString("0123456789")));
+            Assert::AreEqual(_szData.GetSize(), size_t(1000));
+
+            // 写时复制产生的新缓冲区依然来自同一个 Arena
+            Array<int> _arrShared = _arrData;
+            Assert::IsTrue(SUCCEEDED(_arrShared.Add(1000)));
+            Assert::AreEqual(_arrShared.GetSize(), size_t(1001));
+            Assert::AreEqual(_arrData.GetSize(), size_t(1000));
+
+            _arrData.Clear();
+            _arrShared.Clear();
+            _szData.Clear();
+            _oArena.Reset();
+        }
+
+        TEST_METHOD(外部容器在Arena使用期间扩容后Reset)
+        {
+            Arena _oArena;
+            // 使用 Arena 之前为空的容器，不能因为在 Arena 容器的使用期间扩容而被 Arena 捕获
+            Array<int> _arrOutside;
+            Array<std::string> _arrStrings;
+            aString _szOutside;
+
+            {
+                Array<int> _arrTemp(_oArena);
+                aString _szTemp(_oArena);
+                for (int i = 0; i != 1000; ++i)
+                {
+                    Assert::IsTrue(SUCCEEDED(_arrTemp.Add(i)));
+                    Assert::IsTrue(SUCCEEDED(_arrOutside.Add(i)));
+                    Assert::IsTrue(SUCCEEDED(_arrStrings.Add(std::string(64, char('a' + i % 26)))));
+                    Assert::IsTrue(SUCCEEDED(_szTemp.AppendChar('x')));
+                    Assert::IsTrue(SUCCEEDED(_szOutside.AppendChar(char('a' + i % 26))));
+                }
+            }
+
+            // 覆盖 Arena 中的内存，如果外部容器错误地使用了 Arena，后续访问将读到被破坏的数据
+            _oArena.Reset();
+            for (int i = 0; i != 1024; ++i)
+            {
+                auto _pGarbage = _oArena.Alloc(4096);
+                Assert::IsNotNull(_pGarbage);
+                memset(_pGarbage, 0xCC, 4096);
+            }
+            _oArena.Reset();
+
+            Assert::AreEqual(_arrOutside.GetSize(), size_t(1000));
+            Assert::AreEqual(_arrStrings.GetSize(), size_t(1000));
+            Assert::AreEqual(_szOutside.GetSize(), size_t(1000));
+            for (int i = 0; i != 1000; ++i)
+            {
+                Assert::AreEqual(_arrOutside[i], i);
+                Assert::IsTrue(_arrStrings[i] == std::string(64, char('a' + i % 26)));
+                Assert::AreEqual(_szOutside[i], char('a' + i % 26));
+            }
+
+            // 外部容器在 Reset 之后继续扩容
+            Assert::IsTrue(SUCCEEDED(_arrOutside.Add(1000)));
+            Assert::AreEqual(_arrOutside[1000], 1000);
+        }
+
+        TEST_METHOD(在Arena中创建RefValue)
+        {
+            struct TestObject : public RefValue
+            {
+                bool* pbDestroyed;
+
+                TestObject(bool* _pbDestroyed)
+                    : pbDestroyed(_pbDestroyed)
+                {
+                }
+
+                ~TestObject()
+                {
+                    *pbDestroyed = true;
+                }
+            };
+
+            Arena _oArena;
+            bool _bDestroyed = false;
+            {
+                auto _pObject = _oArena.Create<TestObject>(&_bDestroyed);
+                Assert::IsNotNull(_pObject.Get());
+                Assert::IsFalse(_bDestroyed);
+            }
+            Assert::IsTrue(_bDestroyed);
+            _oArena.Reset();
+        }
+    };
+}
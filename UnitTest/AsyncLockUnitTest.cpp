@@ -0,0 +1,133 @@
+﻿#include "CppUnitTest.h"
+
+#include <YY/Base/Threading/AsyncLock.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(AsyncLockUnitTest)
+    {
+    public:
+        TEST_METHOD(互斥锁先进先出)
+        {
+            AsyncMutex _oMutex;
+            auto _oFirst = _oMutex.LockAsync();
+            auto _oSecond = _oMutex.LockAsync();
+            auto _oThird = _oMutex.LockAsync();
+
+            Assert::IsTrue(_oFirst.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oSecond.GetStatus() == AsyncStatus::Started);
+            Assert::IsTrue(_oThird.GetStatus() == AsyncStatus::Started);
+            Assert::IsFalse(_oMutex.TryLock());
+
+            _oMutex.Unlock();
+            Assert::IsTrue(_oSecond.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oThird.GetStatus() == AsyncStatus::Started);
+
+            _oMutex.Unlock();
+            Assert::IsTrue(_oThird.GetStatus() == AsyncStatus::Completed);
+
+            _oMutex.Unlock();
+            Assert::IsTrue(_oMutex.TryLock());
+            _oMutex.Unlock();
+        }
+
+        TEST_METHOD(无竞争时不申请内存)
+        {
+            AsyncMutex _oMutex;
+            auto _oFirst = _oMutex.LockAsync();
+            _oMutex.Unlock();
+            auto _oSecond = _oMutex.LockAsync();
+            _oMutex.Unlock();
+
+            // 同步完成，不存在可以被其他调用者取消的共享 AsyncOperation
+            Assert::IsTrue(_oFirst.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oFirst.GetAsyncOperation() == nullptr);
+            Assert::IsTrue(_oSecond.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oSecond.GetAsyncOperation() == nullptr);
+        }
+
+        TEST_METHOD(信号量)
+        {
+            AsyncSemaphore _oSemaphore(2);
+            Assert::IsTrue(_oSemaphore.TryWait());
+            Assert::IsTrue(_oSemaphore.WaitAsync().GetStatus() == AsyncStatus::Completed);
+
+            auto _oFirst = _oSemaphore.WaitAsync();
+            auto _oSecond = _oSemaphore.WaitAsync();
+            Assert::IsTrue(_oFirst.GetStatus() == AsyncStatus::Started);
+
+            _oSemaphore.Release(3);
+            Assert::IsTrue(_oFirst.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oSecond.GetStatus() == AsyncStatus::Completed);
+
+            // 剩余一个许可
+            Assert::IsTrue(_oSemaphore.TryWait());
+            Assert::IsFalse(_oSemaphore.TryWait());
+        }
+
+        TEST_METHOD(取消的等待者不占用许可)
+        {
+            AsyncMutex _oMutex;
+            Assert::IsTrue(_oMutex.TryLock());
+            auto _oCanceled = _oMutex.LockAsync();
+            auto _oWaiter = _oMutex.LockAsync();
+            Assert::IsTrue(_oCanceled.GetAsyncOperation()->Cancel());
+
+            // 许可跳过已经取消的等待者
+            _oMutex.Unlock();
+            Assert::IsTrue(_oWaiter.GetStatus() == AsyncStatus::Completed);
+            _oMutex.Unlock();
+            Assert::IsTrue(_oMutex.TryLock());
+            _oMutex.Unlock();
+
+            AsyncReaderWriterLock _oLock;
+            Assert::IsTrue(_oLock.TryLock());
+            auto _oCanceledReader = _oLock.LockSharedAsync();
+            auto _oCanceledWriter = _oLock.LockAsync();
+            auto _oReader = _oLock.LockSharedAsync();
+            Assert::IsTrue(_oCanceledReader.GetAsyncOperation()->Cancel());
+            Assert::IsTrue(_oCanceledWriter.GetAsyncOperation()->Cancel());
+
+            _oLock.Unlock();
+            Assert::IsTrue(_oReader.GetStatus() == AsyncStatus::Completed);
+            _oLock.UnlockShared();
+            Assert::IsTrue(_oLock.TryLock());
+            _oLock.Unlock();
+        }
+
+        TEST_METHOD(读写锁写入者不会饿死)
+        {
+            AsyncReaderWriterLock _oLock;
+            auto _oReader1 = _oLock.LockSharedAsync();
+            auto _oReader2 = _oLock.LockSharedAsync();
+            auto _oWriter = _oLock.LockAsync();
+            auto _oReader3 = _oLock.LockSharedAsync();
+            auto _oReader4 = _oLock.LockSharedAsync();
+
+            Assert::IsTrue(_oReader1.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oReader2.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oWriter.GetStatus() == AsyncStatus::Started);
+            // 已经有写入者排队，新的读取者也需要等待
+            Assert::IsTrue(_oReader3.GetStatus() == AsyncStatus::Started);
+            Assert::IsFalse(_oLock.TryLockShared());
+
+            _oLock.UnlockShared();
+            _oLock.UnlockShared();
+            Assert::IsTrue(_oWriter.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oReader3.GetStatus() == AsyncStatus::Started);
+
+            // 队首连续的读取者同时获得锁
+            _oLock.Unlock();
+            Assert::IsTrue(_oReader3.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oReader4.GetStatus() == AsyncStatus::Completed);
+
+            _oLock.UnlockShared();
+            _oLock.UnlockShared();
+            Assert::IsTrue(_oLock.TryLock());
+            _oLock.Unlock();
+        }
+    };
+}
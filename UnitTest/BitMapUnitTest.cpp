@@ -59,5 +59,102 @@ namespace UnitTest
                 Assert::AreEqual(TTT.Find(120), 127);
             }
         }
+
+        TEST_METHOD(BitFind64位验证)
+        {
+            uint64_t _uMask = 1ull << 40;
+            Assert::AreEqual(BitFind(&_uMask, 3), 40);
+            Assert::AreEqual(BitFind(&_uMask, 41), -1);
+
+            _uMask = 0;
+            Assert::AreEqual(BitFind(&_uMask, 0), -1);
+        }
+
+        TEST_METHOD(非原子BitMap)
+        {
+            BitMap<128, false> TTT;
+            Assert::AreEqual(TTT.SetItem(126, true), false);
+            Assert::AreEqual(TTT.SetItem(126, true), true);
+            Assert::AreEqual(TTT.GetSize(), 1u);
+            Assert::AreEqual(((uint32_t*)&TTT.arrBits)[3], (uint32_t)0x40000000u);
+
+            Assert::AreEqual(TTT.SetItem(126, false), true);
+            Assert::AreEqual(TTT.GetSize(), 0u);
+            Assert::IsTrue(TTT.IsEmpty());
+        }
+
+        TEST_METHOD(批量运算)
+        {
+            BitMap<128, false> A;
+            BitMap<128, false> B;
+            for (uint32_t i = 0; i < 128; i += 2)
+            {
+                A.SetItem(i, true);
+            }
+            for (uint32_t i = 0; i < 128; i += 4)
+            {
+                B.SetItem(i, true);
+            }
+
+            A.Xor(B);
+            Assert::AreEqual(A.GetSize(), 32u);
+            Assert::AreEqual(A.Find(0), 2);
+
+            A.Or(B);
+            Assert::AreEqual(A.GetSize(), 64u);
+            Assert::AreEqual(A.FindZero(0), 1);
+
+            A.And(B);
+            Assert::AreEqual(A.GetSize(), 32u);
+            Assert::AreEqual(A.Find(1), 4);
+
+            for (uint32_t i = 0; i < 128; ++i)
+            {
+                A.SetItem(i, true);
+            }
+            Assert::AreEqual(A.FindZero(0), -1);
+            A.SetItem(100, false);
+            Assert::AreEqual(A.FindZero(5), 100);
+        }
+
+        TEST_METHOD(DynamicBitMap验证)
+        {
+            DynamicBitMap TTT;
+            Assert::AreEqual(TTT.Find(0), -1);
+            Assert::AreEqual(TTT.Resize(100000), S_OK);
+            Assert::AreEqual(TTT.GetBitCount(), 100000u);
+            Assert::AreEqual(TTT.Find(0), -1);
+            Assert::AreEqual(TTT.FindZero(0), 0);
+
+            TTT.SetItem(99999, true);
+            TTT.SetItem(5000, true);
+            Assert::AreEqual(TTT.GetSize(), 2u);
+            Assert::AreEqual(TTT.Find(0), 5000);
+            Assert::AreEqual(TTT.Find(5001), 99999);
+
+            TTT.SetItem(5000, false);
+            Assert::AreEqual(TTT.Find(0), 99999);
+
+            // 缩小后超出范围的位将被丢弃
+            Assert::AreEqual(TTT.Resize(6000), S_OK);
+            Assert::AreEqual(TTT.GetSize(), 0u);
+            Assert::AreEqual(TTT.Find(0), -1);
+
+            for (uint32_t i = 0; i < 6000; ++i)
+            {
+                TTT.SetItem(i, true);
+            }
+            Assert::AreEqual(TTT.FindZero(0), -1);
+            TTT.SetItem(4097, false);
+            Assert::AreEqual(TTT.FindZero(10), 4097);
+
+            DynamicBitMap Other;
+            Assert::AreEqual(Other.Resize(100), S_OK);
+            Other.SetItem(7, true);
+            TTT.And(Other);
+            Assert::AreEqual(TTT.GetSize(), 1u);
+            Assert::AreEqual(TTT.Find(0), 7);
+            Assert::AreEqual(TTT.Find(8), -1);
+        }
     };
 }
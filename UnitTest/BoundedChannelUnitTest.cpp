@@ -0,0 +1,171 @@
+﻿#include "CppUnitTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <YY/Base/Threading/BoundedChannel.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(BoundedChannelUnitTest)
+    {
+    public:
+        TEST_METHOD(队列已满时写入失败)
+        {
+            BoundedChannel<uint32_t, 4> _oChannel;
+            for (uint32_t i = 0; i != 4; ++i)
+            {
+                Assert::IsTrue(_oChannel.TryPush(i));
+            }
+            Assert::IsFalse(_oChannel.TryPush(4u));
+
+            uint32_t _uValue = 0;
+            for (uint32_t i = 0; i != 4; ++i)
+            {
+                Assert::IsTrue(_oChannel.TryPop(&_uValue));
+                Assert::AreEqual(_uValue, i);
+            }
+            Assert::IsFalse(_oChannel.TryPop(&_uValue));
+        }
+
+        TEST_METHOD(异步等待)
+        {
+            BoundedChannel<uint32_t, 2, ProducerType::Single, ConsumerType::Single> _oChannel;
+
+            // 队列为空，读取需要等待
+            auto _oPopTask = _oChannel.PopAsync();
+            Assert::IsTrue(_oPopTask.GetStatus() == AsyncStatus::Started);
+            Assert::IsTrue(_oChannel.TryPush(1u));
+            Assert::IsTrue(_oPopTask.GetStatus() == AsyncStatus::Completed);
+            Assert::AreEqual(_oPopTask.GetResult(), 1u);
+
+            // 队列已满，写入需要等待
+            Assert::IsTrue(_oChannel.TryPush(2u));
+            Assert::IsTrue(_oChannel.TryPush(3u));
+            auto _oPushTask = _oChannel.PushAsync(4u);
+            Assert::IsTrue(_oPushTask.GetStatus() == AsyncStatus::Started);
+
+            uint32_t _uValue = 0;
+            Assert::IsTrue(_oChannel.TryPop(&_uValue));
+            Assert::AreEqual(_uValue, 2u);
+            Assert::IsTrue(_oPushTask.GetStatus() == AsyncStatus::Completed);
+
+            Assert::IsTrue(_oChannel.TryPop(&_uValue));
+            Assert::AreEqual(_uValue, 3u);
+            Assert::IsTrue(_oChannel.TryPop(&_uValue));
+            Assert::AreEqual(_uValue, 4u);
+        }
+
+        TEST_METHOD(不需要等待时不申请内存)
+        {
+            BoundedChannel<uint32_t, 2> _oChannel;
+
+            auto _oPushTask = _oChannel.PushAsync(1u);
+            Assert::IsTrue(_oPushTask.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oPushTask.GetAsyncOperation() == nullptr);
+
+            auto _oPopTask = _oChannel.PopAsync();
+            Assert::IsTrue(_oPopTask.GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oPopTask.GetAsyncOperation() == nullptr);
+            Assert::AreEqual(_oPopTask.GetResult(), 1u);
+
+            // 需要等待时才创建等待者
+            auto _oWaitTask = _oChannel.PopAsync();
+            Assert::IsTrue(_oWaitTask.GetAsyncOperation() != nullptr);
+            Assert::IsTrue(_oChannel.TryPush(2u));
+            Assert::IsTrue(_oWaitTask.GetStatus() == AsyncStatus::Completed);
+            Assert::AreEqual(_oWaitTask.GetResult(), 2u);
+        }
+
+        TEST_METHOD(取消的等待者不影响元素)
+        {
+            BoundedChannel<uint32_t, 2> _oChannel;
+
+            // 取消的读取不能拿走元素
+            auto _oCanceledPopTask = _oChannel.PopAsync();
+            auto _oPopTask = _oChannel.PopAsync();
+            Assert::IsTrue(_oCanceledPopTask.GetAsyncOperation()->Cancel());
+            Assert::IsTrue(_oChannel.TryPush(1u));
+            Assert::IsTrue(_oCanceledPopTask.GetStatus() == AsyncStatus::Canceled);
+            Assert::IsTrue(_oPopTask.GetStatus() == AsyncStatus::Completed);
+            Assert::AreEqual(_oPopTask.GetResult(), 1u);
+
+            // 取消的写入不能进入队列
+            Assert::IsTrue(_oChannel.TryPush(2u));
+            Assert::IsTrue(_oChannel.TryPush(3u));
+            auto _oCanceledPushTask = _oChannel.PushAsync(4u);
+            auto _oPushTask = _oChannel.PushAsync(5u);
+            Assert::IsTrue(_oCanceledPushTask.GetAsyncOperation()->Cancel());
+
+            uint32_t _uValue = 0;
+            Assert::IsTrue(_oChannel.TryPop(&_uValue));
+            Assert::AreEqual(_uValue, 2u);
+            Assert::IsTrue(_oCanceledPushTask.GetStatus() == AsyncStatus::Canceled);
+            Assert::IsTrue(_oPushTask.GetStatus() == AsyncStatus::Completed);
+
+            Assert::IsTrue(_oChannel.TryPop(&_uValue));
+            Assert::AreEqual(_uValue, 3u);
+            Assert::IsTrue(_oChannel.TryPop(&_uValue));
+            Assert::AreEqual(_uValue, 5u);
+            Assert::IsFalse(_oChannel.TryPop(&_uValue));
+        }
+
+        TEST_METHOD(多生产者多消费者)
+        {
+            BoundedChannel<uint64_t, 8> _oChannel;
+            constexpr uint32_t kCount = 10000;
+
+            std::vector<ValueTask<void>> _arrPushTasks[4];
+            std::vector<ValueTask<uint64_t>> _arrPopTasks[4];
+            std::vector<std::thread> _arrThreads;
+            for (uint32_t i = 0; i != 4; ++i)
+            {
+                _arrThreads.emplace_back(
+                    [&, i]()
+                    {
+                        for (uint32_t j = 0; j != kCount; ++j)
+                        {
+                            _arrPushTasks[i].push_back(_oChannel.PushAsync(uint64_t(i) * kCount + j + 1));
+                        }
+                    });
+                _arrThreads.emplace_back(
+                    [&, i]()
+                    {
+                        for (uint32_t j = 0; j != kCount; ++j)
+                        {
+                            _arrPopTasks[i].push_back(_oChannel.PopAsync());
+                        }
+                    });
+            }
+
+            for (auto& _oThread : _arrThreads)
+            {
+                _oThread.join();
+            }
+
+            for (auto& _arrTasks : _arrPushTasks)
+            {
+                for (auto& _oTask : _arrTasks)
+                {
+                    Assert::IsTrue(_oTask.GetStatus() == AsyncStatus::Completed);
+                }
+            }
+
+            uint64_t _uSum = 0;
+            for (auto& _arrTasks : _arrPopTasks)
+            {
+                for (auto& _oTask : _arrTasks)
+                {
+                    Assert::IsTrue(_oTask.GetStatus() == AsyncStatus::Completed);
+                    _uSum += _oTask.GetResult();
+                }
+            }
+
+            constexpr uint64_t kTotal = uint64_t(4) * kCount;
+            Assert::AreEqual(_uSum, kTotal * (kTotal + 1) / 2);
+        }
+    };
+}
@@ -0,0 +1,123 @@
+﻿#include "CppUnitTest.h"
+
+#include <YY/Base/Threading/Channel.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(ChannelUnitTest)
+    {
+    public:
+        TEST_METHOD(读取者等待写入)
+        {
+            Channel<uint32_t> _oChannel;
+
+            auto _oFirstRead = _oChannel.ReadAsync();
+            auto _oSecondRead = _oChannel.ReadAsync();
+            Assert::IsTrue(_oFirstRead.GetStatus() == AsyncStatus::Started);
+
+            // 直接交给最早等待的读取者
+            Assert::IsTrue(_oChannel.WriteAsync(1).GetStatus() == AsyncStatus::Completed);
+            Assert::IsTrue(_oFirstRead.GetStatus() == AsyncStatus::Completed);
+            Assert::AreEqual(_oFirstRead.GetResult().GetValue(), 1u);
+            Assert::IsTrue(_oSecondRead.GetStatus() == AsyncStatus::Started);
+
+            Assert::IsTrue(_oChannel.TryWrite(2u));
+            Assert::AreEqual(_oSecondRead.GetResult().GetValue(), 2u);
+        }
+
+        TEST_METHOD(有界通道写入等待)
+        {
+            Channel<uint32_t> _oChannel(1);
+            Assert::IsTrue(_oChannel.WriteAsync(1).GetStatus() == AsyncStatus::Completed);
+            Assert::IsFalse(_oChannel.TryWrite(2u));
+
+            auto _oWrite = _oChannel.WriteAsync(2);
+            Assert::IsTrue(_oWrite.GetStatus() == AsyncStatus::Started);
+
+            uint32_t _uValue = 0;
+            Assert::IsTrue(_oChannel.TryRead(&_uValue));
+            Assert::AreEqual(_uValue, 1u);
+            Assert::IsTrue(_oWrite.GetStatus() == AsyncStatus::Completed);
+
+            Assert::IsTrue(_oChannel.TryRead(&_uValue));
+            Assert::AreEqual(_uValue, 2u);
+            Assert::IsFalse(_oChannel.TryRead(&_uValue));
+        }
+
+        TEST_METHOD(完成后读取剩余元素)
+        {
+            Channel<uint32_t> _oChannel;
+            _oChannel.TryWrite(1u);
+            Assert::IsTrue(_oChannel.Complete());
+            Assert::IsFalse(_oChannel.Complete());
+
+            Assert::IsTrue(_oChannel.WriteAsync(2).GetStatus() == AsyncStatus::Error);
+            Assert::IsFalse(_oChannel.TryWrite(2u));
+
+            auto _oRead = _oChannel.ReadAsync();
+            Assert::AreEqual(_oRead.GetResult().GetValue(), 1u);
+
+            auto _oEndRead = _oChannel.ReadAsync();
+            Assert::IsTrue(_oEndRead.GetStatus() == AsyncStatus::Completed);
+            Assert::IsFalse(_oEndRead.GetResult().HasValue());
+        }
+
+        TEST_METHOD(完成时唤醒等待的读取者)
+        {
+            Channel<uint32_t> _oChannel;
+            auto _oRead = _oChannel.ReadAsync();
+            Assert::IsTrue(_oRead.GetStatus() == AsyncStatus::Started);
+
+            _oChannel.Complete();
+            Assert::IsTrue(_oRead.GetStatus() == AsyncStatus::Completed);
+            Assert::IsFalse(_oRead.GetResult().HasValue());
+        }
+
+        TEST_METHOD(不需要等待时不申请内存)
+        {
+            Channel<uint32_t> _oChannel;
+
+            auto _oWrite = _oChannel.WriteAsync(1);
+            Assert::IsFalse(_oWrite.GetAsyncOperation());
+            Assert::IsTrue(_oWrite.GetStatus() == AsyncStatus::Completed);
+
+            auto _oRead = _oChannel.ReadAsync();
+            Assert::IsFalse(_oRead.GetAsyncOperation());
+            Assert::AreEqual(_oRead.GetResult().GetValue(), 1u);
+        }
+
+        TEST_METHOD(取消的等待者不影响元素)
+        {
+            Channel<uint32_t> _oChannel(1);
+
+            // 取消的读取者不能拿走元素
+            auto _oCanceledRead = _oChannel.ReadAsync();
+            auto _oRead = _oChannel.ReadAsync();
+            Assert::IsTrue(_oCanceledRead.GetAsyncOperation()->Cancel());
+            Assert::IsTrue(_oChannel.TryWrite(1u));
+            Assert::IsTrue(_oCanceledRead.GetStatus() == AsyncStatus::Canceled);
+            Assert::AreEqual(_oRead.GetResult().GetValue(), 1u);
+
+            Assert::IsTrue(_oChannel.WriteAsync(2).GetStatus() == AsyncStatus::Completed);
+            Assert::IsFalse(_oChannel.TryWrite(1u));
+
+            // 取消的写入不能进入缓冲区
+            auto _oCanceledWrite = _oChannel.WriteAsync(3);
+            auto _oWrite = _oChannel.WriteAsync(4);
+            Assert::IsTrue(_oCanceledWrite.GetAsyncOperation()->Cancel());
+
+            uint32_t _uValue = 0;
+            Assert::IsTrue(_oChannel.TryRead(&_uValue));
+            Assert::AreEqual(_uValue, 2u);
+            Assert::IsTrue(_oCanceledWrite.GetStatus() == AsyncStatus::Canceled);
+            Assert::IsTrue(_oWrite.GetStatus() == AsyncStatus::Completed);
+
+            Assert::IsTrue(_oChannel.TryRead(&_uValue));
+            Assert::AreEqual(_uValue, 4u);
+            Assert::IsFalse(_oChannel.TryRead(&_uValue));
+        }
+    };
+}
@@ -0,0 +1,58 @@
+﻿#include "CppUnitTest.h"
+
+#include <string.h>
+
+#include <YY/Base/Threading/CoroutineFrameAllocator.h>
+#include <YY/Base/Threading/Task.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(CoroutineFrameAllocatorUnitTest)
+    {
+    public:
+        TEST_METHOD(同一个桶复用帧)
+        {
+            CoroutineFrameAllocator::FlushCurrentThreadCache();
+
+            auto _pFrame = CoroutineFrameAllocator::Alloc(200);
+            Assert::IsNotNull(_pFrame);
+            CoroutineFrameAllocator::Free(_pFrame, 200);
+
+            // 193 ~ 256 字节属于同一个桶
+            auto _pReused = CoroutineFrameAllocator::Alloc(230);
+            Assert::IsTrue(_pReused == _pFrame);
+            CoroutineFrameAllocator::Free(_pReused, 230);
+
+            CoroutineFrameAllocator::FlushCurrentThreadCache();
+        }
+
+        TEST_METHOD(大帧不缓存)
+        {
+            constexpr size_t kLargeSize = CoroutineFrameAllocator::kMaxFrameSize + 1;
+            auto _pFrame = CoroutineFrameAllocator::Alloc(kLargeSize);
+            Assert::IsNotNull(_pFrame);
+            memset(_pFrame, 0, kLargeSize);
+            CoroutineFrameAllocator::Free(_pFrame, kLargeSize);
+        }
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+        TEST_METHOD(协程帧来自回收器)
+        {
+            CoroutineFrameAllocator::FlushCurrentThreadCache();
+
+            auto _pfnCoroutine = []() -> Task<uint32_t>
+            {
+                co_return 1;
+            };
+
+            Assert::AreEqual(_pfnCoroutine().GetResult(), 1u);
+            Assert::AreEqual(_pfnCoroutine().GetResult(), 1u);
+
+            CoroutineFrameAllocator::FlushCurrentThreadCache();
+        }
+#endif
+    };
+}
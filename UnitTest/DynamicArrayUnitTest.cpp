@@ -5,6 +5,7 @@
 #include <string>
 
 #include <YY/Base/Containers/Array.h>
+#include <YY/Base/Memory/RefPtr.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -188,5 +189,87 @@ namespace UnitTest
                 Assert::AreNotEqual(_Data2.GetData(), _pDateBuffer);
             }
         }
+
+        TEST_METHOD(平凡重定位)
+        {
+            struct TestObject : public YY::Base::Memory::RefValue
+            {
+                int iValue;
+
+                TestObject(int _iValue)
+                    : iValue(_iValue)
+                {
+                }
+            };
+
+            static_assert(IsTriviallyRelocatable<int>::value, "");
+            static_assert(IsTriviallyRelocatable<RefPtr<TestObject>>::value, "");
+            static_assert(IsTriviallyRelocatable<Array<std::string>>::value, "");
+            static_assert(!IsTriviallyRelocatable<std::string>::value, "");
+            static_assert(!IsTriviallyRelocatable<Array<std::string, AllocPolicy::SOO>>::value, "");
+
+            Array<RefPtr<TestObject>, AllocPolicy::SOO> _Data;
+            auto _pFirst = RefPtr<TestObject>::Create(0);
+            for (int i = 0; i != 100; ++i)
+            {
+                Assert::IsTrue(SUCCEEDED(_Data.Add(RefPtr<TestObject>::Create(i))));
+            }
+
+            Assert::IsTrue(SUCCEEDED(_Data.Insert(50, _pFirst)));
+            Assert::IsTrue(SUCCEEDED(_Data.Remove(0, 10)));
+            Assert::AreEqual(_Data.GetSize(), size_t(91));
+            Assert::AreEqual((*_Data.GetItemPtr(0))->iValue, 10);
+            Assert::IsTrue(*_Data.GetItemPtr(40) == _pFirst);
+            Assert::AreEqual((*_Data.GetItemPtr(41))->iValue, 50);
+            Assert::AreEqual((*_Data.GetItemPtr(90))->iValue, 99);
+
+            // 重定位不应该产生额外的引用计数
+            Assert::AreEqual(_pFirst->IsShared(), true);
+            _Data.Remove(40);
+            Assert::AreEqual(_pFirst->IsShared(), false);
+        }
+
+        TEST_METHOD(非平凡类型Insert与Remove)
+        {
+            Array<std::string> _Data;
+            for (int i = 0; i != 10; ++i)
+                Assert::IsTrue(SUCCEEDED(_Data.Add(std::to_string(i))));
+
+            Assert::IsTrue(SUCCEEDED(_Data.Insert(5, "x")));
+            Assert::IsTrue(SUCCEEDED(_Data.Remove(0, 2)));
+
+            const char* Data[] = {"2", "3", "4", "x", "5", "6", "7", "8", "9"};
+            Assert::AreEqual(_Data.GetSize(), _countof(Data));
+            for (int i = 0; i != _countof(Data); ++i)
+                Assert::AreEqual(_Data.GetItemPtr(i)->c_str(), Data[i]);
+        }
+
+        TEST_METHOD(Insert自身元素)
+        {
+            using TestObject = YY::Base::Memory::RefValue;
+
+            Array<std::string> _Data;
+            Array<RefPtr<TestObject>> _Data2;
+            for (int i = 0; i != 10; ++i)
+            {
+                Assert::IsTrue(SUCCEEDED(_Data.Add(std::string(32, char('a' + i)))));
+                Assert::IsTrue(SUCCEEDED(_Data2.Add(RefPtr<TestObject>::Create())));
+            }
+
+            // 插入数组自身的元素，元素搬移以及扩容都不能影响插入的值
+            for (int i = 0; i != 100; ++i)
+            {
+                const auto _szExpected = *_Data.GetItemPtr(_Data.GetSize() - 1);
+                Assert::IsTrue(SUCCEEDED(_Data.Insert(0, *_Data.GetItemPtr(_Data.GetSize() - 1))));
+                Assert::AreEqual(_Data.GetItemPtr(0)->c_str(), _szExpected.c_str());
+
+                const auto _pExpected = *_Data2.GetItemPtr(5);
+                Assert::IsTrue(SUCCEEDED(_Data2.Insert(0, *_Data2.GetItemPtr(5))));
+                Assert::IsTrue(*_Data2.GetItemPtr(0) == _pExpected);
+            }
+
+            Assert::AreEqual(_Data.GetSize(), size_t(110));
+            Assert::AreEqual(_Data2.GetSize(), size_t(110));
+        }
     };
 }
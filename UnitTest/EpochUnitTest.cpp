@@ -0,0 +1,135 @@
+﻿#include "CppUnitTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <YY/Base/Sync/Epoch.h>
+#include <YY/Base/Sync/Interlocked.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    namespace
+    {
+        struct EpochTestNode
+        {
+            EpochTestNode* pNext = nullptr;
+            static volatile uint32_t uFreeCount;
+
+            ~EpochTestNode()
+            {
+                Sync::Increment(&uFreeCount);
+            }
+        };
+
+        volatile uint32_t EpochTestNode::uFreeCount = 0;
+    }
+
+    TEST_CLASS(EpochUnitTest)
+    {
+    public:
+        TEST_METHOD(临界区内不回收)
+        {
+            const uint32_t _uFreeCount = EpochTestNode::uFreeCount;
+            Assert::IsFalse(Epoch::IsEntered());
+
+            {
+                EpochGuard _oGuard;
+                Assert::IsTrue(Epoch::IsEntered());
+                {
+                    // 允许嵌套
+                    EpochGuard _oNestedGuard;
+                    Assert::IsTrue(Epoch::IsEntered());
+                }
+                Assert::IsTrue(Epoch::IsEntered());
+
+                Epoch::RetireDelete(Memory::New<EpochTestNode>());
+                for (int i = 0; i != 10; ++i)
+                {
+                    Epoch::Collect();
+                }
+
+                // 当前线程依然在临界区内，纪元最多推进一次，对象不能释放
+                Assert::AreEqual(uint32_t(EpochTestNode::uFreeCount), _uFreeCount);
+            }
+
+            Assert::IsFalse(Epoch::IsEntered());
+            Epoch::Synchronize();
+            Assert::AreEqual(uint32_t(EpochTestNode::uFreeCount), _uFreeCount + 1);
+        }
+
+        TEST_METHOD(多消费者无锁栈)
+        {
+            const uint32_t _uFreeCount = EpochTestNode::uFreeCount;
+            EpochTestNode* _pHead = nullptr;
+            volatile uint32_t _uPopCount = 0;
+
+            auto _pfnPush = [&_pHead](EpochTestNode* _pNode)
+            {
+                auto _pFirst = _pHead;
+                for (;;)
+                {
+                    _pNode->pNext = _pFirst;
+                    auto _pLast = Sync::CompareExchangePoint(&_pHead, _pNode, _pFirst);
+                    if (_pLast == _pFirst)
+                        break;
+
+                    _pFirst = _pLast;
+                }
+            };
+
+            auto _pfnPop = [&_pHead]() -> EpochTestNode*
+            {
+                // 读取 pNext 期间节点不会被其他消费者释放
+                EpochGuard _oGuard;
+                auto _pFirst = _pHead;
+                for (;;)
+                {
+                    if (!_pFirst)
+                        return nullptr;
+
+                    auto _pLast = Sync::CompareExchangePoint(&_pHead, _pFirst->pNext, _pFirst);
+                    if (_pLast == _pFirst)
+                        return _pFirst;
+
+                    _pFirst = _pLast;
+                }
+            };
+
+            std::vector<std::thread> _arrThreads;
+            for (int i = 0; i != 4; ++i)
+            {
+                _arrThreads.emplace_back(
+                    [&]()
+                    {
+                        for (int j = 0; j != 10000; ++j)
+                        {
+                            _pfnPush(Memory::New<EpochTestNode>());
+                            if (auto _pNode = _pfnPop())
+                            {
+                                Sync::Increment(&_uPopCount);
+                                Epoch::RetireDelete(_pNode);
+                            }
+                        }
+                    });
+            }
+
+            for (auto& _oThread : _arrThreads)
+            {
+                _oThread.join();
+            }
+
+            while (auto _pNode = _pfnPop())
+            {
+                Sync::Increment(&_uPopCount);
+                Epoch::RetireDelete(_pNode);
+            }
+
+            Epoch::Synchronize();
+            Assert::AreEqual(uint32_t(_uPopCount), uint32_t(40000));
+            Assert::AreEqual(uint32_t(EpochTestNode::uFreeCount), _uFreeCount + 40000);
+        }
+    };
+}
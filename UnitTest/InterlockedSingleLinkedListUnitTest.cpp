@@ -0,0 +1,91 @@
+﻿#include "CppUnitTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <YY/Base/Sync/InterlockedSingleLinkedList.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    namespace
+    {
+        struct SingleLinkedTestEntry : public InterlockedSingleLinkedEntryBase<SingleLinkedTestEntry>
+        {
+            volatile uint32_t uOwner = 0;
+        };
+    }
+
+    TEST_CLASS(InterlockedSingleLinkedListUnitTest)
+    {
+    public:
+        TEST_METHOD(多消费者后进先出)
+        {
+            InterlockedSingleLinkedList<SingleLinkedTestEntry, ProducerType::Multi, ConsumerType::Multi> _oList;
+            Assert::IsNull(_oList.Pop());
+
+            auto _pFirst = new SingleLinkedTestEntry;
+            auto _pSecond = new SingleLinkedTestEntry;
+            _oList.Push(_pFirst);
+            _oList.Push(_pSecond);
+
+            Assert::IsTrue(_oList.Pop() == _pSecond);
+            Assert::IsTrue(_oList.Pop() == _pFirst);
+            Assert::IsNull(_oList.Pop());
+
+            delete _pFirst;
+            delete _pSecond;
+        }
+
+        TEST_METHOD(多消费者并发弹出不会重复)
+        {
+            InterlockedSingleLinkedList<SingleLinkedTestEntry, ProducerType::Multi, ConsumerType::Multi> _oList;
+            for (int i = 0; i != 64; ++i)
+            {
+                _oList.Push(new SingleLinkedTestEntry);
+            }
+
+            // 同一批元素反复弹出与压入，最容易触发 ABA 问题
+            volatile uint32_t _uConflictCount = 0;
+            std::vector<std::thread> _arrThreads;
+            for (int i = 0; i != 8; ++i)
+            {
+                _arrThreads.emplace_back(
+                    [&]()
+                    {
+                        for (int j = 0; j != 100000; ++j)
+                        {
+                            auto _pEntry = _oList.Pop();
+                            if (!_pEntry)
+                                continue;
+
+                            if (Sync::Exchange(&_pEntry->uOwner, 1u) != 0)
+                                Sync::Increment(&_uConflictCount);
+
+                            Sync::Exchange(&_pEntry->uOwner, 0u);
+                            _oList.Push(_pEntry);
+                        }
+                    });
+            }
+
+            for (auto& _oThread : _arrThreads)
+            {
+                _oThread.join();
+            }
+
+            Assert::AreEqual(uint32_t(_uConflictCount), uint32_t(0));
+
+            uint32_t _cCount = 0;
+            for (auto _pEntry = _oList.Flush(); _pEntry;)
+            {
+                auto _pNext = _pEntry->pNext;
+                delete _pEntry;
+                _pEntry = _pNext;
+                ++_cCount;
+            }
+            Assert::AreEqual(_cCount, uint32_t(64));
+        }
+    };
+}
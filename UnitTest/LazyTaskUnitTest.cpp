@@ -0,0 +1,77 @@
+﻿#include "CppUnitTest.h"
+
+#include <Windows.h>
+
+#include <YY/Base/Threading/LazyTask.h>
+#include <YY/Base/Threading/TaskRunner.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+#if defined(_HAS_CXX20) && _HAS_CXX20
+    TEST_CLASS(LazyTaskUnitTest)
+    {
+    public:
+        TEST_METHOD(首次co_await时才启动)
+        {
+            uint32_t _uRunCount = 0;
+            auto _pfnLazy = [&_uRunCount]() -> LazyTask<uint32_t>
+            {
+                ++_uRunCount;
+                co_return 5;
+            };
+
+            auto _oLazy = _pfnLazy();
+            Assert::AreEqual(_uRunCount, 0u);
+            Assert::IsFalse(_oLazy.IsStarted());
+
+            auto _pfnConsumer = [&_oLazy]() -> Task<uint32_t>
+            {
+                co_return co_await _oLazy + 1;
+            };
+
+            Assert::AreEqual(_pfnConsumer().GetResult(), 6u);
+            Assert::AreEqual(_uRunCount, 1u);
+            Assert::IsTrue(_oLazy.IsStarted());
+
+            // 重复启动不会再次执行
+            Assert::AreEqual(_oLazy.Start().GetResult(), 5u);
+            Assert::AreEqual(_uRunCount, 1u);
+        }
+
+        TEST_METHOD(在指定TaskRunner中启动)
+        {
+            auto _pTaskRunner = SequencedTaskRunner::Create();
+            auto _pfnLazy = []() -> LazyTask<void*>
+            {
+                co_return TaskRunner::GetCurrent().Get();
+            };
+
+            auto _oTask = _pfnLazy().Start(_pTaskRunner);
+            Assert::IsTrue(_oTask.GetResult() == _pTaskRunner.Get());
+        }
+
+        TEST_METHOD(未启动时销毁不会执行)
+        {
+            bool _bRun = false;
+            auto _pfnLazy = [&_bRun]() -> LazyTask<void>
+            {
+                _bRun = true;
+                co_return;
+            };
+
+            {
+                auto _oLazy = _pfnLazy();
+            }
+            Assert::IsFalse(_bRun);
+
+            auto _oLazy = _pfnLazy();
+            auto _oTask = _oLazy.Start(nullptr);
+            Assert::IsTrue(_bRun);
+            Assert::IsTrue(_oTask.GetStatus() == AsyncStatus::Completed);
+        }
+    };
+#endif
+}
@@ -0,0 +1,141 @@
+﻿#include "CppUnitTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <YY/Base/Memory/ObjectPool.h>
+#include <YY/Base/Memory/RefPtr.h>
+#include <YY/Base/Memory/WeakPtr.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    namespace
+    {
+        struct PooledObject : public RefValue
+        {
+            static volatile uint32_t uDestroyCount;
+
+            int iValue;
+
+            PooledObject(int _iValue)
+                : iValue(_iValue)
+            {
+            }
+
+            ~PooledObject()
+            {
+                Sync::Increment(&uDestroyCount);
+            }
+        };
+
+        volatile uint32_t PooledObject::uDestroyCount = 0;
+
+        struct SecondBase
+        {
+            void* pNext = nullptr;
+        };
+
+        // 与 BoundedChannel 的等待者相同，RefValue 是第一个基类，后面还有其他基类
+        struct MultiBaseObject
+            : public RefValue
+            , public SecondBase
+        {
+            int iValue;
+
+            MultiBaseObject(int _iValue)
+                : iValue(_iValue)
+            {
+            }
+        };
+    }
+
+    TEST_CLASS(ObjectPoolUnitTest)
+    {
+    public:
+        TEST_METHOD(内存复用)
+        {
+            auto _pObject1 = ObjectPool<PooledObject>::New(1);
+            Assert::IsNotNull(_pObject1);
+            ObjectPool<PooledObject>::Delete(_pObject1);
+
+            auto _pObject2 = ObjectPool<PooledObject>::New(2);
+            Assert::IsTrue(_pObject1 == _pObject2);
+            Assert::AreEqual(_pObject2->iValue, 2);
+            ObjectPool<PooledObject>::Delete(_pObject2);
+        }
+
+        TEST_METHOD(RefPtr从对象池创建)
+        {
+            const uint32_t _uDestroyCount = PooledObject::uDestroyCount;
+            PooledObject* _pRaw;
+            {
+                auto _pObject = RefPtr<PooledObject>::CreateFromPool(5);
+                Assert::IsNotNull(_pObject.Get());
+                Assert::AreEqual(_pObject.Get()->iValue, 5);
+                _pRaw = _pObject.Get();
+            }
+            Assert::AreEqual(uint32_t(PooledObject::uDestroyCount), _uDestroyCount + 1);
+
+            // 弱引用释放之前内存不能回到对象池
+            {
+                auto _pObject = RefPtr<PooledObject>::CreateFromPool(6);
+                Assert::IsTrue(_pObject.Get() == _pRaw);
+
+                WeakPtr<PooledObject> _pWeak(_pObject.Get());
+                _pObject = nullptr;
+                Assert::AreEqual(uint32_t(PooledObject::uDestroyCount), _uDestroyCount + 2);
+
+                auto _pOther = RefPtr<PooledObject>::CreateFromPool(7);
+                Assert::IsTrue(_pOther.Get() != _pRaw);
+            }
+        }
+
+        TEST_METHOD(多重继承的对象回收到对象池)
+        {
+            MultiBaseObject* _pRaw;
+            {
+                auto _pObject = RefPtr<MultiBaseObject>::CreateFromPool(1);
+                Assert::IsNotNull(_pObject.Get());
+                _pRaw = _pObject.Get();
+                Assert::IsTrue(static_cast<void*>(static_cast<RefValue*>(_pRaw)) == static_cast<void*>(_pRaw));
+                Assert::IsTrue(static_cast<void*>(static_cast<SecondBase*>(_pRaw)) != static_cast<void*>(_pRaw));
+            }
+
+            // 归还的是整个对象的内存，而不是某个子对象的地址
+            auto _pObject = RefPtr<MultiBaseObject>::CreateFromPool(2);
+            Assert::IsTrue(_pObject.Get() == _pRaw);
+            Assert::AreEqual(_pObject.Get()->iValue, 2);
+        }
+
+        TEST_METHOD(跨线程释放)
+        {
+            const uint32_t _uDestroyCount = PooledObject::uDestroyCount;
+
+            std::vector<RefPtr<PooledObject>> _arrObjects;
+            for (int i = 0; i != 1000; ++i)
+            {
+                _arrObjects.push_back(RefPtr<PooledObject>::CreateFromPool(i));
+            }
+
+            std::thread _oThread(
+                [&_arrObjects]()
+                {
+                    _arrObjects.clear();
+                });
+            _oThread.join();
+            Assert::AreEqual(uint32_t(PooledObject::uDestroyCount), _uDestroyCount + 1000);
+
+            // 其他线程退出时，弹匣进入全局仓库，当前线程可以继续复用
+            for (int i = 0; i != 1000; ++i)
+            {
+                _arrObjects.push_back(RefPtr<PooledObject>::CreateFromPool(i));
+            }
+            _arrObjects.clear();
+
+            ObjectPool<PooledObject>::Trim();
+        }
+    };
+}
@@ -0,0 +1,118 @@
+﻿#include "CppUnitTest.h"
+
+#include <vector>
+
+#include <YY/Base/Threading/Parallel.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(ParallelUnitTest)
+    {
+    public:
+        TEST_METHOD(ParallelFor覆盖所有元素)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            std::vector<uint32_t> _arrCounts(100000, 0);
+            ParallelFor(
+                _pTaskRunner,
+                0,
+                _arrCounts.size(),
+                [&_arrCounts](size_t _uIndex)
+                {
+                    ++_arrCounts[_uIndex];
+                },
+                64);
+
+            for (auto _uCount : _arrCounts)
+            {
+                Assert::AreEqual(_uCount, 1u);
+            }
+
+            ParallelForEach(
+                _pTaskRunner,
+                Span<uint32_t>(_arrCounts.data(), _arrCounts.size()),
+                [](uint32_t& _uCount)
+                {
+                    _uCount *= 3;
+                });
+
+            for (auto _uCount : _arrCounts)
+            {
+                Assert::AreEqual(_uCount, 3u);
+            }
+        }
+
+        TEST_METHOD(ParallelReduce求和)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            auto _uSum = ParallelReduce(
+                _pTaskRunner,
+                0,
+                100000,
+                uint64_t(0),
+                [](size_t _uBegin, size_t _uEnd)
+                {
+                    uint64_t _uPartial = 0;
+                    for (; _uBegin != _uEnd; ++_uBegin)
+                    {
+                        _uPartial += _uBegin;
+                    }
+                    return _uPartial;
+                },
+                [](uint64_t _uLeft, uint64_t _uRight)
+                {
+                    return _uLeft + _uRight;
+                });
+
+            Assert::AreEqual(_uSum, uint64_t(100000) * 99999 / 2);
+        }
+
+        TEST_METHOD(异常传播到调用线程)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            HRESULT _hr = S_OK;
+            try
+            {
+                ParallelFor(
+                    _pTaskRunner,
+                    0,
+                    1000,
+                    [](size_t _uIndex)
+                    {
+                        if (_uIndex == 500)
+                            throw Exception(E_ACCESSDENIED);
+                    });
+            }
+            catch (const Exception& _oEx)
+            {
+                _hr = _oEx.GetErrorCode();
+            }
+
+            Assert::AreEqual(_hr, HRESULT(E_ACCESSDENIED));
+        }
+
+        TEST_METHOD(ParallelForAsync)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            volatile uint64_t _uSum = 0;
+            auto _oTask = ParallelForAsync(
+                _pTaskRunner,
+                0,
+                5000,
+                [&_uSum](size_t _uIndex)
+                {
+                    Sync::Add(&_uSum, uint64_t(_uIndex));
+                });
+
+            _oTask.GetResult();
+            Assert::AreEqual(uint64_t(_uSum), uint64_t(5000) * 4999 / 2);
+        }
+    };
+}
@@ -0,0 +1,68 @@
+﻿#include "CppUnitTest.h"
+
+#include <YY/Base/Memory/RefPtr.h>
+#include <YY/Base/Memory/WeakPtr.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(RefPtrUnitTest)
+    {
+    public:
+        TEST_METHOD(单线程引用计数)
+        {
+            struct TestObject : public RefValueST
+            {
+                bool* pbDestroyed;
+
+                TestObject(bool* _pbDestroyed)
+                    : pbDestroyed(_pbDestroyed)
+                {
+                }
+
+                ~TestObject()
+                {
+                    *pbDestroyed = true;
+                }
+            };
+
+            bool _bDestroyed = false;
+            auto _pObject = RefPtr<TestObject>::Create(&_bDestroyed);
+            Assert::IsNotNull(_pObject.Get());
+            Assert::IsFalse(_pObject.Get()->IsShared());
+
+            auto _pCopy = _pObject;
+            Assert::IsTrue(_pObject.Get()->IsShared());
+
+            WeakPtr<TestObject> _pWeak(_pObject.Get());
+            Assert::IsTrue(_pWeak.Get().Get() == _pObject.Get());
+
+            _pObject = nullptr;
+            Assert::IsFalse(_bDestroyed);
+            _pCopy = nullptr;
+            Assert::IsTrue(_bDestroyed);
+
+            Assert::IsTrue(_pWeak.IsExpired());
+            Assert::IsNull(_pWeak.Get().Get());
+        }
+
+        TEST_METHOD(单线程对象池)
+        {
+            struct TestObject : public RefValueST
+            {
+            };
+
+            TestObject* _pRaw;
+            {
+                auto _pObject = RefPtr<TestObject>::CreateFromPool();
+                Assert::IsNotNull(_pObject.Get());
+                _pRaw = _pObject.Get();
+            }
+
+            auto _pObject = RefPtr<TestObject>::CreateFromPool();
+            Assert::IsTrue(_pObject.Get() == _pRaw);
+        }
+    };
+}
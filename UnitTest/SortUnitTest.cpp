@@ -0,0 +1,171 @@
+﻿#include "CppUnitTest.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <YY/Base/Containers/Sort.h>
+#include <YY/Base/Threading/ParallelSort.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(SortUnitTest)
+    {
+    public:
+        TEST_METHOD(Sort各种分布)
+        {
+            std::mt19937 _oRandom(42);
+            for (size_t _cItems : { 0, 1, 2, 15, 16, 17, 24, 25, 129, 1000, 100000 })
+            {
+                for (int _iPattern = 0; _iPattern != 4; ++_iPattern)
+                {
+                    std::vector<int32_t> _arrItems(_cItems);
+                    for (size_t _uIndex = 0; _uIndex != _cItems; ++_uIndex)
+                    {
+                        switch (_iPattern)
+                        {
+                        case 0:
+                            _arrItems[_uIndex] = int32_t(_oRandom());
+                            break;
+                        case 1:
+                            _arrItems[_uIndex] = int32_t(_uIndex);
+                            break;
+                        case 2:
+                            _arrItems[_uIndex] = int32_t(_cItems - _uIndex);
+                            break;
+                        default:
+                            _arrItems[_uIndex] = int32_t(_oRandom() % 4);
+                            break;
+                        }
+                    }
+
+                    auto _arrExpected = _arrItems;
+                    std::sort(_arrExpected.begin(), _arrExpected.end());
+
+                    auto _arrSorted = _arrItems;
+                    Sort(Span<int32_t>(_arrSorted.data(), _arrSorted.size()));
+                    Assert::IsTrue(_arrSorted == _arrExpected);
+
+                    std::vector<int64_t> _arrDescending(_arrItems.begin(), _arrItems.end());
+                    Sort(Span<int64_t>(_arrDescending.data(), _arrDescending.size()), std::greater<int64_t>());
+                    Assert::IsTrue(std::is_sorted(_arrDescending.begin(), _arrDescending.end(), std::greater<int64_t>()));
+                }
+            }
+        }
+
+        TEST_METHOD(StableSort保持相等元素顺序)
+        {
+            std::mt19937 _oRandom(7);
+            std::vector<std::pair<int, size_t>> _arrItems(10000);
+            for (size_t _uIndex = 0; _uIndex != _arrItems.size(); ++_uIndex)
+            {
+                _arrItems[_uIndex] = std::make_pair(int(_oRandom() % 16), _uIndex);
+            }
+
+            auto _pfnLess = [](const std::pair<int, size_t>& _oLeft, const std::pair<int, size_t>& _oRight)
+            {
+                return _oLeft.first < _oRight.first;
+            };
+
+            auto _arrExpected = _arrItems;
+            std::stable_sort(_arrExpected.begin(), _arrExpected.end(), _pfnLess);
+
+            Assert::AreEqual(StableSort(Span<std::pair<int, size_t>>(_arrItems.data(), _arrItems.size()), _pfnLess), S_OK);
+            Assert::IsTrue(_arrItems == _arrExpected);
+        }
+
+        TEST_METHOD(PartialSort与Merge)
+        {
+            int32_t _arrItems[] = { 9, 3, 7, 1, 8, 2, 6, 4, 5, 0 };
+            PartialSort(Span<int32_t>(_arrItems), 4);
+            for (int32_t _iIndex = 0; _iIndex != 4; ++_iIndex)
+            {
+                Assert::AreEqual(_arrItems[_iIndex], _iIndex);
+            }
+
+            const int32_t _arrLeft[] = { 1, 3, 5, 7 };
+            const int32_t _arrRight[] = { 2, 3, 4, 8, 9 };
+            int32_t _arrOutput[9] = {};
+            Assert::AreEqual(Merge(Span<const int32_t>(_arrLeft), Span<const int32_t>(_arrRight), Span<int32_t>(_arrOutput)), S_OK);
+
+            const int32_t _arrExpected[] = { 1, 2, 3, 3, 4, 5, 7, 8, 9 };
+            Assert::IsTrue(std::equal(std::begin(_arrOutput), std::end(_arrOutput), std::begin(_arrExpected)));
+
+            Assert::AreEqual(Merge(Span<const int32_t>(_arrLeft), Span<const int32_t>(_arrRight), Span<int32_t>(_arrOutput, 8)), HRESULT(E_BOUNDS));
+
+            // 非 const 的 Span 也可以直接推导
+            int32_t _arrMutableLeft[] = { 1, 3, 5, 7 };
+            int32_t _arrMutableRight[] = { 2, 3, 4, 8, 9 };
+            std::fill(std::begin(_arrOutput), std::end(_arrOutput), 0);
+            Assert::AreEqual(Merge(Span<int32_t>(_arrMutableLeft), Span<int32_t>(_arrMutableRight), Span<int32_t>(_arrOutput)), S_OK);
+            Assert::IsTrue(std::equal(std::begin(_arrOutput), std::end(_arrOutput), std::begin(_arrExpected)));
+        }
+
+        TEST_METHOD(ParallelSort大数组)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            std::mt19937 _oRandom(1);
+            std::vector<uint64_t> _arrItems(1000000);
+            for (auto& _uItem : _arrItems)
+            {
+                _uItem = _oRandom() % 100000;
+            }
+
+            auto _arrExpected = _arrItems;
+            std::sort(_arrExpected.begin(), _arrExpected.end());
+
+            ParallelSort(_pTaskRunner, Span<uint64_t>(_arrItems.data(), _arrItems.size()));
+            Assert::IsTrue(_arrItems == _arrExpected);
+
+            std::vector<std::string> _arrStrings(200000);
+            for (auto& _szItem : _arrStrings)
+            {
+                _szItem = std::to_string(_oRandom());
+            }
+
+            ParallelSort(_pTaskRunner, Span<std::string>(_arrStrings.data(), _arrStrings.size()));
+            Assert::IsTrue(std::is_sorted(_arrStrings.begin(), _arrStrings.end()));
+        }
+
+        TEST_METHOD(ParallelSort大量重复元素)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            // 全部相等
+            std::vector<uint32_t> _arrItems(1000000, 7u);
+            ParallelSort(_pTaskRunner, Span<uint32_t>(_arrItems.data(), _arrItems.size()));
+            Assert::IsTrue(std::all_of(_arrItems.begin(), _arrItems.end(), [](uint32_t _uItem) { return _uItem == 7u; }));
+
+            // 只有 0 和 1
+            std::mt19937 _oRandom(2);
+            for (auto& _uItem : _arrItems)
+            {
+                _uItem = _oRandom() & 1;
+            }
+            const auto _cZero = std::count(_arrItems.begin(), _arrItems.end(), 0u);
+
+            ParallelSort(_pTaskRunner, Span<uint32_t>(_arrItems.data(), _arrItems.size()));
+            Assert::IsTrue(std::is_sorted(_arrItems.begin(), _arrItems.end()));
+            Assert::AreEqual(size_t(std::count(_arrItems.begin(), _arrItems.end(), 0u)), size_t(_cZero));
+
+            // 少量取值混合少量随机值
+            for (auto& _uItem : _arrItems)
+            {
+                const auto _uRandom = _oRandom();
+                _uItem = _uRandom % 8 ? _uRandom % 3 : _uRandom;
+            }
+
+            auto _arrExpected = _arrItems;
+            std::sort(_arrExpected.begin(), _arrExpected.end());
+
+            ParallelSort(_pTaskRunner, Span<uint32_t>(_arrItems.data(), _arrItems.size()));
+            Assert::IsTrue(_arrItems == _arrExpected);
+        }
+    };
+}
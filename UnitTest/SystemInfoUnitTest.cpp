@@ -0,0 +1,49 @@
+﻿#include "CppUnitTest.h"
+
+#include <Windows.h>
+
+#include <YY/Base/Utils/SystemInfo.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(SystemInfoUnitTest)
+    {
+    public:
+        TEST_METHOD(处理器拓扑)
+        {
+            const auto _oInfo = GetProcessorInfo();
+
+            Assert::IsTrue(_oInfo.cLogicalProcessors >= 1u);
+            Assert::IsTrue(_oInfo.cEffectiveProcessors >= 1u);
+            Assert::IsTrue(_oInfo.cEffectiveProcessors <= _oInfo.cLogicalProcessors);
+            Assert::IsTrue(_oInfo.cPhysicalCores >= 1u);
+            Assert::IsTrue(_oInfo.cPhysicalCores <= _oInfo.cLogicalProcessors);
+            Assert::IsTrue(_oInfo.cSmtSiblings >= 1u);
+            Assert::IsTrue(_oInfo.cNumaNodes >= 1u);
+
+            Assert::AreEqual(GetEffectiveProcessorCount(), _oInfo.cEffectiveProcessors);
+        }
+
+        TEST_METHOD(有效处理器数受亲和性限制)
+        {
+            DWORD_PTR _fProcessMask = 0;
+            DWORD_PTR _fSystemMask = 0;
+            Assert::IsTrue(GetProcessAffinityMask(GetCurrentProcess(), &_fProcessMask, &_fSystemMask) != FALSE);
+
+            // 只保留一个处理器，缓存刷新后有效处理器数应该变为 1
+            const auto _fSingleMask = _fProcessMask & (~_fProcessMask + 1);
+            if (_fSingleMask == _fSystemMask)
+                return;
+
+            Assert::IsTrue(SetProcessAffinityMask(GetCurrentProcess(), _fSingleMask) != FALSE);
+            Sleep(1100);
+            const auto _cEffectiveProcessors = GetEffectiveProcessorCount();
+            SetProcessAffinityMask(GetCurrentProcess(), _fProcessMask);
+
+            Assert::AreEqual(_cEffectiveProcessors, 1u);
+        }
+    };
+}
@@ -9,6 +9,7 @@
 #include <YY/Base/Time/TickCount.h>
 #include <YY/Base/Strings/String.h>
 #include <YY/Base/Threading/Task.h>
+#include <YY/Base/Utils/SystemInfo.h>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -52,6 +53,180 @@ namespace TaskRunnerUnitTest
             }
         }
 
+        TEST_METHOD(PostTasks批量投递保持顺序)
+        {
+            auto _pTaskRunner = SequencedTaskRunner::Create();
+
+            uint32_t _uNext = 0;
+            volatile uint32_t _uCount = 0;
+
+            std::function<void(void)> _arrTasks[300];
+            for (uint32_t i = 0; i != 300; ++i)
+            {
+                _arrTasks[i] = [i, &_uNext, &_uCount]()
+                {
+                    Assert::AreEqual(_uNext, i);
+                    ++_uNext;
+                    Sync::Increment(&_uCount);
+                };
+            }
+
+            Assert::AreEqual(_pTaskRunner->PostTasks(YY::Span<std::function<void(void)>>(_arrTasks)), S_OK);
+
+            for (int i = 0; _uCount != 300; ++i)
+            {
+                Assert::IsTrue(i < 100);
+
+                Sleep(100);
+            }
+        }
+
+        TEST_METHOD(高优先级任务优先执行)
+        {
+            auto _pTaskRunner = SequencedTaskRunner::Create();
+
+            volatile uint32_t _bStart = 0;
+            volatile uint32_t _uCount = 0;
+            uint32_t _uBackgroundCount = 0;
+            uint32_t _uBackgroundCountBeforeUserBlocking = UINT32_MAX;
+
+            // 先阻塞住 TaskRunner，保证后续任务全部排队
+            _pTaskRunner->PostTask(
+                [&_bStart]()
+                {
+                    while (_bStart == 0)
+                        Sleep(1);
+                });
+
+            for (auto i = 0; i != 100; ++i)
+            {
+                _pTaskRunner->PostTask(
+                    [&_uBackgroundCount, &_uCount]()
+                    {
+                        ++_uBackgroundCount;
+                        Sync::Increment(&_uCount);
+                    },
+                    TaskPriority::Background);
+            }
+
+            _pTaskRunner->PostTask(
+                [&_uBackgroundCount, &_uBackgroundCountBeforeUserBlocking, &_uCount]()
+                {
+                    _uBackgroundCountBeforeUserBlocking = _uBackgroundCount;
+                    Sync::Increment(&_uCount);
+                },
+                TaskPriority::UserBlocking);
+
+            _bStart = 1;
+
+            for (int i = 0; _uCount != 101; ++i)
+            {
+                Assert::IsTrue(i < 100);
+
+                Sleep(100);
+            }
+
+            Assert::AreEqual(_uBackgroundCountBeforeUserBlocking, 0u);
+        }
+
+        TEST_METHOD(时间片用完后让出线程)
+        {
+            // SequencedTaskRunner 每次从线程池取得线程时都会把线程描述设置为自身的描述，而每个任务随后都会改写线程描述，
+            // 因此任务开始时读到 TaskRunner 的描述，说明它是新时间片中的第一个任务。这与线程池的线程数无关。
+            constexpr uint32_t kTaskCount = 64;
+            auto _pfnCollect = [](RefPtr<SequencedTaskRunner> _pTaskRunner, bool* _pbFirstInQuantum)
+            {
+                volatile bool _bReady = false;
+                for (uint32_t i = 0; i != kTaskCount; ++i)
+                {
+                    _pTaskRunner->PostTask(
+                        [i, &_bReady, _pbFirstInQuantum]()
+                        {
+                            // 全部任务投递完成后才开始执行，避免队列中途变空提前结束时间片
+                            for (int j = 0; !_bReady; ++j)
+                            {
+                                Assert::IsTrue(j < 10000);
+                                Sleep(1);
+                            }
+
+                            PWSTR _szDescription = nullptr;
+                            Assert::IsTrue(SUCCEEDED(GetThreadDescription(GetCurrentThread(), &_szDescription)));
+                            _pbFirstInQuantum[i] = wcscmp(_szDescription, L"时间片") == 0;
+                            LocalFree(_szDescription);
+                            SetThreadDescription(GetCurrentThread(), L"时间片内");
+                        });
+                }
+
+                _bReady = true;
+                Assert::AreEqual(_pTaskRunner->Join(TimeSpan::GetMax()), S_OK);
+            };
+
+            // 每 4 个任务让出一次线程
+            bool _arrFirstInQuantum[kTaskCount] = {};
+            _pfnCollect(SequencedTaskRunner::Create(4, TimeSpan::GetMax(), _S("时间片")), _arrFirstInQuantum);
+            for (uint32_t i = 0; i != kTaskCount; ++i)
+            {
+                Assert::AreEqual(_arrFirstInQuantum[i], i % 4 == 0);
+            }
+
+            // 默认不限制时间片，一直执行到队列为空
+            _pfnCollect(SequencedTaskRunner::Create(_S("时间片")), _arrFirstInQuantum);
+            for (uint32_t i = 0; i != kTaskCount; ++i)
+            {
+                Assert::AreEqual(_arrFirstInQuantum[i], i == 0);
+            }
+        }
+
+        TEST_METHOD(RunOrPostTask空闲时直接执行)
+        {
+            auto _pTaskRunner = SequencedTaskRunner::Create();
+            auto _pTargetTaskRunner = SequencedTaskRunner::Create();
+
+            auto _oTask = _pTaskRunner->CreateTask(
+                [_pTaskRunner, _pTargetTaskRunner]()
+                {
+                    bool _bRun = false;
+                    TaskRunner* _pCurrent = nullptr;
+                    Assert::AreEqual(_pTargetTaskRunner->RunOrPostTask(
+                        [&_bRun, &_pCurrent]()
+                        {
+                            _bRun = true;
+                            _pCurrent = TaskRunner::GetCurrent().Get();
+                        }), S_OK);
+
+                    // 目标空闲，任务已经在当前线程执行完毕
+                    Assert::IsTrue(_bRun);
+                    Assert::AreEqual((void*)_pCurrent, (void*)_pTargetTaskRunner.Get());
+                    Assert::AreEqual((void*)TaskRunner::GetCurrent().Get(), (void*)_pTaskRunner.Get());
+                });
+            _oTask.GetResult();
+
+            // 目标忙碌时退化为投递
+            volatile uint32_t _bStart = 0;
+            volatile uint32_t _bRun = 0;
+            _pTargetTaskRunner->PostTask(
+                [&_bStart]()
+                {
+                    while (_bStart == 0)
+                        Sleep(1);
+                });
+
+            Assert::AreEqual(_pTargetTaskRunner->RunOrPostTask(
+                [&_bRun]()
+                {
+                    _bRun = 1;
+                }), S_OK);
+            Assert::AreEqual((uint32_t)_bRun, 0u);
+
+            _bStart = 1;
+            for (int i = 0; _bRun == 0; ++i)
+            {
+                Assert::IsTrue(i < 100);
+
+                Sleep(100);
+            }
+        }
+
         TEST_METHOD(TaskRunner销毁后任务全部自动取消)
         {
             auto _pTaskRunner = SequencedTaskRunner::Create();
@@ -472,6 +647,140 @@ namespace TaskRunnerUnitTest
             }
         }
 
+
+        TEST_METHOD(PostTasks批量投递并行数量保证)
+        {
+            uint32_t _uCount = 0;
+            volatile uint32_t _uMaxCount = 0;
+            volatile uint32_t _uCount2 = 0;
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            std::function<void(void)> _arrTasks[200];
+            for (auto& _pfnTask : _arrTasks)
+            {
+                _pfnTask = [&_uCount, &_uCount2, &_uMaxCount]()
+                {
+                    auto _uNew = Sync::Increment(&_uCount);
+                    Assert::IsTrue(_uNew <= 4u);
+                    auto _uOldMaxCount = _uMaxCount;
+                    for (; _uOldMaxCount < _uNew;)
+                    {
+                        auto _uLast = Sync::CompareExchange(&_uMaxCount, _uNew, _uOldMaxCount);
+                        if (_uLast == _uOldMaxCount)
+                        {
+                            break;
+                        }
+
+                        _uOldMaxCount = _uLast;
+                    }
+
+                    Sleep(5);
+
+                    Assert::IsTrue(Sync::Decrement(&_uCount) < 4u);
+
+                    Sync::Increment(&_uCount2);
+                };
+            }
+
+            Assert::AreEqual(_pTaskRunner->PostTasks(YY::Span<std::function<void(void)>>(_arrTasks)), S_OK);
+
+            for (int i = 0; _uCount2 != 200; ++i)
+            {
+                Assert::IsTrue(i < 100);
+
+                Sleep(1000);
+            }
+
+            Assert::AreEqual((uint32_t)_uMaxCount, 4u);
+        }
+
+        TEST_METHOD(固定NUMA节点执行)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(2, 0);
+            Assert::AreEqual(_pTaskRunner->GetNumaNode(), 0u);
+
+            volatile uint32_t _cOtherNode = 0;
+            volatile uint32_t _cCompleted = 0;
+            for (auto i = 0; i != 100; ++i)
+            {
+                _pTaskRunner->PostTask(
+                    [&_cOtherNode, &_cCompleted]()
+                    {
+                        if (YY::GetCurrentNumaNode() != 0)
+                            Sync::Increment(&_cOtherNode);
+
+                        Sync::Increment(&_cCompleted);
+                    });
+            }
+
+            for (int i = 0; _cCompleted != 100; ++i)
+            {
+                Assert::IsTrue(i < 100);
+
+                Sleep(100);
+            }
+
+            Assert::AreEqual((uint32_t)_cOtherNode, 0u);
+        }
+
+        TEST_METHOD(等待同一TaskRunner的任务时帮助执行)
+        {
+            // 只允许一个并行，等待中的线程不帮助执行时内部任务永远无法开始
+            auto _pTaskRunner = ParallelTaskRunner::Create(1);
+            _pTaskRunner->SetHelpWhileWaiting(true);
+
+            auto _oTask = _pTaskRunner->CreateTask(
+                [_pTaskRunner]()
+                {
+                    auto _oInnerTask = _pTaskRunner->CreateTask(
+                        []()
+                        {
+                            return 8848;
+                        });
+
+                    return _oInnerTask.GetResult() + 1;
+                });
+
+            Assert::AreEqual(8849, _oTask.GetResult());
+        }
+
+        TEST_METHOD(默认等待时不帮助执行其他任务)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(1);
+            auto _pSource = YY::RefPtr<YY::AsyncOperationImpl<void>>::Create();
+
+            volatile bool _bWaiting = false;
+            volatile bool _bOtherExecuted = false;
+            bool _bOtherExecutedWhileWaiting = true;
+            auto _oWaitTask = _pTaskRunner->CreateTask(
+                [_pSource, &_bWaiting, &_bOtherExecuted, &_bOtherExecutedWhileWaiting]()
+                {
+                    _bWaiting = true;
+                    YY::Task<void>(_pSource).GetResult();
+                    _bOtherExecutedWhileWaiting = _bOtherExecuted;
+                });
+
+            for (int i = 0; !_bWaiting; ++i)
+            {
+                Assert::IsTrue(i < 10000);
+                Sleep(1);
+            }
+
+            // 与等待无关的任务不能在等待者的调用栈内执行
+            auto _oOtherTask = _pTaskRunner->CreateTask(
+                [&_bOtherExecuted]()
+                {
+                    _bOtherExecuted = true;
+                });
+            Sleep(100);
+            Assert::IsFalse((bool)_bOtherExecuted);
+
+            _pSource->Resolve();
+            _oWaitTask.GetResult();
+            _oOtherTask.GetResult();
+            Assert::IsFalse(_bOtherExecutedWhileWaiting);
+            Assert::IsTrue((bool)_bOtherExecuted);
+        }
         
         TEST_METHOD(TaskRunner销毁后任务全部自动取消)
         {
@@ -571,6 +880,38 @@ namespace TaskRunnerUnitTest
         }
 
 
+        TEST_METHOD(ThreadTaskRunner独占线程与忙等待)
+        {
+            auto _hEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+            ThreadTaskRunnerOptions _oOptions;
+            _oOptions.bDedicatedThread = true;
+            _oOptions.ePriority = ThreadSchedulingPriority::High;
+            _oOptions.fProcessorAffinityMask = 1;
+            _oOptions.uBusyPollTime = TimeSpan::FromMilliseconds(10);
+            _oOptions.szThreadDescription = L"ThreadTaskRunner独占线程与忙等待";
+            auto _pTaskRunner = ThreadTaskRunner::Create(_oOptions);
+            Assert::IsNotNull(_pTaskRunner.Get());
+
+            volatile uint32_t _uCount = 0;
+            volatile DWORD_PTR _fAffinityMask = 0;
+            for (uint32_t _uIndex = 0; _uIndex != 100; ++_uIndex)
+            {
+                _pTaskRunner->PostTask([&_uCount, &_fAffinityMask, _hEvent]()
+                    {
+                        _fAffinityMask = SetThreadAffinityMask(GetCurrentThread(), 1);
+                        YY::Increment(&_uCount);
+                        SetEvent(_hEvent);
+                    });
+
+                Assert::AreEqual(WaitForSingleObject(_hEvent, 1000), WAIT_OBJECT_0);
+            }
+
+            Assert::AreEqual((uint32_t)_uCount, 100u);
+            Assert::AreEqual((DWORD_PTR)_fAffinityMask, DWORD_PTR(1));
+            CloseHandle(_hEvent);
+        }
+
         TEST_METHOD(线程Id获取)
         {
             auto _hEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
@@ -1360,6 +1701,79 @@ namespace TaskRunnerUnitTest
                 Assert::AreEqual(int32_t(0), _WhenAnyTask.GetResult());
             }
         }
+
+        TEST_METHOD(数组WhenAll语义)
+        {
+            auto _pTaskRunner = ParallelTaskRunner::Create(4);
+
+            {
+                YY::Task<int> _arrTasks[256];
+                for (int i = 0; i != 256; ++i)
+                {
+                    _arrTasks[i] = _pTaskRunner->CreateTask(
+                        [i]()
+                        {
+                            return i * 2;
+                        });
+                }
+
+                auto _WhenAllTask = YY::WhenAll(YY::Span<YY::Task<int>>(_arrTasks));
+
+                Assert::IsTrue(_WhenAllTask.GetAsyncOperation()->WaitTask(YY::TimeSpan::FromMilliseconds(2000ul)));
+                Assert::IsTrue(_WhenAllTask.GetStatus() == AsyncStatus::Completed);
+                auto& _arrResults = _WhenAllTask.GetResult();
+                Assert::AreEqual(_arrResults.GetSize(), size_t(256));
+                for (int i = 0; i != 256; ++i)
+                {
+                    Assert::AreEqual(_arrResults[i], i * 2);
+                }
+            }
+
+            {
+                YY::Task<int> _arrTasks[2];
+                _arrTasks[0] = _pTaskRunner->CreateTask(
+                    []() -> int
+                    {
+                        throw YY::Exception(E_ACCESSDENIED);
+                    });
+                _arrTasks[1] = _pTaskRunner->CreateTask(
+                    []()
+                    {
+                        return 2;
+                    });
+
+                auto _WhenAllTask = YY::WhenAll(YY::Span<YY::Task<int>>(_arrTasks));
+                _WhenAllTask.GetAsyncOperation()->WaitTask(YY::TimeSpan::FromMilliseconds(2000ul));
+                Assert::IsTrue(_WhenAllTask.GetStatus() == AsyncStatus::Error);
+                Assert::AreEqual(HRESULT(E_ACCESSDENIED), _WhenAllTask.GetErrorCode());
+            }
+        }
+
+        TEST_METHOD(数组WhenAny语义)
+        {
+            auto _pTaskRunner = SequencedTaskRunner::Create();
+
+            YY::Task<int> _arrTasks[3];
+            _arrTasks[0] = _pTaskRunner->CreateTask(
+                []()
+                {
+                    Sleep(100);
+                    return 1;
+                });
+            _arrTasks[1] = YY::Task<int>(YY::RefPtr<YY::AsyncOperationImpl<int>>::Create());
+            _arrTasks[2] = _pTaskRunner->CreateTask(
+                []()
+                {
+                    return 3;
+                });
+
+            auto _WhenAnyTask = YY::WhenAny(YY::Span<YY::Task<int>>(_arrTasks));
+
+            Assert::IsTrue(_WhenAnyTask.GetAsyncOperation()->WaitTask(YY::TimeSpan::FromMilliseconds(2000ul)));
+            Assert::AreEqual(int32_t(0), _WhenAnyTask.GetResult());
+
+            Assert::IsTrue(YY::WhenAny(YY::Span<YY::Task<int>>()).GetStatus() == AsyncStatus::Error);
+        }
     };
 
     TEST_CLASS(CommonTaskRunnerUnitTest)
@@ -1390,6 +1804,61 @@ namespace TaskRunnerUnitTest
 
             Assert::AreEqual(HRESULT(S_OK), HRESULT(*_pHr));
         }
+
+        TEST_METHOD(co_await链内联恢复不加深调用栈)
+        {
+            auto _pSource = YY::RefPtr<YY::AsyncOperationImpl<uint32_t>>::Create();
+
+            auto _pfnNext = [](YY::Task<uint32_t> _oPrevious) -> YY::Task<uint32_t>
+            {
+                auto _uResult = co_await _oPrevious;
+                co_return _uResult + 1;
+            };
+
+            // 每一层都在等待上一层，源完成时整条链依次在当前线程恢复
+            constexpr uint32_t kDepth = 100000;
+            YY::Task<uint32_t> _oTask(_pSource);
+            for (uint32_t i = 0; i != kDepth; ++i)
+            {
+                _oTask = _pfnNext(std::move(_oTask));
+            }
+
+            _pSource->Resolve(1u);
+            Assert::AreEqual(_oTask.GetResult(), kDepth + 1);
+            Assert::IsFalse(YY::CoroutineTrampoline::IsRunning());
+        }
+
+        TEST_METHOD(内联恢复的协程内Resolve同步恢复等待者)
+        {
+            auto _pOuterSource = YY::RefPtr<YY::AsyncOperationImpl<void>>::Create();
+            auto _pInnerSource = YY::RefPtr<YY::AsyncOperationImpl<void>>::Create();
+
+            auto _pfnInner = [](YY::Task<void> _oSource) -> YY::Task<uint32_t>
+            {
+                co_await _oSource;
+                co_return 5;
+            };
+
+            auto _oInnerTask = _pfnInner(YY::Task<void>(_pInnerSource));
+
+            auto _pfnOuter = [](YY::Task<void> _oSource, YY::RefPtr<YY::AsyncOperationImpl<void>> _pInnerSource, YY::Task<uint32_t> _oInnerTask) -> YY::Task<uint32_t>
+            {
+                co_await _oSource;
+                Assert::IsTrue(YY::CoroutineTrampoline::IsRunning());
+
+                // 只有协程结束时触发的恢复才会排队，协程体内 Resolve 时等待者依然同步恢复
+                _pInnerSource->Resolve();
+                Assert::IsTrue(_oInnerTask.GetStatus() == AsyncStatus::Completed);
+                co_return _oInnerTask.GetResult() + 1;
+            };
+
+            auto _oOuterTask = _pfnOuter(YY::Task<void>(_pOuterSource), _pInnerSource, _oInnerTask);
+            _pOuterSource->Resolve();
+
+            Assert::IsTrue(_oOuterTask.GetStatus() == AsyncStatus::Completed);
+            Assert::AreEqual(_oOuterTask.GetResult(), 6u);
+            Assert::IsFalse(YY::CoroutineTrampoline::IsRunning());
+        }
 #endif
 
 #if defined(_HAS_CXX20) && _HAS_CXX20 && defined(_WIN32)
@@ -0,0 +1,134 @@
+﻿#include "CppUnitTest.h"
+
+#include <thread>
+#include <vector>
+
+#include <YY/Base/Memory/ThreadCacheAllocator.h>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+using namespace YY;
+
+namespace UnitTest
+{
+    TEST_CLASS(ThreadCacheAllocatorUnitTest)
+    {
+    public:
+        TEST_METHOD(尺寸分级)
+        {
+            for (size_t _cbSize = 0; _cbSize <= ThreadCacheAllocator::kMaxSmallSize; ++_cbSize)
+            {
+                const auto _uSizeClass = ThreadCacheAllocator::GetSizeClass(_cbSize);
+                Assert::IsTrue(_uSizeClass < ThreadCacheAllocator::kSizeClassCount);
+                Assert::IsTrue(ThreadCacheAllocator::GetSizeClassSize(_uSizeClass) >= _cbSize);
+
+                if (_uSizeClass)
+                    Assert::IsTrue(ThreadCacheAllocator::GetSizeClassSize(_uSizeClass - 1) < _cbSize);
+            }
+
+            Assert::AreEqual(ThreadCacheAllocator::GetSizeClass(ThreadCacheAllocator::kMaxSmallSize + 1), ThreadCacheAllocator::kSizeClassCount);
+        }
+
+        TEST_METHOD(申请与释放)
+        {
+            auto _pBlock = (byte_t*)ThreadCacheAllocator::AllocAndZero(40);
+            Assert::IsNotNull(_pBlock);
+            Assert::IsTrue(ThreadCacheAllocator::GetBlockSize(_pBlock) >= 40);
+
+            // 同一级别内原地扩展
+            Assert::IsTrue(ThreadCacheAllocator::ReAlloc(_pBlock, 48) == _pBlock);
+
+            _pBlock = (byte_t*)ThreadCacheAllocator::ReAllocAndZero(_pBlock, 200);
+            Assert::IsNotNull(_pBlock);
+            for (size_t _uIndex = 0; _uIndex != 200; ++_uIndex)
+            {
+                Assert::AreEqual(_pBlock[_uIndex], byte_t(0));
+            }
+
+            // 大块内存
+            _pBlock = (byte_t*)ThreadCacheAllocator::ReAlloc(_pBlock, 64 * 1024);
+            Assert::IsNotNull(_pBlock);
+            Assert::AreEqual(ThreadCacheAllocator::GetBlockSize(_pBlock), size_t(64 * 1024));
+            ThreadCacheAllocator::Free(_pBlock);
+
+            // 释放后再次申请同一级别，优先复用线程缓存
+            auto _pBlock1 = ThreadCacheAllocator::Alloc(24);
+            ThreadCacheAllocator::Free(_pBlock1);
+            auto _pBlock2 = ThreadCacheAllocator::Alloc(32);
+            Assert::IsTrue(_pBlock1 == _pBlock2);
+            ThreadCacheAllocator::Free(_pBlock2);
+        }
+
+        TEST_METHOD(刷新NUMA节点)
+        {
+            ThreadCacheAllocator::Statistics _oBefore;
+            ThreadCacheAllocator::GetStatistics(&_oBefore);
+
+            std::thread _oThread(
+                []()
+                {
+                    // 还没有线程缓存时不做任何事情
+                    ThreadCacheAllocator::RefreshCurrentThreadNumaNode();
+
+                    auto _pBlock = ThreadCacheAllocator::Alloc(24);
+                    Assert::IsNotNull(_pBlock);
+                    ThreadCacheAllocator::Free(_pBlock);
+
+                    // 节点变化时缓存的块归还到原节点，之后依然可以正常申请、释放
+                    ThreadCacheAllocator::RefreshCurrentThreadNumaNode();
+
+                    _pBlock = ThreadCacheAllocator::Alloc(24);
+                    Assert::IsNotNull(_pBlock);
+                    ThreadCacheAllocator::Free(_pBlock);
+                });
+            _oThread.join();
+
+            ThreadCacheAllocator::Statistics _oAfter;
+            ThreadCacheAllocator::GetStatistics(&_oAfter);
+            Assert::AreEqual(_oAfter.uAllocCount - _oBefore.uAllocCount, size_t(2));
+            Assert::AreEqual(_oAfter.uFreeCount - _oBefore.uFreeCount, size_t(2));
+        }
+
+        TEST_METHOD(跨线程释放)
+        {
+            ThreadCacheAllocator::Statistics _oBefore;
+            ThreadCacheAllocator::GetStatistics(&_oBefore);
+
+            std::vector<void*> _arrBlocks;
+            for (size_t _uIndex = 0; _uIndex != 10000; ++_uIndex)
+            {
+                auto _pBlock = ThreadCacheAllocator::Alloc(_uIndex % 256);
+                Assert::IsNotNull(_pBlock);
+                _arrBlocks.push_back(_pBlock);
+            }
+
+            // 其他线程释放的块按批次进入中心缓存
+            std::thread _oThread(
+                [&_arrBlocks]()
+                {
+                    for (auto _pBlock : _arrBlocks)
+                    {
+                        ThreadCacheAllocator::Free(_pBlock);
+                    }
+                });
+            _oThread.join();
+
+            for (auto& _pBlock : _arrBlocks)
+            {
+                _pBlock = ThreadCacheAllocator::Alloc(64);
+                Assert::IsNotNull(_pBlock);
+            }
+
+            for (auto _pBlock : _arrBlocks)
+            {
+                ThreadCacheAllocator::Free(_pBlock);
+            }
+
+            ThreadCacheAllocator::Statistics _oAfter;
+            ThreadCacheAllocator::GetStatistics(&_oAfter);
+            Assert::AreEqual(_oAfter.uAllocCount - _oBefore.uAllocCount, size_t(20000));
+            Assert::AreEqual(_oAfter.uFreeCount - _oBefore.uFreeCount, size_t(20000));
+            Assert::IsTrue(_oAfter.uCentralReleaseCount > _oBefore.uCentralReleaseCount);
+            Assert::IsTrue(_oAfter.uCentralFetchCount > _oBefore.uCentralFetchCount);
+        }
+    };
+}
@@ -37,6 +37,7 @@ LockBuffer 与 UnlockBuffer 必须成对出现！
 #include <YY/Base/Containers/ConstructorPolicy.h>
 #include <YY/Base/ErrorCode.h>
 #include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Memory/Arena.h>
 
 #pragma pack(push, __YY_PACKING)
 
@@ -76,6 +77,18 @@ namespace YY
                 {
                 }
 
+                /// <summary>
+                /// 创建一个从 _oArena 分配内存的空数组，之后的扩容与写时复制都从同一个 Arena 分配。
+                /// </summary>
+                explicit AllocPolicyArray(_In_ Arena& _oArena)
+                {
+                    auto _pSharedData = SharedData::Alloc(0, &_oArena);
+                    if (!_pSharedData)
+                        throw Exception(_S("SharedArray构造失败！"), E_OUTOFMEMORY);
+
+                    pData = _pSharedData->GetData();
+                }
+
                 ~AllocPolicyArray()
                 {
                     auto _pInternalData = GetInternalData();
@@ -132,7 +145,7 @@ namespace YY
                     if (_pInternalData->IsShared())
                     {
                         // 共享模式中放弃原有内存，重新申请内存即可。
-                        auto _pNewSharedData = SharedData::Alloc(_uCount);
+                        auto _pNewSharedData = SharedData::Alloc(_uCount, _pInternalData->GetArena());
                         if (!_pNewSharedData)
                             return E_OUTOFMEMORY;
 
@@ -220,7 +233,9 @@ namespace YY
                 // WirteOnCopy机制内部的内存块
                 struct SharedData
                 {
-                    // 暂不使用
+                    // 内存来自 Arena，通过 Arena::GetBlockArena 获取所属的 Arena，释放时不需要 Free
+                    static constexpr uint_t kArenaAllocatedMark = 0x00000001u;
+
                     uint_t fMarks;
                     // 如果 >= 0，那么表示这块内存的引用次数。
                     // 如果 <  0，那么表示内存锁定次数。
@@ -287,6 +302,19 @@ namespace YY
                         return iRef > 1;
                     }
 
+                    bool __YYAPI IsArenaAllocated() const
+                    {
+                        return (fMarks & kArenaAllocatedMark) != 0;
+                    }
+
+                    /// <summary>
+                    /// 返回内存所属的 Arena，来自堆时返回 nullptr。
+                    /// </summary>
+                    _Ret_maybenull_ Arena* __YYAPI GetArena() const
+                    {
+                        return IsArenaAllocated() ? Arena::GetBlockArena(this) : nullptr;
+                    }
+
                     size_t __YYAPI GetLockedCount()
                     {
                         if (iRef >= 0)
@@ -408,19 +436,23 @@ namespace YY
                         auto _uSize = _pOldSharedData->GetSize();
                         SharedData* _pNewSharedData;
 
-                        if YY_CPP17_IF_CONSTEXPR (std::is_trivially_copyable<_Type>::value)
+                        if YY_CPP17_IF_CONSTEXPR (IsTriviallyRelocatable<_Type>::value)
                         {
-                            _pNewSharedData = (SharedData*)YY::Base::Memory::ReAlloc(_pOldSharedData, sizeof(SharedData) + sizeof(_Type) * _uNewCapacity);
+                            // 元素可以直接按字节搬移，交给 realloc 原地扩展或者整体复制。
+                            _pNewSharedData = (SharedData*)Arena::ReAllocBlock(
+                                _pOldSharedData,
+                                _pOldSharedData->GetArena(),
+                                sizeof(SharedData) + sizeof(_Type) * _pOldSharedData->GetCapacity(),
+                                sizeof(SharedData) + sizeof(_Type) * _uNewCapacity);
                             if (!_pNewSharedData)
                                 return nullptr;
                         }
                         else
                         {
-                            _pNewSharedData = (SharedData*)Alloc(sizeof(SharedData) + sizeof(_Type) * _uNewCapacity);
+                            _pNewSharedData = Alloc(_uNewCapacity, _pOldSharedData->GetArena());
                             if (!_pNewSharedData)
                                 return nullptr;
 
-                            _pNewSharedData->fMarks = _pOldSharedData->fMarks;
                             _pNewSharedData->iRef = _pOldSharedData->iRef;
 
                             ConstructorPolicy<_Type>::MoveConstructor(_pNewSharedData->GetData(), _pOldSharedData->GetData(), _pOldSharedData->GetSize());
@@ -432,18 +464,24 @@ namespace YY
                         return _pNewSharedData;
                     }
 
-                    static _Ret_maybenull_ SharedData* __YYAPI Alloc(size_t _uNewCapacity)
+                    /// <summary>
+                    /// 申请新的 SharedData。
+                    /// </summary>
+                    /// <param name="_uNewCapacity">期望的容量</param>
+                    /// <param name="_pArena">从哪个 Arena 分配，为 nullptr 时从堆分配。容量为 0 时依然会申请内存用于记录 Arena。</param>
+                    static _Ret_maybenull_ SharedData* __YYAPI Alloc(size_t _uNewCapacity, _In_opt_ Arena* _pArena = nullptr)
                     {
                         // 向上对齐到 16
                         _uNewCapacity = (_uNewCapacity + 15) & ~15;
 
-                        if (_uNewCapacity == 0)
+                        if (_uNewCapacity == 0 && _pArena == nullptr)
                             return SharedData::GetEmptySharedData();
 
-                        auto _pNewSharedData = (SharedData*)YY::Base::Memory::Alloc(sizeof(SharedData) + sizeof(_Type) * _uNewCapacity);
+                        const auto _cbNewSharedData = sizeof(SharedData) + sizeof(_Type) * _uNewCapacity;
+                        auto _pNewSharedData = (SharedData*)Arena::AllocBlock(_pArena, _cbNewSharedData);
                         if (!_pNewSharedData)
                             return nullptr;
-                        _pNewSharedData->fMarks = 0;
+                        _pNewSharedData->fMarks = _pArena ? kArenaAllocatedMark : 0u;
                         _pNewSharedData->iRef = 1;
                         _pNewSharedData->uCapacity = _uNewCapacity;
                         _pNewSharedData->uSize = 0;
@@ -457,7 +495,7 @@ namespace YY
                         if (_uNewCapacity < _uSize)
                             _uNewCapacity = _uSize;
 
-                        auto _pNewSharedData = Alloc(_uNewCapacity);
+                        auto _pNewSharedData = Alloc(_uNewCapacity, GetArena());
                         if (!_pNewSharedData)
                             return nullptr;
 
@@ -471,8 +509,9 @@ namespace YY
                         if (_pSharedData == nullptr || _pSharedData->IsReadOnly())
                             return;
 
+                        const auto _pArena = _pSharedData->GetArena();
                         _pSharedData->~SharedData();
-                        YY::Base::Memory::Free(_pSharedData);
+                        Arena::FreeBlock(_pSharedData, _pArena);
                     }
                 };
 
@@ -701,7 +740,7 @@ namespace YY
                                 abort();
 
                             ConstructorPolicy<_Type>::Destructor(Large.pData, uSize);
-                            free(Large.pData);
+                            Free(Large.pData);
                         }
                     }
             
@@ -815,8 +854,7 @@ namespace YY
                                 return E_OUTOFMEMORY;
                 
                             // 从 Small切换到 Large
-                            ConstructorPolicy<_Type>::MoveConstructor(_pData, Small.GetData(), uSize);
-                            ConstructorPolicy<_Type>::Destructor(Small.GetData(), uSize);
+                            ConstructorPolicy<_Type>::Relocate(_pData, Small.GetData(), uSize);
                             Large.pData = _pData;
                             Large.uCapacity = _uNewCapacity;
                             Large.uLockCount =0;
@@ -833,7 +871,7 @@ namespace YY
                                 return E_INVALIDARG;
                             }
 
-                            if YY_CPP17_IF_CONSTEXPR (std::is_trivially_copyable<_Type>::value)
+                            if YY_CPP17_IF_CONSTEXPR (IsTriviallyRelocatable<_Type>::value)
                             {
                                 auto _pData = (_Type*)ReAlloc(Large.pData, _uNewCapacity * sizeof(_Type));
                                 if (!_pData)
@@ -848,9 +886,8 @@ namespace YY
                                 if(!_pData)
                                     return E_OUTOFMEMORY;
 
-                                ConstructorPolicy<_Type>::MoveConstructor(_pData, Large.pData, uSize);
-                                ConstructorPolicy<_Type>::Destructor(Large.pData, uSize);
-                                free(Large.pData);
+                                ConstructorPolicy<_Type>::Relocate(_pData, Large.pData, uSize);
+                                Free(Large.pData);
 
                                 Large.pData = _pData;
                                 Large.uCapacity = _uNewCapacity;
@@ -1059,6 +1096,8 @@ namespace YY
                 using _ReadPoint = typename CurrentAllocPolicyArray::_ReadPoint;
                 using _ReadType = typename CurrentAllocPolicyArray::_ReadType;
                 static constexpr AllocPolicy eAllocPolicy = _eAllocPolicy;
+                // COW 模式只持有一个指向堆的指针；SOO 模式的内置缓冲区不存在自引用，只要元素可以重定位即可。
+                using TriviallyRelocatable = std::integral_constant<bool, _eAllocPolicy == AllocPolicy::COW || IsTriviallyRelocatable<_Type>::value>;
                 
                 constexpr static size_t uInvalidIndex = (std::numeric_limits<size_t>::max)();
 
@@ -1080,6 +1119,14 @@ namespace YY
                         abort();
                 }
 
+                /// <summary>
+                /// 创建一个从 _oArena 分配内存的空数组，仅支持 AllocPolicy::COW。
+                /// </summary>
+                explicit Array(_In_ Arena& _oArena)
+                    : CurrentAllocPolicyArray(_oArena)
+                {
+                }
+
                 Array(std::initializer_list<_Type> _List)
                 {
                     auto _hr = CurrentAllocPolicyArray::SetArray(_List.begin(), _List.size());
@@ -1252,7 +1299,10 @@ namespace YY
 
                     if (_uIndex > _uSize)
                         return E_BOUNDS;
-            
+
+                    // _NewItem 可能引用数组自身的元素（比如 Insert(0, arr[k])），扩容或者搬移后原位置已经失效，所以先复制一份。
+                    _Type _oNewItem(_NewItem);
+
                     auto _pInternalData = CurrentAllocPolicyArray::LockInternalDataIncrement(1);
                     if (!_pInternalData)
                         return E_OUTOFMEMORY;
@@ -1264,13 +1314,19 @@ namespace YY
 
                     if (_pInsert == _pLast)
                     {
-                        new (_pLast) _Type(_NewItem);
+                        new (_pLast) _Type(std::move(_oNewItem));
+                    }
+                    else if YY_CPP17_IF_CONSTEXPR (IsTriviallyRelocatable<_Type>::value)
+                    {
+                        // 整体向后搬移一个位置，然后在空出的位置直接构造，避免逐个移动赋值。
+                        ConstructorPolicy<_Type>::Relocate(_pInsert + 1, _pInsert, _pLast);
+                        new (_pInsert) _Type(std::move(_oNewItem));
                     }
                     else
                     {
                         new (_pLast) _Type(std::move(_pLast[-1]));
                         ConstructorPolicy<_Type>::Move(_pInsert + 1, _pInsert, _pLast - 1);
-                        _pData[_uIndex] = _NewItem;
+                        _pData[_uIndex] = std::move(_oNewItem);
                     }
                     _pInternalData->SetSize(_pInternalData->GetSize() + 1);
                     _pInternalData->Unlock();
@@ -1304,8 +1360,17 @@ namespace YY
                     auto _pData = _pInternalData->GetData();
                     auto _pLast = _pInternalData->GetLast();
 
-                    ConstructorPolicy<_Type>::Move(_pData + _uIndex, _pData + _uIndex + _uRemoveCount, _pLast);
-                    ConstructorPolicy<_Type>::Destructor(_pLast - _uRemoveCount, _pLast);
+                    if YY_CPP17_IF_CONSTEXPR (IsTriviallyRelocatable<_Type>::value)
+                    {
+                        // 先析构被删除的元素，再将尾部整体搬移过来。
+                        ConstructorPolicy<_Type>::Destructor(_pData + _uIndex, _pData + _uIndex + _uRemoveCount);
+                        ConstructorPolicy<_Type>::Relocate(_pData + _uIndex, _pData + _uIndex + _uRemoveCount, _pLast);
+                    }
+                    else
+                    {
+                        ConstructorPolicy<_Type>::Move(_pData + _uIndex, _pData + _uIndex + _uRemoveCount, _pLast);
+                        ConstructorPolicy<_Type>::Destructor(_pLast - _uRemoveCount, _pLast);
+                    }
                     _pInternalData->SetSize(_uSize - _uRemoveCount);
                     _pInternalData->Unlock();
 
@@ -1,9 +1,23 @@
 ﻿#pragma once
 #include <assert.h>
 #include <utility>
+#include <algorithm>
 
 #include <YY/Base/YY.h>
 #include <YY/Base/Sync/Interlocked.h>
+#include <YY/Base/ErrorCode.h>
+#include <YY/Base/Memory/Alloc.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define YY_BITMAP_USE_AVX2 1
+#elif defined(_M_AMD64) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define YY_BITMAP_USE_SSE2 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define YY_BITMAP_USE_NEON 1
+#endif
 
 #pragma pack(push, __YY_PACKING)
 
@@ -113,6 +127,12 @@ namespace YY
                 {
                     return -1;
                 }
+#elif !defined(_WIN32)
+                auto _uMask = *_puMask >> _uIndex;
+                if (_uMask == 0)
+                    return -1;
+
+                return static_cast<int32_t>(__builtin_ctzll(_uMask) + _uIndex);
 #else
                 // 搜索低32位
                 if (_uIndex < YY_bitsizeof(uint32_t))
@@ -122,6 +142,8 @@ namespace YY
                     {
                         return _nIndex;
                     }
+
+                    _uIndex = YY_bitsizeof(uint32_t);
                 }
 
                 // 没有找到再搜索高 32位
@@ -131,17 +153,286 @@ namespace YY
                     return _nIndex + YY_bitsizeof(uint32_t);
                 }
 
-                return false;
+                return -1;
+#endif
+            }
+
+            inline
+            uint32_t
+            __YYAPI
+            BitsPopCount(_In_ uint32_t _uMask) noexcept
+            {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_AMD64)) && (defined(__AVX__) || defined(__POPCNT__))
+                // popcnt 指令不属于 x86/x64 基线，在不支持的 CPU 上会触发 #UD。
+                // 只有编译目标已经保证支持（/arch:AVX 及以上）时才使用，否则退化为位运算。
+                return static_cast<uint32_t>(__popcnt(_uMask));
+#elif defined(__GNUC__) || defined(__clang__)
+                return static_cast<uint32_t>(__builtin_popcount(_uMask));
+#else
+                _uMask = _uMask - ((_uMask >> 1) & 0x55555555u);
+                _uMask = (_uMask & 0x33333333u) + ((_uMask >> 2) & 0x33333333u);
+                return (((_uMask + (_uMask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+            }
+
+            inline
+            uint32_t
+            __YYAPI
+            BitsPopCount(_In_ uint64_t _uMask) noexcept
+            {
+#if defined(_MSC_VER) && defined(_M_AMD64) && (defined(__AVX__) || defined(__POPCNT__))
+                return static_cast<uint32_t>(__popcnt64(_uMask));
+#elif defined(__GNUC__) || defined(__clang__)
+                return static_cast<uint32_t>(__builtin_popcountll(_uMask));
+#else
+                return BitsPopCount(static_cast<uint32_t>(_uMask)) + BitsPopCount(static_cast<uint32_t>(_uMask >> 32));
+#endif
+            }
+
+            /// <summary>
+            /// 统计 _pBits 中所有被设置的位数。
+            /// </summary>
+            /// <param name="_pBits">位数组</param>
+            /// <param name="_cBlocks">_pBits 的元素个数</param>
+            /// <returns>被设置的位数</returns>
+            inline
+            size_t
+            __YYAPI
+            BitsPopCount(
+                _In_reads_(_cBlocks) const uintptr_t* _pBits,
+                _In_ size_t _cBlocks) noexcept
+            {
+                size_t _uCount = 0;
+                size_t _uIndex = 0;
+#if defined(YY_BITMAP_USE_NEON)
+                // NEON 提供逐字节的 vcntq_u8，一次处理 16字节。
+                constexpr size_t kStep = sizeof(uint8x16_t) / sizeof(uintptr_t);
+                for (; _uIndex + kStep <= _cBlocks; _uIndex += kStep)
+                {
+                    _uCount += vaddvq_u8(vcntq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(_pBits + _uIndex))));
+                }
+#endif
+                // x86 没有向量化的 popcnt（AVX512 除外），逐块使用 popcnt 指令已经足够快。
+                for (; _uIndex != _cBlocks; ++_uIndex)
+                {
+                    _uCount += BitsPopCount(_pBits[_uIndex]);
+                }
+                return _uCount;
+            }
+
+            struct BitsAndOperator
+            {
+                static constexpr uintptr_t __YYAPI Apply(uintptr_t _uLeft, uintptr_t _uRight) noexcept
+                {
+                    return _uLeft & _uRight;
+                }
+
+#if defined(YY_BITMAP_USE_AVX2)
+                static __m256i __YYAPI Apply(__m256i _Left, __m256i _Right) noexcept
+                {
+                    return _mm256_and_si256(_Left, _Right);
+                }
+#elif defined(YY_BITMAP_USE_SSE2)
+                static __m128i __YYAPI Apply(__m128i _Left, __m128i _Right) noexcept
+                {
+                    return _mm_and_si128(_Left, _Right);
+                }
+#elif defined(YY_BITMAP_USE_NEON)
+                static uint8x16_t __YYAPI Apply(uint8x16_t _Left, uint8x16_t _Right) noexcept
+                {
+                    return vandq_u8(_Left, _Right);
+                }
+#endif
+            };
+
+            struct BitsOrOperator
+            {
+                static constexpr uintptr_t __YYAPI Apply(uintptr_t _uLeft, uintptr_t _uRight) noexcept
+                {
+                    return _uLeft | _uRight;
+                }
+
+#if defined(YY_BITMAP_USE_AVX2)
+                static __m256i __YYAPI Apply(__m256i _Left, __m256i _Right) noexcept
+                {
+                    return _mm256_or_si256(_Left, _Right);
+                }
+#elif defined(YY_BITMAP_USE_SSE2)
+                static __m128i __YYAPI Apply(__m128i _Left, __m128i _Right) noexcept
+                {
+                    return _mm_or_si128(_Left, _Right);
+                }
+#elif defined(YY_BITMAP_USE_NEON)
+                static uint8x16_t __YYAPI Apply(uint8x16_t _Left, uint8x16_t _Right) noexcept
+                {
+                    return vorrq_u8(_Left, _Right);
+                }
+#endif
+            };
+
+            struct BitsXorOperator
+            {
+                static constexpr uintptr_t __YYAPI Apply(uintptr_t _uLeft, uintptr_t _uRight) noexcept
+                {
+                    return _uLeft ^ _uRight;
+                }
+
+#if defined(YY_BITMAP_USE_AVX2)
+                static __m256i __YYAPI Apply(__m256i _Left, __m256i _Right) noexcept
+                {
+                    return _mm256_xor_si256(_Left, _Right);
+                }
+#elif defined(YY_BITMAP_USE_SSE2)
+                static __m128i __YYAPI Apply(__m128i _Left, __m128i _Right) noexcept
+                {
+                    return _mm_xor_si128(_Left, _Right);
+                }
+#elif defined(YY_BITMAP_USE_NEON)
+                static uint8x16_t __YYAPI Apply(uint8x16_t _Left, uint8x16_t _Right) noexcept
+                {
+                    return veorq_u8(_Left, _Right);
+                }
+#endif
+            };
+
+            /// <summary>
+            /// 对两个位数组逐块运算，结果写回 _pDst。非原子操作。
+            /// </summary>
+            /// <typeparam name="_Operator">BitsAndOperator、BitsOrOperator 或者 BitsXorOperator</typeparam>
+            template<typename _Operator>
+            inline
+            void
+            __YYAPI
+            BitsOperate(
+                _Inout_ uintptr_t* _pDst,
+                _In_reads_(_cBlocks) const uintptr_t* _pSrc,
+                _In_ size_t _cBlocks) noexcept
+            {
+                size_t _uIndex = 0;
+#if defined(YY_BITMAP_USE_AVX2)
+                constexpr size_t kStep = sizeof(__m256i) / sizeof(uintptr_t);
+                for (; _uIndex + kStep <= _cBlocks; _uIndex += kStep)
+                {
+                    auto _Left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pDst + _uIndex));
+                    auto _Right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pSrc + _uIndex));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(_pDst + _uIndex), _Operator::Apply(_Left, _Right));
+                }
+#elif defined(YY_BITMAP_USE_SSE2)
+                constexpr size_t kStep = sizeof(__m128i) / sizeof(uintptr_t);
+                for (; _uIndex + kStep <= _cBlocks; _uIndex += kStep)
+                {
+                    auto _Left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pDst + _uIndex));
+                    auto _Right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pSrc + _uIndex));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(_pDst + _uIndex), _Operator::Apply(_Left, _Right));
+                }
+#elif defined(YY_BITMAP_USE_NEON)
+                constexpr size_t kStep = sizeof(uint8x16_t) / sizeof(uintptr_t);
+                for (; _uIndex + kStep <= _cBlocks; _uIndex += kStep)
+                {
+                    auto _Left = vld1q_u8(reinterpret_cast<const uint8_t*>(_pDst + _uIndex));
+                    auto _Right = vld1q_u8(reinterpret_cast<const uint8_t*>(_pSrc + _uIndex));
+                    vst1q_u8(reinterpret_cast<uint8_t*>(_pDst + _uIndex), _Operator::Apply(_Left, _Right));
+                }
 #endif
+                for (; _uIndex != _cBlocks; ++_uIndex)
+                {
+                    _pDst[_uIndex] = _Operator::Apply(_pDst[_uIndex], _pSrc[_uIndex]);
+                }
+            }
+
+            inline void __YYAPI BitsAnd(_Inout_ uintptr_t* _pDst, _In_reads_(_cBlocks) const uintptr_t* _pSrc, _In_ size_t _cBlocks) noexcept
+            {
+                BitsOperate<BitsAndOperator>(_pDst, _pSrc, _cBlocks);
             }
 
-            template<uint32_t uBits>
+            inline void __YYAPI BitsOr(_Inout_ uintptr_t* _pDst, _In_reads_(_cBlocks) const uintptr_t* _pSrc, _In_ size_t _cBlocks) noexcept
+            {
+                BitsOperate<BitsOrOperator>(_pDst, _pSrc, _cBlocks);
+            }
+
+            inline void __YYAPI BitsXor(_Inout_ uintptr_t* _pDst, _In_reads_(_cBlocks) const uintptr_t* _pSrc, _In_ size_t _cBlocks) noexcept
+            {
+                BitsOperate<BitsXorOperator>(_pDst, _pSrc, _cBlocks);
+            }
+
+            /// <summary>
+            /// 从 _uBitIndex 开始查找第一个未设置的位。
+            /// </summary>
+            /// <param name="_pBits">位数组</param>
+            /// <param name="_cBlocks">_pBits 的元素个数</param>
+            /// <param name="_uBitIndex">开始搜索的位置</param>
+            /// <returns>未设置的位索引，如果全部被设置则返回 -1。注意：返回值可能超出调用者实际使用的位数，需要调用者自行判断。</returns>
+            inline
+            int32_t
+            __YYAPI
+            BitsFindZero(
+                _In_reads_(_cBlocks) const uintptr_t* _pBits,
+                _In_ size_t _cBlocks,
+                _In_ size_t _uBitIndex) noexcept
+            {
+                size_t _uBlockIndex = _uBitIndex / YY_bitsizeof(uintptr_t);
+                if (_uBlockIndex >= _cBlocks)
+                    return -1;
+
+                uintptr_t _uMask = ~_pBits[_uBlockIndex];
+                auto _nIndex = BitFind(&_uMask, static_cast<uint32_t>(_uBitIndex % YY_bitsizeof(uintptr_t)));
+                if (_nIndex >= 0)
+                    return static_cast<int32_t>(_nIndex + _uBlockIndex * YY_bitsizeof(uintptr_t));
+
+                ++_uBlockIndex;
+
+                // 向量化跳过全部被设置的块
+#if defined(YY_BITMAP_USE_AVX2)
+                constexpr size_t kStep = sizeof(__m256i) / sizeof(uintptr_t);
+                const auto _AllBits = _mm256_set1_epi32(-1);
+                for (; _uBlockIndex + kStep <= _cBlocks; _uBlockIndex += kStep)
+                {
+                    auto _Value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_pBits + _uBlockIndex));
+                    if (!_mm256_testc_si256(_Value, _AllBits))
+                        break;
+                }
+#elif defined(YY_BITMAP_USE_SSE2)
+                constexpr size_t kStep = sizeof(__m128i) / sizeof(uintptr_t);
+                const auto _AllBits = _mm_set1_epi32(-1);
+                for (; _uBlockIndex + kStep <= _cBlocks; _uBlockIndex += kStep)
+                {
+                    auto _Value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pBits + _uBlockIndex));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_Value, _AllBits)) != 0xFFFF)
+                        break;
+                }
+#elif defined(YY_BITMAP_USE_NEON)
+                constexpr size_t kStep = sizeof(uint8x16_t) / sizeof(uintptr_t);
+                for (; _uBlockIndex + kStep <= _cBlocks; _uBlockIndex += kStep)
+                {
+                    if (vminvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(_pBits + _uBlockIndex))) != 0xFFu)
+                        break;
+                }
+#endif
+                for (; _uBlockIndex < _cBlocks; ++_uBlockIndex)
+                {
+                    _uMask = ~_pBits[_uBlockIndex];
+                    _nIndex = BitFind(&_uMask, 0);
+                    if (_nIndex >= 0)
+                        return static_cast<int32_t>(_nIndex + _uBlockIndex * YY_bitsizeof(uintptr_t));
+                }
+
+                return -1;
+            }
+
+            /// <summary>
+            /// 固定大小的位图。
+            /// </summary>
+            /// <typeparam name="uBits">位数</typeparam>
+            /// <typeparam name="bAtomic">是否使用原子操作修改位图。仅在单一所有者（比如同一个线程）访问时可以设置为 false 以减少原子操作开销。</typeparam>
+            template<uint32_t uBits, bool bAtomic = true>
             class BitMap
             {
                 friend UnitTest::BitMapUnitTest;
 
             protected:
-                uintptr_t arrBits[(uBits + YY_bitsizeof(uintptr_t) - 1) / YY_bitsizeof(uintptr_t)];
+                static constexpr size_t kBlockCount = (uBits + YY_bitsizeof(uintptr_t) - 1) / YY_bitsizeof(uintptr_t);
+
+                uintptr_t arrBits[kBlockCount];
                 uint32_t uCount;
 
             public:
@@ -167,6 +458,19 @@ namespace YY
                 {
                     assert(uBits > _uBitIndex);
 
+                    if YY_CPP17_IF_CONSTEXPR (!bAtomic)
+                    {
+                        auto& _uBlock = arrBits[_uBitIndex / YY_bitsizeof(uintptr_t)];
+                        const auto _uMask = uintptr_t(1) << (_uBitIndex % YY_bitsizeof(uintptr_t));
+                        const bool _bRet = (_uBlock & _uMask) != 0;
+                        if (_bRet != _bValue)
+                        {
+                            _uBlock ^= _uMask;
+                            _bValue ? ++uCount : --uCount;
+                        }
+                        return _bRet;
+                    }
+
                     if (_bValue)
                     {
                         const auto _bRet = Sync::BitSet(arrBits, _uBitIndex);
@@ -211,7 +515,7 @@ namespace YY
                     if (_uIndex >= 0)
                         return static_cast<int32_t>(_uIndex + _uBolckIndex * YY_bitsizeof(uintptr_t));
 
-                    for (++_uBolckIndex; _uBolckIndex < std::size(arrBits); ++_uBolckIndex)
+                    for (++_uBolckIndex; _uBolckIndex < kBlockCount; ++_uBolckIndex)
                     {
                         _uIndex = BitFind(&arrBits[_uBolckIndex], 0);
                         if (_uIndex >= 0)
@@ -222,6 +526,319 @@ namespace YY
 
                     return -1;
                 }
+
+                /// <summary>
+                /// 从 _uBitIndex 开始查找第一个未设置的位。
+                /// </summary>
+                /// <returns>未设置的位索引，如果全部被设置则返回 -1。</returns>
+                int32_t __YYAPI FindZero(_In_range_(< , uBits) uint32_t _uBitIndex) const noexcept
+                {
+                    const auto _nIndex = BitsFindZero(arrBits, kBlockCount, _uBitIndex);
+                    return _nIndex >= 0 && uint32_t(_nIndex) < uBits ? _nIndex : -1;
+                }
+
+                void __YYAPI And(_In_ const BitMap& _oOther) noexcept
+                {
+                    static_assert(!bAtomic, "批量运算不是原子的，请使用 BitMap<uBits, false>。");
+                    BitsAnd(arrBits, _oOther.arrBits, kBlockCount);
+                    uCount = static_cast<uint32_t>(BitsPopCount(arrBits, kBlockCount));
+                }
+
+                void __YYAPI Or(_In_ const BitMap& _oOther) noexcept
+                {
+                    static_assert(!bAtomic, "批量运算不是原子的，请使用 BitMap<uBits, false>。");
+                    BitsOr(arrBits, _oOther.arrBits, kBlockCount);
+                    uCount = static_cast<uint32_t>(BitsPopCount(arrBits, kBlockCount));
+                }
+
+                void __YYAPI Xor(_In_ const BitMap& _oOther) noexcept
+                {
+                    static_assert(!bAtomic, "批量运算不是原子的，请使用 BitMap<uBits, false>。");
+                    BitsXor(arrBits, _oOther.arrBits, kBlockCount);
+                    uCount = static_cast<uint32_t>(BitsPopCount(arrBits, kBlockCount));
+                }
+            };
+
+            /// <summary>
+            /// 可变大小的位图，仅供单一所有者使用（非原子操作）。
+            /// 额外维护一层摘要位图：摘要的第 N 位表示第 N 个块是否存在被设置的位，
+            /// 因此 Find 每次可以跳过 YY_bitsizeof(uintptr_t)² 个位。
+            /// </summary>
+            class DynamicBitMap
+            {
+                friend UnitTest::BitMapUnitTest;
+
+            protected:
+                static constexpr size_t kBlockBits = YY_bitsizeof(uintptr_t);
+
+                // 位数据，之后紧跟着摘要位图，两者共享一次内存分配
+                uintptr_t* pBits;
+                uintptr_t* pSummary;
+                uint32_t uBitCount;
+                uint32_t uCount;
+
+            public:
+                DynamicBitMap() noexcept
+                    : pBits(nullptr)
+                    , pSummary(nullptr)
+                    , uBitCount(0u)
+                    , uCount(0u)
+                {
+                }
+
+                DynamicBitMap(const DynamicBitMap&) = delete;
+
+                DynamicBitMap(DynamicBitMap&& _oOther) noexcept
+                    : pBits(_oOther.pBits)
+                    , pSummary(_oOther.pSummary)
+                    , uBitCount(_oOther.uBitCount)
+                    , uCount(_oOther.uCount)
+                {
+                    _oOther.pBits = nullptr;
+                    _oOther.pSummary = nullptr;
+                    _oOther.uBitCount = 0u;
+                    _oOther.uCount = 0u;
+                }
+
+                ~DynamicBitMap()
+                {
+                    Memory::Free(pBits);
+                }
+
+                DynamicBitMap& __YYAPI operator=(const DynamicBitMap&) = delete;
+
+                DynamicBitMap& __YYAPI operator=(DynamicBitMap&& _oOther) noexcept
+                {
+                    if (this != &_oOther)
+                    {
+                        Memory::Free(pBits);
+                        pBits = _oOther.pBits;
+                        pSummary = _oOther.pSummary;
+                        uBitCount = _oOther.uBitCount;
+                        uCount = _oOther.uCount;
+
+                        _oOther.pBits = nullptr;
+                        _oOther.pSummary = nullptr;
+                        _oOther.uBitCount = 0u;
+                        _oOther.uCount = 0u;
+                    }
+                    return *this;
+                }
+
+                /// <summary>
+                /// 调整位图容量，保留 [0, min(旧容量, _uBitCount)) 范围内的位。
+                /// </summary>
+                /// <param name="_uBitCount">新的位数，必须小于 INT32_MAX</param>
+                /// <returns></returns>
+                HRESULT __YYAPI Resize(_In_ uint32_t _uBitCount) noexcept
+                {
+                    if (_uBitCount > uint32_t(INT32_MAX))
+                        return E_INVALIDARG;
+
+                    if (_uBitCount == uBitCount)
+                        return S_OK;
+
+                    if (_uBitCount == 0u)
+                    {
+                        Memory::Free(pBits);
+                        pBits = nullptr;
+                        pSummary = nullptr;
+                        uBitCount = 0u;
+                        uCount = 0u;
+                        return S_OK;
+                    }
+
+                    const size_t _cNewBlocks = GetBlockCount(_uBitCount);
+                    const size_t _cNewSummaryBlocks = GetBlockCount(_cNewBlocks);
+                    auto _pNewBits = (uintptr_t*)Memory::AllocAndZero((_cNewBlocks + _cNewSummaryBlocks) * sizeof(uintptr_t));
+                    if (!_pNewBits)
+                        return E_OUTOFMEMORY;
+
+                    const size_t _cBlocks = GetBlockCount(uBitCount);
+                    if (_cBlocks)
+                    {
+                        memcpy(_pNewBits, pBits, (std::min)(_cBlocks, _cNewBlocks) * sizeof(uintptr_t));
+                    }
+
+                    Memory::Free(pBits);
+                    pBits = _pNewBits;
+                    pSummary = _pNewBits + _cNewBlocks;
+                    uBitCount = _uBitCount;
+                    RebuildSummary();
+                    return S_OK;
+                }
+
+                uint32_t __YYAPI GetBitCount() const noexcept
+                {
+                    return uBitCount;
+                }
+
+                uint32_t __YYAPI GetSize() const noexcept
+                {
+                    return uCount;
+                }
+
+                bool __YYAPI IsEmpty() const noexcept
+                {
+                    return uCount == 0u;
+                }
+
+                bool __YYAPI SetItem(_In_ uint32_t _uBitIndex, _In_ bool _bValue) noexcept
+                {
+                    assert(uBitCount > _uBitIndex);
+
+                    const size_t _uBlockIndex = _uBitIndex / kBlockBits;
+                    auto& _uBlock = pBits[_uBlockIndex];
+                    const auto _uMask = uintptr_t(1) << (_uBitIndex % kBlockBits);
+                    const bool _bRet = (_uBlock & _uMask) != 0;
+                    if (_bRet == _bValue)
+                        return _bRet;
+
+                    const bool _bBlockEmpty = _uBlock == 0u;
+                    _uBlock ^= _uMask;
+                    if (_bValue)
+                    {
+                        ++uCount;
+                        if (_bBlockEmpty)
+                            pSummary[_uBlockIndex / kBlockBits] |= uintptr_t(1) << (_uBlockIndex % kBlockBits);
+                    }
+                    else
+                    {
+                        --uCount;
+                        if (_uBlock == 0u)
+                            pSummary[_uBlockIndex / kBlockBits] &= ~(uintptr_t(1) << (_uBlockIndex % kBlockBits));
+                    }
+                    return _bRet;
+                }
+
+                bool __YYAPI GetItem(_In_ uint32_t _uBitIndex) const noexcept
+                {
+                    assert(uBitCount > _uBitIndex);
+
+                    return (pBits[_uBitIndex / kBlockBits] >> (_uBitIndex % kBlockBits)) & 1u;
+                }
+
+                bool __YYAPI operator[](_In_ uint32_t _uBitIndex) const noexcept
+                {
+                    return GetItem(_uBitIndex);
+                }
+
+                /// <summary>
+                /// 从 _uBitIndex 开始查找第一个被设置的位。
+                /// </summary>
+                /// <returns>被设置的位索引，如果不存在则返回 -1。</returns>
+                int32_t __YYAPI Find(_In_ uint32_t _uBitIndex) const noexcept
+                {
+                    if (uBitCount <= _uBitIndex)
+                        return -1;
+
+                    size_t _uBlockIndex = _uBitIndex / kBlockBits;
+                    auto _nIndex = BitFind(&pBits[_uBlockIndex], static_cast<uint32_t>(_uBitIndex % kBlockBits));
+                    if (_nIndex >= 0)
+                        return static_cast<int32_t>(_nIndex + _uBlockIndex * kBlockBits);
+
+                    // 当前块没有找到，通过摘要定位下一个非空块
+                    ++_uBlockIndex;
+                    const size_t _cSummaryBlocks = GetBlockCount(GetBlockCount(uBitCount));
+                    for (size_t _uSummaryIndex = _uBlockIndex / kBlockBits; _uSummaryIndex < _cSummaryBlocks; ++_uSummaryIndex)
+                    {
+                        const auto _uStart = _uSummaryIndex == _uBlockIndex / kBlockBits ? static_cast<uint32_t>(_uBlockIndex % kBlockBits) : 0u;
+                        _nIndex = BitFind(&pSummary[_uSummaryIndex], _uStart);
+                        if (_nIndex >= 0)
+                        {
+                            const size_t _uFound = _uSummaryIndex * kBlockBits + _nIndex;
+                            return static_cast<int32_t>(_uFound * kBlockBits + BitFind(&pBits[_uFound], 0));
+                        }
+                    }
+
+                    return -1;
+                }
+
+                /// <summary>
+                /// 从 _uBitIndex 开始查找第一个未设置的位。
+                /// </summary>
+                /// <returns>未设置的位索引，如果全部被设置则返回 -1。</returns>
+                int32_t __YYAPI FindZero(_In_ uint32_t _uBitIndex) const noexcept
+                {
+                    if (uBitCount <= _uBitIndex)
+                        return -1;
+
+                    const auto _nIndex = BitsFindZero(pBits, GetBlockCount(uBitCount), _uBitIndex);
+                    return _nIndex >= 0 && uint32_t(_nIndex) < uBitCount ? _nIndex : -1;
+                }
+
+                void __YYAPI Clear() noexcept
+                {
+                    if (pBits)
+                    {
+                        const size_t _cBlocks = GetBlockCount(uBitCount);
+                        memset(pBits, 0, (_cBlocks + GetBlockCount(_cBlocks)) * sizeof(uintptr_t));
+                    }
+                    uCount = 0u;
+                }
+
+                /// <summary>
+                /// 与 _oOther 做与运算，超出 _oOther 容量的位将被清除。
+                /// </summary>
+                void __YYAPI And(_In_ const DynamicBitMap& _oOther) noexcept
+                {
+                    const size_t _cBlocks = GetBlockCount(uBitCount);
+                    const size_t _cOtherBlocks = GetBlockCount(_oOther.uBitCount);
+                    if (_cBlocks > _cOtherBlocks)
+                    {
+                        memset(pBits + _cOtherBlocks, 0, (_cBlocks - _cOtherBlocks) * sizeof(uintptr_t));
+                    }
+                    BitsAnd(pBits, _oOther.pBits, (std::min)(_cBlocks, _cOtherBlocks));
+                    RebuildSummary();
+                }
+
+                /// <summary>
+                /// 与 _oOther 做或运算，超出自身容量的位将被忽略。
+                /// </summary>
+                void __YYAPI Or(_In_ const DynamicBitMap& _oOther) noexcept
+                {
+                    BitsOr(pBits, _oOther.pBits, (std::min)(GetBlockCount(uBitCount), GetBlockCount(_oOther.uBitCount)));
+                    RebuildSummary();
+                }
+
+                /// <summary>
+                /// 与 _oOther 做异或运算，超出自身容量的位将被忽略。
+                /// </summary>
+                void __YYAPI Xor(_In_ const DynamicBitMap& _oOther) noexcept
+                {
+                    BitsXor(pBits, _oOther.pBits, (std::min)(GetBlockCount(uBitCount), GetBlockCount(_oOther.uBitCount)));
+                    RebuildSummary();
+                }
+
+            private:
+                static constexpr size_t __YYAPI GetBlockCount(size_t _uBitCount) noexcept
+                {
+                    return (_uBitCount + kBlockBits - 1) / kBlockBits;
+                }
+
+                void __YYAPI RebuildSummary() noexcept
+                {
+                    const size_t _cBlocks = GetBlockCount(uBitCount);
+                    if (_cBlocks == 0)
+                    {
+                        uCount = 0u;
+                        return;
+                    }
+
+                    // 清除尾部超出容量的位
+                    if (uBitCount % kBlockBits)
+                    {
+                        pBits[_cBlocks - 1] &= (uintptr_t(1) << (uBitCount % kBlockBits)) - 1;
+                    }
+
+                    memset(pSummary, 0, GetBlockCount(_cBlocks) * sizeof(uintptr_t));
+                    for (size_t _uBlockIndex = 0; _uBlockIndex != _cBlocks; ++_uBlockIndex)
+                    {
+                        if (pBits[_uBlockIndex])
+                            pSummary[_uBlockIndex / kBlockBits] |= uintptr_t(1) << (_uBlockIndex % kBlockBits);
+                    }
+                    uCount = static_cast<uint32_t>(BitsPopCount(pBits, _cBlocks));
+                }
             };
         }
     }
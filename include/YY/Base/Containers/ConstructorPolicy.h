@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include <string.h>
+#include <type_traits>
 #include <YY/Base/YY.h>
 
 namespace YY
@@ -8,6 +9,22 @@ namespace YY
     {
         namespace Containers
         {
+            /// <summary>
+            /// 判断类型是否可以平凡重定位：允许直接使用 memcpy/memmove/realloc 搬移对象，搬移后原位置不再调用析构函数。
+            /// 平凡可复制的类型总是可平凡重定位的，其他类型可以声明成员类型 `using TriviallyRelocatable = std::true_type;` 加入。
+            /// 注意：派生类会继承该声明，如果派生类额外持有自引用的成员，需要重新声明为 std::false_type。
+            /// </summary>
+            template<typename _Type, typename = void>
+            struct IsTriviallyRelocatable : public std::integral_constant<bool, std::is_trivially_copyable<_Type>::value>
+            {
+            };
+
+            template<typename _Type>
+            struct IsTriviallyRelocatable<_Type, typename std::conditional<true, void, typename _Type::TriviallyRelocatable>::type>
+                : public std::integral_constant<bool, std::is_trivially_copyable<_Type>::value || _Type::TriviallyRelocatable::value>
+            {
+            };
+
             template<typename _Type>
             struct ConstructorPolicy
             {
@@ -87,6 +104,28 @@ namespace YY
                     Destructor(_pItems, _pItems + _uCount);
                 }
 
+                /// <summary>
+                /// 将 [_pFirst, _pLast) 搬移到未初始化的 _pDst，完成后源区域视为未初始化。
+                /// 可平凡重定位的类型允许区域重叠，否则区域不能重叠。
+                /// </summary>
+                static void Relocate(_Type* _pDst, _Type* _pFirst, _Type* _pLast)
+                {
+                    if YY_CPP17_IF_CONSTEXPR (IsTriviallyRelocatable<_Type>::value)
+                    {
+                        memmove((void*)_pDst, (const void*)_pFirst, (_pLast - _pFirst) * sizeof(*_pFirst));
+                    }
+                    else
+                    {
+                        MoveConstructor(_pDst, _pFirst, _pLast);
+                        Destructor(_pFirst, _pLast);
+                    }
+                }
+
+                static void Relocate(_Type* _pDst, _Type* _pSrc, size_t _uCount)
+                {
+                    Relocate(_pDst, _pSrc, _pSrc + _uCount);
+                }
+
                 static void Copy(_Type* _pDst, const _Type* _pFirst, const _Type* _pLast)
                 {
                     if YY_CPP17_IF_CONSTEXPR (std::is_trivially_copyable<_Type>::value)
@@ -119,7 +158,7 @@ namespace YY
                         {
                             // 完全一样，复制啥？？？
                         }
-                        else if (_pFirst > _pDst && _pDst < _pLast)
+                        else if (_pDst > _pFirst && _pDst < _pLast)
                         {
                             // 区域层叠，我们进行颠倒移动。
                             auto _pDstLast = _pDst + (_pLast - _pFirst);
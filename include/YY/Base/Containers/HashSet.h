@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <YY/Base/YY.h>
+#include <YY/Base/Memory/Alloc.h>
 
 #pragma pack(push, __YY_PACKING)
 
@@ -37,7 +38,7 @@ namespace YY
                         {
                             auto _pTmp = _pItem;
                             _pItem = _pItem->pNext;
-                            free(_pTmp);
+                            Free(_pTmp);
                         }
                     }
                 }
@@ -100,7 +101,7 @@ namespace YY
                                 pBuckets[_uIndex] = _pNext;
                             }
 
-                            free(_pEntry);
+                            Free(_pEntry);
 
                             return S_OK;
                         }
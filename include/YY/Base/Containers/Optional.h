@@ -18,7 +18,7 @@ namespace YY
             private:
                 union
                 {
-                    char oValueBuffer[sizeof(_Type)];
+                    alignas(_Type) char oValueBuffer[sizeof(_Type)];
                 };
 
                 bool bHasValue = false;
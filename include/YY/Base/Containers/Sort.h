@@ -0,0 +1,552 @@
+﻿#pragma once
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/ErrorCode.h>
+#include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Containers/Span.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Containers
+        {
+            /// <summary>
+            /// 是否可以对 _Type 使用排序网络：32/64 位整数并且使用默认的 std::less 比较。
+            /// 排序网络只包含无分支的 min/max，编译器可以使用 cmov 或者 SIMD 指令生成代码。
+            /// </summary>
+            template<typename _Type, typename Less>
+            struct IsSortingNetworkEligible
+                : std::integral_constant<
+                    bool,
+                    std::is_integral<_Type>::value && (sizeof(_Type) == 4 || sizeof(_Type) == 8)
+                        && (std::is_same<Less, std::less<_Type>>::value || std::is_same<Less, std::less<void>>::value)>
+            {
+            };
+
+            /// <summary>
+            /// Sort/StableSort/PartialSort 的内部实现。
+            ///
+            /// Sort 使用 pattern-defeating quicksort（Orson Peters）：
+            /// * 小区间使用插入排序（符合条件的整数使用排序网络）；
+            /// * 大区间使用 ninther 选择基准，已经有序的区间通过部分插入排序提前结束；
+            /// * 划分严重失衡时打乱元素以破坏恶意模式，失衡次数过多时退化为堆排序，保证最坏 O(n log n)。
+            /// </summary>
+            template<typename _Type, typename Less>
+            class SortHelper
+            {
+            public:
+                static constexpr size_t kInsertionSortThreshold = 24;
+                static constexpr size_t kNintherThreshold = 128;
+                static constexpr size_t kPartialInsertionSortLimit = 8;
+                static constexpr size_t kSortingNetworkSize = 16;
+                static constexpr size_t kStableInsertionSortThreshold = 32;
+
+                static void __YYAPI Sort(_Inout_updates_(_pEnd - _pBegin) _Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    const size_t _cItems = _pEnd - _pBegin;
+                    if (_cItems < 2)
+                        return;
+
+                    int _cBadAllowed = 0;
+                    for (size_t _cRemaining = _cItems; _cRemaining >>= 1;)
+                    {
+                        ++_cBadAllowed;
+                    }
+
+                    QuickSortLoop(_pBegin, _pEnd, _pfnLess, _cBadAllowed, true);
+                }
+
+                static void __YYAPI InsertionSort(_Inout_updates_(_pEnd - _pBegin) _Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    if (_pBegin == _pEnd)
+                        return;
+
+                    for (auto _pCurrent = _pBegin + 1; _pCurrent != _pEnd; ++_pCurrent)
+                    {
+                        if (!_pfnLess(*_pCurrent, *(_pCurrent - 1)))
+                            continue;
+
+                        _Type _oTemp = std::move(*_pCurrent);
+                        auto _pSift = _pCurrent;
+                        do
+                        {
+                            *_pSift = std::move(*(_pSift - 1));
+                            --_pSift;
+                        } while (_pSift != _pBegin && _pfnLess(_oTemp, *(_pSift - 1)));
+
+                        *_pSift = std::move(_oTemp);
+                    }
+                }
+
+                /// <summary>
+                /// 稳定的归并排序，_pBuffer 至少能容纳 (_pEnd - _pBegin + 1) / 2 个元素（未构造的内存）。
+                /// </summary>
+                static void __YYAPI MergeSort(_Inout_updates_(_pEnd - _pBegin) _Type* _pBegin, _Type* _pEnd, _Type* _pBuffer, Less& _pfnLess)
+                {
+                    const size_t _cItems = _pEnd - _pBegin;
+                    if (_cItems <= kStableInsertionSortThreshold)
+                    {
+                        InsertionSort(_pBegin, _pEnd, _pfnLess);
+                        return;
+                    }
+
+                    auto _pMiddle = _pBegin + _cItems / 2;
+                    MergeSort(_pBegin, _pMiddle, _pBuffer, _pfnLess);
+                    MergeSort(_pMiddle, _pEnd, _pBuffer, _pfnLess);
+
+                    // 两半已经整体有序
+                    if (!_pfnLess(*_pMiddle, *(_pMiddle - 1)))
+                        return;
+
+                    auto _pBufferEnd = _pBuffer;
+                    for (auto _pItem = _pBegin; _pItem != _pMiddle; ++_pItem, ++_pBufferEnd)
+                    {
+                        new (_pBufferEnd) _Type(std::move(*_pItem));
+                    }
+
+                    auto _pOut = _pBegin;
+                    auto _pLeft = _pBuffer;
+                    auto _pRight = _pMiddle;
+                    while (_pLeft != _pBufferEnd && _pRight != _pEnd)
+                    {
+                        // 相等时优先取左侧，保证稳定
+                        if (_pfnLess(*_pRight, *_pLeft))
+                            *_pOut++ = std::move(*_pRight++);
+                        else
+                            *_pOut++ = std::move(*_pLeft++);
+                    }
+
+                    while (_pLeft != _pBufferEnd)
+                    {
+                        *_pOut++ = std::move(*_pLeft++);
+                    }
+
+                    for (auto _pItem = _pBuffer; _pItem != _pBufferEnd; ++_pItem)
+                    {
+                        _pItem->~_Type();
+                    }
+                }
+
+            private:
+                static void __YYAPI UnguardedInsertionSort(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    // 调用者保证 *(_pBegin - 1) 不大于区间内任何元素，因此不需要检查左边界
+                    for (auto _pCurrent = _pBegin + 1; _pCurrent < _pEnd; ++_pCurrent)
+                    {
+                        if (!_pfnLess(*_pCurrent, *(_pCurrent - 1)))
+                            continue;
+
+                        _Type _oTemp = std::move(*_pCurrent);
+                        auto _pSift = _pCurrent;
+                        do
+                        {
+                            *_pSift = std::move(*(_pSift - 1));
+                            --_pSift;
+                        } while (_pfnLess(_oTemp, *(_pSift - 1)));
+
+                        *_pSift = std::move(_oTemp);
+                    }
+                }
+
+                /// <summary>
+                /// 插入排序，但移动次数超过 kPartialInsertionSortLimit 时放弃并返回 false。
+                /// </summary>
+                static bool __YYAPI PartialInsertionSort(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    if (_pBegin == _pEnd)
+                        return true;
+
+                    size_t _cMoves = 0;
+                    for (auto _pCurrent = _pBegin + 1; _pCurrent != _pEnd; ++_pCurrent)
+                    {
+                        if (!_pfnLess(*_pCurrent, *(_pCurrent - 1)))
+                            continue;
+
+                        _Type _oTemp = std::move(*_pCurrent);
+                        auto _pSift = _pCurrent;
+                        do
+                        {
+                            *_pSift = std::move(*(_pSift - 1));
+                            --_pSift;
+                        } while (_pSift != _pBegin && _pfnLess(_oTemp, *(_pSift - 1)));
+
+                        *_pSift = std::move(_oTemp);
+                        _cMoves += _pCurrent - _pSift;
+                        if (_cMoves > kPartialInsertionSortLimit)
+                            return false;
+                    }
+
+                    return true;
+                }
+
+                static void __YYAPI SmallSort(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess, bool _bLeftmost, std::true_type)
+                {
+                    if (size_t(_pEnd - _pBegin) <= kSortingNetworkSize)
+                    {
+                        SortingNetwork(_pBegin, _pEnd);
+                        return;
+                    }
+
+                    SmallSort(_pBegin, _pEnd, _pfnLess, _bLeftmost, std::false_type());
+                }
+
+                static void __YYAPI SmallSort(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess, bool _bLeftmost, std::false_type)
+                {
+                    if (_bLeftmost)
+                        InsertionSort(_pBegin, _pEnd, _pfnLess);
+                    else
+                        UnguardedInsertionSort(_pBegin, _pEnd, _pfnLess);
+                }
+
+                /// <summary>
+                /// 16 个元素的双调排序网络，不足的位置使用最大值填充。
+                /// 循环边界都是常量，展开后只剩下无分支的 min/max。
+                /// </summary>
+                static void __YYAPI SortingNetwork(_Type* _pBegin, _Type* _pEnd)
+                {
+                    _Type _arrKeys[kSortingNetworkSize];
+                    const size_t _cItems = _pEnd - _pBegin;
+                    for (size_t _uIndex = 0; _uIndex != kSortingNetworkSize; ++_uIndex)
+                    {
+                        _arrKeys[_uIndex] = _uIndex < _cItems ? _pBegin[_uIndex] : (std::numeric_limits<_Type>::max)();
+                    }
+
+                    for (size_t _uBlock = 2; _uBlock <= kSortingNetworkSize; _uBlock <<= 1)
+                    {
+                        for (size_t _uDistance = _uBlock >> 1; _uDistance; _uDistance >>= 1)
+                        {
+                            for (size_t _uIndex = 0; _uIndex != kSortingNetworkSize; ++_uIndex)
+                            {
+                                const size_t _uPartner = _uIndex ^ _uDistance;
+                                if (_uPartner <= _uIndex)
+                                    continue;
+
+                                const _Type _oLeft = _arrKeys[_uIndex];
+                                const _Type _oRight = _arrKeys[_uPartner];
+                                const _Type _oMin = _oRight < _oLeft ? _oRight : _oLeft;
+                                const _Type _oMax = _oRight < _oLeft ? _oLeft : _oRight;
+                                if ((_uIndex & _uBlock) == 0)
+                                {
+                                    _arrKeys[_uIndex] = _oMin;
+                                    _arrKeys[_uPartner] = _oMax;
+                                }
+                                else
+                                {
+                                    _arrKeys[_uIndex] = _oMax;
+                                    _arrKeys[_uPartner] = _oMin;
+                                }
+                            }
+                        }
+                    }
+
+                    for (size_t _uIndex = 0; _uIndex != _cItems; ++_uIndex)
+                    {
+                        _pBegin[_uIndex] = _arrKeys[_uIndex];
+                    }
+                }
+
+                static void __YYAPI Sort2(_Type* _pA, _Type* _pB, Less& _pfnLess)
+                {
+                    if (_pfnLess(*_pB, *_pA))
+                        std::iter_swap(_pA, _pB);
+                }
+
+                static void __YYAPI Sort3(_Type* _pA, _Type* _pB, _Type* _pC, Less& _pfnLess)
+                {
+                    Sort2(_pA, _pB, _pfnLess);
+                    Sort2(_pB, _pC, _pfnLess);
+                    Sort2(_pA, _pB, _pfnLess);
+                }
+
+                /// <summary>
+                /// 以 *_pBegin 为基准划分，等于基准的元素放在右侧。
+                /// </summary>
+                /// <returns>基准的最终位置，以及划分前区间是否已经划分好。</returns>
+                static std::pair<_Type*, bool> __YYAPI PartitionRight(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    _Type _oPivot = std::move(*_pBegin);
+                    auto _pFirst = _pBegin;
+                    auto _pLast = _pEnd;
+
+                    // 中位数选择保证右侧存在不小于基准的元素，因此不需要检查边界
+                    while (_pfnLess(*++_pFirst, _oPivot))
+                    {
+                    }
+
+                    if (_pFirst - 1 == _pBegin)
+                    {
+                        while (_pFirst < _pLast && !_pfnLess(*--_pLast, _oPivot))
+                        {
+                        }
+                    }
+                    else
+                    {
+                        while (!_pfnLess(*--_pLast, _oPivot))
+                        {
+                        }
+                    }
+
+                    const bool _bAlreadyPartitioned = _pFirst >= _pLast;
+                    while (_pFirst < _pLast)
+                    {
+                        std::iter_swap(_pFirst, _pLast);
+                        while (_pfnLess(*++_pFirst, _oPivot))
+                        {
+                        }
+                        while (!_pfnLess(*--_pLast, _oPivot))
+                        {
+                        }
+                    }
+
+                    auto _pPivot = _pFirst - 1;
+                    *_pBegin = std::move(*_pPivot);
+                    *_pPivot = std::move(_oPivot);
+                    return std::pair<_Type*, bool>(_pPivot, _bAlreadyPartitioned);
+                }
+
+                /// <summary>
+                /// 以 *_pBegin 为基准划分，等于基准的元素放在左侧。用于大量重复元素的区间。
+                /// </summary>
+                static _Type* __YYAPI PartitionLeft(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    _Type _oPivot = std::move(*_pBegin);
+                    auto _pFirst = _pBegin;
+                    auto _pLast = _pEnd;
+
+                    while (_pfnLess(_oPivot, *--_pLast))
+                    {
+                    }
+
+                    if (_pLast + 1 == _pEnd)
+                    {
+                        while (_pFirst < _pLast && !_pfnLess(_oPivot, *++_pFirst))
+                        {
+                        }
+                    }
+                    else
+                    {
+                        while (!_pfnLess(_oPivot, *++_pFirst))
+                        {
+                        }
+                    }
+
+                    while (_pFirst < _pLast)
+                    {
+                        std::iter_swap(_pFirst, _pLast);
+                        while (_pfnLess(_oPivot, *--_pLast))
+                        {
+                        }
+                        while (!_pfnLess(_oPivot, *++_pFirst))
+                        {
+                        }
+                    }
+
+                    auto _pPivot = _pLast;
+                    *_pBegin = std::move(*_pPivot);
+                    *_pPivot = std::move(_oPivot);
+                    return _pPivot;
+                }
+
+                static void __YYAPI HeapSort(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess)
+                {
+                    std::make_heap(_pBegin, _pEnd, _pfnLess);
+                    std::sort_heap(_pBegin, _pEnd, _pfnLess);
+                }
+
+                static void __YYAPI BreakPatterns(_Type* _pBegin, _Type* _pEnd, size_t _cItems)
+                {
+                    if (_cItems < kInsertionSortThreshold)
+                        return;
+
+                    std::iter_swap(_pBegin, _pBegin + _cItems / 4);
+                    std::iter_swap(_pEnd - 1, _pEnd - _cItems / 4);
+                    if (_cItems > kNintherThreshold)
+                    {
+                        std::iter_swap(_pBegin + 1, _pBegin + (_cItems / 4 + 1));
+                        std::iter_swap(_pBegin + 2, _pBegin + (_cItems / 4 + 2));
+                        std::iter_swap(_pEnd - 2, _pEnd - (_cItems / 4 + 1));
+                        std::iter_swap(_pEnd - 3, _pEnd - (_cItems / 4 + 2));
+                    }
+                }
+
+                static void __YYAPI QuickSortLoop(_Type* _pBegin, _Type* _pEnd, Less& _pfnLess, int _cBadAllowed, bool _bLeftmost)
+                {
+                    for (;;)
+                    {
+                        const size_t _cItems = _pEnd - _pBegin;
+                        if (_cItems < kInsertionSortThreshold)
+                        {
+                            SmallSort(_pBegin, _pEnd, _pfnLess, _bLeftmost, IsSortingNetworkEligible<_Type, Less>());
+                            return;
+                        }
+
+                        // 基准放到 *_pBegin
+                        const size_t _uHalf = _cItems / 2;
+                        if (_cItems > kNintherThreshold)
+                        {
+                            Sort3(_pBegin, _pBegin + _uHalf, _pEnd - 1, _pfnLess);
+                            Sort3(_pBegin + 1, _pBegin + (_uHalf - 1), _pEnd - 2, _pfnLess);
+                            Sort3(_pBegin + 2, _pBegin + (_uHalf + 1), _pEnd - 3, _pfnLess);
+                            Sort3(_pBegin + (_uHalf - 1), _pBegin + _uHalf, _pBegin + (_uHalf + 1), _pfnLess);
+                            std::iter_swap(_pBegin, _pBegin + _uHalf);
+                        }
+                        else
+                        {
+                            Sort3(_pBegin + _uHalf, _pBegin, _pEnd - 1, _pfnLess);
+                        }
+
+                        // 基准与左侧相邻元素相等，说明区间内有大量重复元素，相等的元素全部放到左侧后不再处理
+                        if (!_bLeftmost && !_pfnLess(*(_pBegin - 1), *_pBegin))
+                        {
+                            _pBegin = PartitionLeft(_pBegin, _pEnd, _pfnLess) + 1;
+                            continue;
+                        }
+
+                        auto _oPartition = PartitionRight(_pBegin, _pEnd, _pfnLess);
+                        auto _pPivot = _oPartition.first;
+                        const size_t _cLeft = _pPivot - _pBegin;
+                        const size_t _cRight = _pEnd - (_pPivot + 1);
+
+                        if (_cLeft < _cItems / 8 || _cRight < _cItems / 8)
+                        {
+                            if (--_cBadAllowed == 0)
+                            {
+                                HeapSort(_pBegin, _pEnd, _pfnLess);
+                                return;
+                            }
+
+                            BreakPatterns(_pBegin, _pPivot, _cLeft);
+                            BreakPatterns(_pPivot + 1, _pEnd, _cRight);
+                        }
+                        else if (_oPartition.second
+                            && PartialInsertionSort(_pBegin, _pPivot, _pfnLess)
+                            && PartialInsertionSort(_pPivot + 1, _pEnd, _pfnLess))
+                        {
+                            return;
+                        }
+
+                        // 递归较小的一侧可以限制栈深度，但 pdqsort 的失衡处理已经保证深度为 O(log n)
+                        QuickSortLoop(_pBegin, _pPivot, _pfnLess, _cBadAllowed, _bLeftmost);
+                        _pBegin = _pPivot + 1;
+                        _bLeftmost = false;
+                    }
+                }
+            };
+
+            /// <summary>
+            /// 原地排序，不稳定。平均与最坏复杂度均为 O(n log n)，不申请内存。
+            /// </summary>
+            template<typename _Type, typename Less = std::less<_Type>>
+            void __YYAPI Sort(_In_ Span<_Type> _oItems, _In_ Less _pfnLess = Less())
+            {
+                SortHelper<_Type, Less>::Sort(_oItems.GetData(), _oItems.GetData() + _oItems.GetSize(), _pfnLess);
+            }
+
+            /// <summary>
+            /// 稳定排序（归并排序），需要申请 n/2 个元素的临时内存。
+            /// </summary>
+            /// <returns>临时内存申请失败时返回 E_OUTOFMEMORY，并且元素保持不变。</returns>
+            template<typename _Type, typename Less = std::less<_Type>>
+            HRESULT __YYAPI StableSort(_In_ Span<_Type> _oItems, _In_ Less _pfnLess = Less())
+            {
+                using Helper = SortHelper<_Type, Less>;
+                auto _pBegin = _oItems.GetData();
+                const size_t _cItems = _oItems.GetSize();
+                if (_cItems <= Helper::kStableInsertionSortThreshold)
+                {
+                    Helper::InsertionSort(_pBegin, _pBegin + _cItems, _pfnLess);
+                    return S_OK;
+                }
+
+                auto _pBuffer = (_Type*)Memory::Alloc(sizeof(_Type) * ((_cItems + 1) / 2));
+                if (!_pBuffer)
+                    return E_OUTOFMEMORY;
+
+                Helper::MergeSort(_pBegin, _pBegin + _cItems, _pBuffer, _pfnLess);
+                Memory::Free(_pBuffer);
+                return S_OK;
+            }
+
+            /// <summary>
+            /// 将最小的 _cSorted 个元素按顺序排列到区间开头，其余元素的顺序不确定。复杂度 O(n log k)。
+            /// </summary>
+            template<typename _Type, typename Less = std::less<_Type>>
+            void __YYAPI PartialSort(_In_ Span<_Type> _oItems, _In_ size_t _cSorted, _In_ Less _pfnLess = Less())
+            {
+                auto _pBegin = _oItems.GetData();
+                auto _pEnd = _pBegin + _oItems.GetSize();
+                if (_cSorted >= _oItems.GetSize())
+                {
+                    SortHelper<_Type, Less>::Sort(_pBegin, _pEnd, _pfnLess);
+                    return;
+                }
+
+                if (_cSorted == 0)
+                    return;
+
+                // 前 _cSorted 个元素组成大顶堆，只保留更小的元素
+                auto _pMiddle = _pBegin + _cSorted;
+                std::make_heap(_pBegin, _pMiddle, _pfnLess);
+                for (auto _pItem = _pMiddle; _pItem != _pEnd; ++_pItem)
+                {
+                    if (_pfnLess(*_pItem, *_pBegin))
+                    {
+                        std::pop_heap(_pBegin, _pMiddle, _pfnLess);
+                        std::iter_swap(_pMiddle - 1, _pItem);
+                        std::push_heap(_pBegin, _pMiddle, _pfnLess);
+                    }
+                }
+
+                std::sort_heap(_pBegin, _pMiddle, _pfnLess);
+            }
+
+            /// <summary>
+            /// 合并两个已经有序的区间，结果写入 _oOutput 开头。相等的元素优先取 _oLeft 中的元素（稳定）。
+            /// </summary>
+            /// <returns>_oOutput 的长度不足时返回 E_BOUNDS。</returns>
+            template<typename _Type, typename Less = std::less<_Type>>
+            HRESULT __YYAPI Merge(_In_ Span<const _Type> _oLeft, _In_ Span<const _Type> _oRight, _Out_ Span<_Type> _oOutput, _In_ Less _pfnLess = Less())
+            {
+                if (_oOutput.GetSize() < _oLeft.GetSize() + _oRight.GetSize())
+                    return E_BOUNDS;
+
+                auto _pLeft = _oLeft.GetData();
+                auto _pLeftEnd = _pLeft + _oLeft.GetSize();
+                auto _pRight = _oRight.GetData();
+                auto _pRightEnd = _pRight + _oRight.GetSize();
+                auto _pOut = _oOutput.GetData();
+
+                while (_pLeft != _pLeftEnd && _pRight != _pRightEnd)
+                {
+                    if (_pfnLess(*_pRight, *_pLeft))
+                        *_pOut++ = *_pRight++;
+                    else
+                        *_pOut++ = *_pLeft++;
+                }
+
+                _pOut = std::copy(_pLeft, _pLeftEnd, _pOut);
+                std::copy(_pRight, _pRightEnd, _pOut);
+                return S_OK;
+            }
+
+            template<typename _Type, typename Less = std::less<_Type>>
+            HRESULT __YYAPI Merge(_In_ Span<_Type> _oLeft, _In_ Span<_Type> _oRight, _Out_ Span<_Type> _oOutput, _In_ Less _pfnLess = Less())
+            {
+                return Merge(Span<const _Type>(_oLeft.GetData(), _oLeft.GetSize()), Span<const _Type>(_oRight.GetData(), _oRight.GetSize()), _oOutput, std::move(_pfnLess));
+            }
+        } // namespace Containers
+    } // namespace Base
+
+    using namespace YY::Base::Containers;
+} // namespace YY
+
+#pragma pack(pop)
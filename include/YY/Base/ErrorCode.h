@@ -33,6 +33,7 @@ namespace YY
         constexpr HRESULT E_PENDING = 5;
         constexpr HRESULT E_ABORT = 5;
         constexpr HRESULT E_NOT_SET = 5;
+        constexpr HRESULT E_NOT_VALID_STATE = 5;
 
         constexpr LSTATUS ERROR_SUCCESS = 0;
         constexpr LSTATUS ERROR_CANCELLED = 5;
@@ -4,6 +4,7 @@
 #include <string.h>
 
 #include <YY/Base/YY.h>
+#include <YY/Base/Memory/AllocConfig.h>
 
 namespace YY
 {
@@ -11,6 +12,27 @@ namespace YY
     {
         namespace Memory
         {
+#if YY_MEMORY_USE_THREAD_CACHE
+            // 以下函数由 Alloc.cpp 实现，转发到 ThreadCacheAllocator。
+
+            _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+            _CRTALLOCATOR
+            void* __YYAPI Alloc(_In_ size_t _cbSize);
+
+            _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+            _CRTALLOCATOR
+            void* __YYAPI AllocAndZero(_In_ size_t _cbSize);
+
+            _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+            _CRTALLOCATOR
+            void* __YYAPI ReAlloc(_Pre_maybenull_ _Post_invalid_ void* _pBlock, _In_ size_t _cbSize);
+
+            _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+            _CRTALLOCATOR
+            void* __YYAPI ReAllocAndZero(_Pre_maybenull_ _Post_invalid_ void* _pBlock, _In_ size_t _cbSize);
+
+            void __YYAPI Free(_Pre_maybenull_ _Post_invalid_ void* _pBlock);
+#else
             _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
             _CRTALLOCATOR
             inline void* Alloc(_In_ size_t _cbSize)
@@ -52,6 +74,7 @@ namespace YY
             {
                 free(_pBlock);
             }
+#endif
 
             template<typename T, typename... Args>
             _Success_(return != NULL) _Check_return_ _Ret_maybenull_
@@ -0,0 +1,11 @@
+﻿#pragma once
+
+/// <summary>
+/// 为 1 时 YY::Memory::Alloc/Free 等函数改由 ThreadCacheAllocator 提供（在 Alloc.cpp 中实现），默认内联转发到 CRT 堆。
+/// 这是 YY.Base 的编译选项，需要在使用 YY.Base 的工程（预处理器定义）中统一设置，所有翻译单元必须看到同一个值。
+/// 开启后，所有通过 Memory::Alloc 申请的内存必须使用 Memory::Free/ReAlloc 处理，不能再直接调用 free/realloc。
+/// ThreadCacheAllocator 按 NUMA 节点区分中心缓存，保持为 0 时 Memory::Alloc 不做任何节点相关的处理。
+/// </summary>
+#ifndef YY_MEMORY_USE_THREAD_CACHE
+#define YY_MEMORY_USE_THREAD_CACHE 0
+#endif
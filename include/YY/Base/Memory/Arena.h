@@ -0,0 +1,322 @@
+﻿#pragma once
+#include <string.h>
+#include <cstddef>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Memory/RefPtr.h>
+
+#pragma pack(push, __YY_PACKING)
+
+/*
+
+Arena 是一个单调（bump）分配器，适合生命周期一致的大量临时内存，比如一次请求内的临时容器。
+
+* 内存按块（Chunk）申请，块内只移动指针，不支持单独释放。
+* Reset 仅将指针回拨到第一个块，已经申请的块会保留下来供后续复用，因此复杂度为 O(1)（超大分配除外）。
+* Arena 本身不是线程安全的，请勿跨线程同时使用。
+
+COW Array 以及 String 可以显式地在 Arena 中创建，此后它们的扩容与写时复制都从同一个 Arena 分配：
+
+```cpp
+Arena _oArena;
+{
+    Array<int> _arrTemp(_oArena);
+    aString _szTemp(_oArena);
+    // ...
+}
+_oArena.Reset();
+```
+
+* 只有显式传入 Arena 的容器才会使用 Arena，其他容器（包括长期存在的成员以及全局变量）始终从堆分配。
+* Arena 中的缓冲区不得逃逸到 Reset 之后（包括通过写时复制共享给其他对象）。
+* 容器 Clear 或者 Detach 后回到空缓冲区，之后的分配重新来自堆。
+
+*/
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Memory
+        {
+            class Arena
+            {
+            private:
+                struct Chunk
+                {
+                    Chunk* pNext;
+                    size_t cbCapacity;
+
+                    _Ret_notnull_ byte_t* __YYAPI GetBegin() noexcept
+                    {
+                        return reinterpret_cast<byte_t*>(this + 1);
+                    }
+
+                    _Ret_notnull_ byte_t* __YYAPI GetEnd() noexcept
+                    {
+                        return GetBegin() + cbCapacity;
+                    }
+                };
+
+                static constexpr size_t kDefaultAlignment = alignof(std::max_align_t);
+                // AllocBlock 在内存前保存所属 Arena 的空间，保持之后的内存依然按 kDefaultAlignment 对齐
+                static constexpr size_t kBlockHeaderSize = sizeof(Arena*) > kDefaultAlignment ? sizeof(Arena*) : kDefaultAlignment;
+
+                // 常规块链表，Reset 后保留以供复用
+                Chunk* pFirstChunk = nullptr;
+                Chunk* pCurrentChunk = nullptr;
+                // 超过 cbChunkSize 的分配独占一个块，Reset 时释放
+                Chunk* pLargeChunk = nullptr;
+                byte_t* pCurrent = nullptr;
+                byte_t* pEnd = nullptr;
+                size_t cbChunkSize;
+
+            public:
+                static constexpr size_t kDefaultChunkSize = 64 * 1024 - sizeof(Chunk) - 64;
+
+                explicit Arena(_In_ size_t _cbChunkSize = kDefaultChunkSize) noexcept
+                    : cbChunkSize(_cbChunkSize ? _cbChunkSize : kDefaultChunkSize)
+                {
+                }
+
+                Arena(const Arena&) = delete;
+                Arena& __YYAPI operator=(const Arena&) = delete;
+
+                ~Arena()
+                {
+                    Reset();
+
+                    for (auto _pChunk = pFirstChunk; _pChunk;)
+                    {
+                        auto _pNext = _pChunk->pNext;
+                        Memory::Free(_pChunk);
+                        _pChunk = _pNext;
+                    }
+                }
+
+                /// <summary>
+                /// 从 Arena 申请内存，内存将在 Reset 或者 Arena 析构时统一回收。
+                /// </summary>
+                /// <param name="_cbSize">申请的字节数</param>
+                /// <param name="_uAlignment">对齐要求，必须为 2 的幂</param>
+                /// <returns>内存不足时返回 nullptr</returns>
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                void* __YYAPI Alloc(_In_ size_t _cbSize, _In_ size_t _uAlignment = kDefaultAlignment) noexcept
+                {
+                    if (_uAlignment < kDefaultAlignment)
+                        _uAlignment = kDefaultAlignment;
+
+                    auto _pBlock = AlignUp(pCurrent, _uAlignment);
+                    if (pCurrent && _pBlock <= pEnd && size_t(pEnd - _pBlock) >= _cbSize)
+                    {
+                        pCurrent = _pBlock + _cbSize;
+                        return _pBlock;
+                    }
+
+                    return AllocSlow(_cbSize, _uAlignment);
+                }
+
+                /// <summary>
+                /// 扩展 Arena 中的内存块。如果它是最后一次分配的块并且当前块剩余空间足够，那么原地扩展；否则申请新的内存并复制内容。
+                /// </summary>
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbNewSize)
+                void* __YYAPI ReAlloc(_In_opt_ void* _pBlock, _In_ size_t _cbOldSize, _In_ size_t _cbNewSize) noexcept
+                {
+                    if (TryExtend(_pBlock, _cbOldSize, _cbNewSize))
+                        return _pBlock;
+
+                    auto _pNewBlock = Alloc(_cbNewSize);
+                    if (_pNewBlock && _pBlock)
+                    {
+                        memcpy(_pNewBlock, _pBlock, _cbOldSize < _cbNewSize ? _cbOldSize : _cbNewSize);
+                    }
+                    return _pNewBlock;
+                }
+
+                /// <summary>
+                /// 尝试原地调整最后一次分配的内存块大小。
+                /// </summary>
+                bool __YYAPI TryExtend(_In_opt_ void* _pBlock, _In_ size_t _cbOldSize, _In_ size_t _cbNewSize) noexcept
+                {
+                    auto _pBlockBegin = reinterpret_cast<byte_t*>(_pBlock);
+                    if (_pBlockBegin == nullptr || _pBlockBegin + _cbOldSize != pCurrent)
+                        return false;
+
+                    if (size_t(pEnd - _pBlockBegin) < _cbNewSize)
+                        return false;
+
+                    pCurrent = _pBlockBegin + _cbNewSize;
+                    return true;
+                }
+
+                /// <summary>
+                /// 回收所有分配，常规块将被保留以供复用。
+                /// </summary>
+                void __YYAPI Reset() noexcept
+                {
+                    for (auto _pChunk = pLargeChunk; _pChunk;)
+                    {
+                        auto _pNext = _pChunk->pNext;
+                        Memory::Free(_pChunk);
+                        _pChunk = _pNext;
+                    }
+                    pLargeChunk = nullptr;
+
+                    pCurrentChunk = pFirstChunk;
+                    if (pCurrentChunk)
+                    {
+                        pCurrent = pCurrentChunk->GetBegin();
+                        pEnd = pCurrentChunk->GetEnd();
+                    }
+                    else
+                    {
+                        pCurrent = nullptr;
+                        pEnd = nullptr;
+                    }
+                }
+
+                /// <summary>
+                /// 在 Arena 中创建 RefValue 派生对象。
+                /// 对象的析构函数依然在引用计数归零时调用，但是内存由 Arena 统一回收，因此对象不得存活到 Reset 之后。
+                /// </summary>
+                template<typename _Type, typename... Args>
+                RefPtr<_Type> __YYAPI Create(Args&&... _args) noexcept
+                {
+                    auto _pObject = reinterpret_cast<_Type*>(Alloc(sizeof(_Type), alignof(_Type)));
+                    if (!_pObject)
+                        return nullptr;
+
+                    new (_pObject) _Type(std::forward<Args>(_args)...);
+                    // 额外持有一个永不释放的弱引用，防止 ReleaseWeak 将内存交给 Free
+                    _pObject->AddWeakRef();
+                    return RefPtr<_Type>::FromPtr(_pObject);
+                }
+
+                /// <summary>
+                /// 供容器使用：从 _pArena 申请内存，_pArena 为 nullptr 时从堆申请。
+                /// 来自 Arena 的内存前面记录了所属的 Arena，容器扩容或者写时复制时可以通过 GetBlockArena 找回它。
+                /// </summary>
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                static void* __YYAPI AllocBlock(_In_opt_ Arena* _pArena, _In_ size_t _cbSize) noexcept
+                {
+                    if (!_pArena)
+                        return Memory::Alloc(_cbSize);
+
+                    if (_cbSize > SIZE_MAX - kBlockHeaderSize)
+                        return nullptr;
+
+                    auto _pHeader = reinterpret_cast<byte_t*>(_pArena->Alloc(kBlockHeaderSize + _cbSize));
+                    if (!_pHeader)
+                        return nullptr;
+
+                    *reinterpret_cast<Arena**>(_pHeader) = _pArena;
+                    return _pHeader + kBlockHeaderSize;
+                }
+
+                /// <summary>
+                /// 供容器使用：返回 AllocBlock 从 Arena 申请的内存所属的 Arena。仅适用于来自 Arena 的内存。
+                /// </summary>
+                static _Ret_notnull_ Arena* __YYAPI GetBlockArena(_In_ const void* _pBlock) noexcept
+                {
+                    return *reinterpret_cast<Arena* const*>(reinterpret_cast<const byte_t*>(_pBlock) - kBlockHeaderSize);
+                }
+
+                /// <summary>
+                /// 供容器使用：重新分配 AllocBlock 返回的内存，新内存与原内存来自同一个 Arena（或者堆）。
+                /// 失败时原内存保持不变。
+                /// </summary>
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbNewSize)
+                static void* __YYAPI ReAllocBlock(_In_ void* _pBlock, _In_opt_ Arena* _pArena, _In_ size_t _cbOldSize, _In_ size_t _cbNewSize) noexcept
+                {
+                    if (!_pArena)
+                        return Memory::ReAlloc(_pBlock, _cbNewSize);
+
+                    if (_cbNewSize <= SIZE_MAX - kBlockHeaderSize
+                        && _pArena->TryExtend(reinterpret_cast<byte_t*>(_pBlock) - kBlockHeaderSize, kBlockHeaderSize + _cbOldSize, kBlockHeaderSize + _cbNewSize))
+                    {
+                        return _pBlock;
+                    }
+
+                    auto _pNewBlock = AllocBlock(_pArena, _cbNewSize);
+                    if (_pNewBlock)
+                    {
+                        memcpy(_pNewBlock, _pBlock, _cbOldSize < _cbNewSize ? _cbOldSize : _cbNewSize);
+                    }
+                    return _pNewBlock;
+                }
+
+                /// <summary>
+                /// 供容器使用：释放 AllocBlock 返回的内存，Arena 内存由 Arena 统一回收，这里什么也不做。
+                /// </summary>
+                static void __YYAPI FreeBlock(_Pre_maybenull_ _Post_invalid_ void* _pBlock, _In_opt_ Arena* _pArena) noexcept
+                {
+                    if (!_pArena)
+                        Memory::Free(_pBlock);
+                }
+
+            private:
+                static byte_t* __YYAPI AlignUp(byte_t* _pAddress, size_t _uAlignment) noexcept
+                {
+                    return reinterpret_cast<byte_t*>((reinterpret_cast<uintptr_t>(_pAddress) + _uAlignment - 1) & ~(_uAlignment - 1));
+                }
+
+                void* __YYAPI AllocSlow(size_t _cbSize, size_t _uAlignment) noexcept
+                {
+                    const auto _cbNeed = _cbSize + _uAlignment;
+                    if (_cbNeed < _cbSize)
+                        return nullptr;
+
+                    if (_cbNeed > cbChunkSize)
+                    {
+                        // 超大分配独占一个块，不影响常规块的使用
+                        auto _pChunk = NewChunk(_cbNeed);
+                        if (!_pChunk)
+                            return nullptr;
+
+                        _pChunk->pNext = pLargeChunk;
+                        pLargeChunk = _pChunk;
+                        return AlignUp(_pChunk->GetBegin(), _uAlignment);
+                    }
+
+                    // 优先复用 Reset 之前申请的块
+                    Chunk* _pChunk = pCurrentChunk ? pCurrentChunk->pNext : pFirstChunk;
+                    if (!_pChunk)
+                    {
+                        _pChunk = NewChunk(cbChunkSize);
+                        if (!_pChunk)
+                            return nullptr;
+
+                        if (pCurrentChunk)
+                            pCurrentChunk->pNext = _pChunk;
+                        else
+                            pFirstChunk = _pChunk;
+                    }
+
+                    pCurrentChunk = _pChunk;
+                    pCurrent = _pChunk->GetBegin();
+                    pEnd = _pChunk->GetEnd();
+
+                    auto _pBlock = AlignUp(pCurrent, _uAlignment);
+                    pCurrent = _pBlock + _cbSize;
+                    return _pBlock;
+                }
+
+                static _Ret_maybenull_ Chunk* __YYAPI NewChunk(size_t _cbCapacity) noexcept
+                {
+                    auto _pChunk = (Chunk*)Memory::Alloc(sizeof(Chunk) + _cbCapacity);
+                    if (!_pChunk)
+                        return nullptr;
+
+                    _pChunk->pNext = nullptr;
+                    _pChunk->cbCapacity = _cbCapacity;
+                    return _pChunk;
+                }
+            };
+        } // namespace Memory
+    } // namespace Base
+
+    using namespace YY::Base::Memory;
+} // namespace YY
+
+#pragma pack(pop)
@@ -0,0 +1,276 @@
+﻿#pragma once
+#include <new>
+#include <utility>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/Sync/Interlocked.h>
+#include <YY/Base/Memory/Alloc.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Memory
+        {
+            /// <summary>
+            /// 对象池中每个内存块前面的头信息，记录内存块最终应该归还到哪个对象池。
+            /// </summary>
+            struct ObjectPoolBlockHeader
+            {
+                void(__YYAPI* pfnRecycle)(_In_ void* _pBlock);
+
+                // 保持对象 16 字节对齐
+                static constexpr size_t kHeaderSize = 16;
+
+                static ObjectPoolBlockHeader* __YYAPI FromBlock(_In_ const void* _pBlock) noexcept
+                {
+                    return (ObjectPoolBlockHeader*)((byte_t*)_pBlock - kHeaderSize);
+                }
+
+                /// <summary>
+                /// 将对象池申请的内存块归还给所属的对象池。
+                /// </summary>
+                static void __YYAPI Recycle(_In_ void* _pBlock) noexcept
+                {
+                    FromBlock(_pBlock)->pfnRecycle(_pBlock);
+                }
+            };
+
+            /// <summary>
+            /// 按类型区分的对象池，只缓存内存，不缓存对象本身。
+            ///
+            /// 每个线程持有两个弹匣（Magazine，最多 kMagazineSize 个空闲块）：申请与释放优先在当前线程的弹匣中完成，不需要任何同步。
+            /// 两个弹匣都满时，将其中一个整体放入全局仓库；都空时，从全局仓库整体取回一个。
+            /// 全局仓库是 kDepotSize 个槽位的无锁数组，仓库已满时多余的内存直接还给堆，因此每种类型缓存的内存是有上限的。
+            /// </summary>
+            template<typename _Type>
+            class ObjectPool
+            {
+            public:
+                static constexpr uint32_t kMagazineSize = 32;
+                static constexpr uint32_t kDepotSize = 16;
+
+            private:
+                struct Magazine
+                {
+                    uint32_t cCount;
+                    void* arrBlocks[kMagazineSize];
+                };
+
+                // 平凡类型，线程退出清理之后依然可以安全访问
+                struct ThreadCache
+                {
+                    Magazine* pLoaded;
+                    Magazine* pPrevious;
+                    bool bCleanupRegistered;
+                    bool bThreadExited;
+                };
+
+                struct ThreadCleanup
+                {
+                    ~ThreadCleanup()
+                    {
+                        auto& _oThreadCache = GetThreadCache();
+                        _oThreadCache.bThreadExited = true;
+
+                        ReturnToDepot(_oThreadCache.pLoaded);
+                        _oThreadCache.pLoaded = nullptr;
+                        ReturnToDepot(_oThreadCache.pPrevious);
+                        _oThreadCache.pPrevious = nullptr;
+                    }
+                };
+
+            public:
+                /// <summary>
+                /// 申请一块可以容纳 _Type 的内存。
+                /// </summary>
+                _Ret_maybenull_ static void* __YYAPI Alloc() noexcept
+                {
+                    auto& _oThreadCache = GetThreadCache();
+                    if (!_oThreadCache.bThreadExited)
+                    {
+                        if (_oThreadCache.pLoaded && _oThreadCache.pLoaded->cCount)
+                        {
+                            return _oThreadCache.pLoaded->arrBlocks[--_oThreadCache.pLoaded->cCount];
+                        }
+
+                        if (_oThreadCache.pPrevious && _oThreadCache.pPrevious->cCount)
+                        {
+                            std::swap(_oThreadCache.pLoaded, _oThreadCache.pPrevious);
+                            return _oThreadCache.pLoaded->arrBlocks[--_oThreadCache.pLoaded->cCount];
+                        }
+
+                        if (auto _pFull = PopDepot())
+                        {
+                            // 此时两个弹匣都是空的，保留一个给后续释放使用
+                            Memory::Free(_oThreadCache.pPrevious);
+                            _oThreadCache.pPrevious = _oThreadCache.pLoaded;
+                            _oThreadCache.pLoaded = _pFull;
+                            RegisterThreadCleanup(_oThreadCache);
+                            return _pFull->arrBlocks[--_pFull->cCount];
+                        }
+                    }
+
+                    auto _pHeader = (ObjectPoolBlockHeader*)Memory::Alloc(ObjectPoolBlockHeader::kHeaderSize + sizeof(_Type));
+                    if (!_pHeader)
+                        return nullptr;
+
+                    _pHeader->pfnRecycle = &ObjectPool::Free;
+                    return (byte_t*)_pHeader + ObjectPoolBlockHeader::kHeaderSize;
+                }
+
+                /// <summary>
+                /// 归还 Alloc 申请的内存块。
+                /// </summary>
+                static void __YYAPI Free(_In_opt_ void* _pBlock) noexcept
+                {
+                    if (!_pBlock)
+                        return;
+
+                    auto& _oThreadCache = GetThreadCache();
+                    if (!_oThreadCache.bThreadExited)
+                    {
+                        if (_oThreadCache.pLoaded && _oThreadCache.pLoaded->cCount < kMagazineSize)
+                        {
+                            _oThreadCache.pLoaded->arrBlocks[_oThreadCache.pLoaded->cCount++] = _pBlock;
+                            return;
+                        }
+
+                        if (_oThreadCache.pPrevious && _oThreadCache.pPrevious->cCount < kMagazineSize)
+                        {
+                            std::swap(_oThreadCache.pLoaded, _oThreadCache.pPrevious);
+                            _oThreadCache.pLoaded->arrBlocks[_oThreadCache.pLoaded->cCount++] = _pBlock;
+                            return;
+                        }
+
+                        // 两个弹匣都已经装满，或者尚未创建
+                        if (auto _pEmpty = (Magazine*)Memory::Alloc(sizeof(Magazine)))
+                        {
+                            _pEmpty->cCount = 0;
+                            ReturnToDepot(_oThreadCache.pPrevious);
+                            _oThreadCache.pPrevious = _oThreadCache.pLoaded;
+                            _oThreadCache.pLoaded = _pEmpty;
+                            RegisterThreadCleanup(_oThreadCache);
+
+                            _pEmpty->arrBlocks[_pEmpty->cCount++] = _pBlock;
+                            return;
+                        }
+                    }
+
+                    Memory::Free(ObjectPoolBlockHeader::FromBlock(_pBlock));
+                }
+
+                template<typename... Args>
+                _Ret_maybenull_ static _Type* __YYAPI New(Args&&... _args)
+                {
+                    auto _pBlock = Alloc();
+                    if (!_pBlock)
+                        return nullptr;
+
+                    return new (_pBlock) _Type(std::forward<Args>(_args)...);
+                }
+
+                static void __YYAPI Delete(_In_opt_ _Type* _pObject) noexcept
+                {
+                    if (_pObject)
+                    {
+                        _pObject->~_Type();
+                        Free(_pObject);
+                    }
+                }
+
+                /// <summary>
+                /// 将全局仓库中缓存的内存全部还给堆。各线程自己持有的弹匣不受影响。
+                /// </summary>
+                static void __YYAPI Trim() noexcept
+                {
+                    while (auto _pMagazine = PopDepot())
+                    {
+                        ReleaseMagazine(_pMagazine);
+                    }
+                }
+
+            private:
+                static ThreadCache& __YYAPI GetThreadCache() noexcept
+                {
+                    static thread_local ThreadCache s_oThreadCache;
+                    return s_oThreadCache;
+                }
+
+                static Magazine** __YYAPI GetDepot() noexcept
+                {
+                    static Magazine* s_arrDepot[kDepotSize];
+                    return s_arrDepot;
+                }
+
+                static void __YYAPI RegisterThreadCleanup(_Inout_ ThreadCache& _oThreadCache) noexcept
+                {
+                    if (_oThreadCache.bCleanupRegistered)
+                        return;
+
+                    _oThreadCache.bCleanupRegistered = true;
+                    static thread_local ThreadCleanup s_oThreadCleanup;
+                    (void)s_oThreadCleanup;
+                }
+
+                static bool __YYAPI PushDepot(_In_ Magazine* _pMagazine) noexcept
+                {
+                    auto _ppDepot = GetDepot();
+                    for (uint32_t _uIndex = 0; _uIndex != kDepotSize; ++_uIndex)
+                    {
+                        if (_ppDepot[_uIndex] == nullptr && Sync::CompareExchangePoint(&_ppDepot[_uIndex], _pMagazine, nullptr) == nullptr)
+                            return true;
+                    }
+
+                    return false;
+                }
+
+                _Ret_maybenull_ static Magazine* __YYAPI PopDepot() noexcept
+                {
+                    auto _ppDepot = GetDepot();
+                    for (uint32_t _uIndex = 0; _uIndex != kDepotSize; ++_uIndex)
+                    {
+                        if (_ppDepot[_uIndex] == nullptr)
+                            continue;
+
+                        if (auto _pMagazine = Sync::ExchangePoint(&_ppDepot[_uIndex], nullptr))
+                            return _pMagazine;
+                    }
+
+                    return nullptr;
+                }
+
+                static void __YYAPI ReleaseMagazine(_In_ Magazine* _pMagazine) noexcept
+                {
+                    for (uint32_t _uIndex = 0; _uIndex != _pMagazine->cCount; ++_uIndex)
+                    {
+                        Memory::Free(ObjectPoolBlockHeader::FromBlock(_pMagazine->arrBlocks[_uIndex]));
+                    }
+
+                    Memory::Free(_pMagazine);
+                }
+
+                static void __YYAPI ReturnToDepot(_In_opt_ Magazine* _pMagazine) noexcept
+                {
+                    if (!_pMagazine)
+                        return;
+
+                    if (_pMagazine->cCount == 0)
+                    {
+                        Memory::Free(_pMagazine);
+                    }
+                    else if (!PushDepot(_pMagazine))
+                    {
+                        ReleaseMagazine(_pMagazine);
+                    }
+                }
+            };
+        } // namespace Memory
+    } // namespace Base
+
+    using namespace YY::Base::Memory;
+} // namespace YY
+
+#pragma pack(pop)
@@ -7,15 +7,21 @@ RefPtr 是 类似于shared_ptr的智能指针。他们不同的是 RefPtr 自生
 # RefValue
 提供 AddRef 以及 Release的基础能力包装，如果不满意可自行定义，实现 AddRef 以及 Release即可。
 
+# RefValueST
+与 RefValue 相同，但引用计数不使用原子操作。仅在对象始终停留在一个线程（或者一个 SequencedTaskRunner）时使用。
+
 */
 
 
 #pragma once
+#include <stdlib.h>
 #include <utility>
+#include <type_traits>
 
 #include <YY/Base/YY.h>
 #include <YY/Base/Sync/Interlocked.h>
 #include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Memory/ObjectPool.h>
 
 #pragma pack(push, __YY_PACKING)
 
@@ -25,36 +31,72 @@ namespace YY
     {
         namespace Memory
         {
-            class RefValue
+            template<typename _Type>
+            class RefPtr;
+
+            /// <summary>
+            /// 引用计数的基础实现。
+            /// </summary>
+            /// <typeparam name="bAtomic">
+            /// true：使用原子操作维护引用计数，对象可以在线程之间共享（即 RefValue）。
+            /// false：使用普通的整数运算维护引用计数（即 RefValueST），对象及其所有 RefPtr/WeakPtr 只能在同一个线程或者同一个 SequencedTaskRunner 中使用，
+            ///        但复制 RefPtr、WeakPtr::Get 等操作不再产生任何原子操作。
+            /// </typeparam>
+            template<bool bAtomic>
+            class RefValueImpl
             {
+                template<typename _Type>
+                friend class RefPtr;
+
             private:
-                volatile uint32_t uRef;
-                volatile uint32_t uWeakRef;
+                using CounterType = typename std::conditional<bAtomic, volatile uint32_t, uint32_t>::type;
+
+                // uWeakRef 的最高位，标记对象内存来自 ObjectPool
+                static constexpr uint32_t kPooledWeakRefMark = 0x80000000u;
+
+                CounterType uRef;
+                CounterType uWeakRef;
 
             public:
-                constexpr RefValue()
+                constexpr RefValueImpl()
                     : uRef(1u)
                     , uWeakRef(1u)
                 {
                 }
 
-                virtual ~RefValue() noexcept
+                virtual ~RefValueImpl() noexcept
                 {
                 }
 
                 uint32_t __YYAPI AddRef() const noexcept
                 {
-                    auto _pThis = const_cast<RefValue*>(this);
-                    return Sync::Increment(&_pThis->uRef);
+                    auto _pThis = const_cast<RefValueImpl*>(this);
+                    if YY_CPP17_IF_CONSTEXPR (bAtomic)
+                    {
+                        return Sync::Increment(&_pThis->uRef);
+                    }
+                    else
+                    {
+                        return ++_pThis->uRef;
+                    }
                 }
 
                 uint32_t __YYAPI Release() const noexcept
                 {
-                    auto _pThis = const_cast<RefValue*>(this);
-                    auto _uNewRef = Sync::Decrement(&_pThis->uRef);
+                    auto _pThis = const_cast<RefValueImpl*>(this);
+                    uint32_t _uNewRef;
+                    if YY_CPP17_IF_CONSTEXPR (bAtomic)
+                    {
+                        _uNewRef = Sync::Decrement(&_pThis->uRef);
+                    }
+                    else
+                    {
+                        _uNewRef = --_pThis->uRef;
+                    }
+
                     if (_uNewRef == 0)
                     {
-                        _pThis->~RefValue();
+                        _pThis->~RefValueImpl();
 
                         ReleaseWeak();
                     }
@@ -69,27 +111,58 @@ namespace YY
 
                 uint32_t __YYAPI AddWeakRef() const noexcept
                 {
-                    auto _pThis = const_cast<RefValue*>(this);
-                    return Sync::Increment(&_pThis->uWeakRef);
+                    auto _pThis = const_cast<RefValueImpl*>(this);
+                    if YY_CPP17_IF_CONSTEXPR (bAtomic)
+                    {
+                        return Sync::Increment(&_pThis->uWeakRef) & ~kPooledWeakRefMark;
+                    }
+                    else
+                    {
+                        return ++_pThis->uWeakRef & ~kPooledWeakRefMark;
+                    }
                 }
 
                 uint32_t __YYAPI ReleaseWeak() const noexcept
                 {
-                    auto _pThis = const_cast<RefValue*>(this);
-                    auto _uNewWeakRef = Sync::Decrement(&_pThis->uWeakRef);
+                    auto _pThis = const_cast<RefValueImpl*>(this);
+                    uint32_t _uNewWeakRef;
+                    if YY_CPP17_IF_CONSTEXPR (bAtomic)
+                    {
+                        _uNewWeakRef = Sync::Decrement(&_pThis->uWeakRef);
+                    }
+                    else
+                    {
+                        _uNewWeakRef = --_pThis->uWeakRef;
+                    }
 
-                    if (_uNewWeakRef == 0)
+                    if ((_uNewWeakRef & ~kPooledWeakRefMark) == 0)
                     {
-                        Free(_pThis);
+                        if (_uNewWeakRef & kPooledWeakRefMark)
+                        {
+                            ObjectPoolBlockHeader::Recycle(_pThis);
+                        }
+                        else
+                        {
+                            Free(_pThis);
+                        }
                     }
 
-                    return _uNewWeakRef;
+                    return _uNewWeakRef & ~kPooledWeakRefMark;
                 }
 
                 bool __YYAPI TryAddRef() const noexcept
                 {
-                    auto _pThis = const_cast<RefValue*>(this);
+                    auto _pThis = const_cast<RefValueImpl*>(this);
                     auto _uCurrentRef = uRef;
+                    if YY_CPP17_IF_CONSTEXPR (!bAtomic)
+                    {
+                        if (_uCurrentRef == 0)
+                            return false;
+
+                        _pThis->uRef = _uCurrentRef + 1;
+                        return true;
+                    }
+
                     for (; _uCurrentRef;)
                     {
                         const auto _uLast = Sync::CompareExchange(&_pThis->uRef, _uCurrentRef + 1, _uCurrentRef);
@@ -110,8 +183,21 @@ namespace YY
                 {
                     return uRef == 0;
                 }
+
+            private:
+                void __YYAPI MarkPooled() noexcept
+                {
+                    uWeakRef = uWeakRef | kPooledWeakRefMark;
+                }
             };
 
+            using RefValue = RefValueImpl<true>;
+
+            /// <summary>
+            /// 单线程版本的 RefValue，引用计数不使用原子操作。
+            /// </summary>
+            using RefValueST = RefValueImpl<false>;
+
             template <class T>
             class NoAddRefReleaseOnRefPtr :public T
             {
@@ -136,6 +222,9 @@ namespace YY
                 _Type* p = nullptr;
 
             public:
+                // 仅持有一个指针，可以直接按字节搬移
+                using TriviallyRelocatable = std::true_type;
+
                 constexpr RefPtr() noexcept = default;
 
                 RefPtr(_Type* _pOther) noexcept
@@ -268,6 +357,30 @@ namespace YY
                     return FromPtr(New<_Type>(std::forward<Args>(_args)...));
                 }
 
+                /// <summary>
+                /// 与 Create 相同，但内存来自 ObjectPool&lt;_Type&gt;，对象最终释放时内存归还到对象池而不是堆。
+                /// 适合 Timer 这类频繁创建、销毁的类型。_Type 必须以 RefValue 作为第一个基类（RefValue 子对象位于偏移 0）。
+                /// </summary>
+                template<typename... Args>
+                static RefPtr __YYAPI CreateFromPool(Args&&... _args) noexcept
+                {
+                    static_assert(std::is_base_of<RefValue, _Type>::value || std::is_base_of<RefValueST, _Type>::value, "CreateFromPool requires a RefValue-derived type.");
+
+                    auto _pObject = ObjectPool<_Type>::New(std::forward<Args>(_args)...);
+                    if (_pObject)
+                    {
+                        // ReleaseWeak 只知道 RefValue 子对象的地址，并把它当作内存块的起始地址归还给对象池。
+                        // 多重继承时如果 RefValue 不在偏移 0，归还的地址是错误的，这里直接终止而不是破坏对象池。
+                        // 偏移由类型决定，这个比较在编译时就会被折叠。
+                        if (GetRefValueAddress(_pObject) != static_cast<const void*>(_pObject))
+                            abort();
+
+                        MarkPooled(_pObject);
+                    }
+
+                    return FromPtr(_pObject);
+                }
+
                 /// <summary>
                 /// 从裸指针构建 RefPtr，注意，这里不增加引用计数。
                 /// </summary>
@@ -279,6 +392,27 @@ namespace YY
                     _p.p = _pOther;
                     return _p;
                 }
+
+            private:
+                static const void* __YYAPI GetRefValueAddress(_In_ const RefValue* _pObject) noexcept
+                {
+                    return _pObject;
+                }
+
+                static const void* __YYAPI GetRefValueAddress(_In_ const RefValueST* _pObject) noexcept
+                {
+                    return _pObject;
+                }
+
+                static void __YYAPI MarkPooled(_In_ RefValue* _pObject) noexcept
+                {
+                    _pObject->MarkPooled();
+                }
+
+                static void __YYAPI MarkPooled(_In_ RefValueST* _pObject) noexcept
+                {
+                    _pObject->MarkPooled();
+                }
             };
         }
     }
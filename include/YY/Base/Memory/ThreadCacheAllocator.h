@@ -0,0 +1,121 @@
+﻿#pragma once
+#include <YY/Base/YY.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Memory
+        {
+            /// <summary>
+            /// 带线程缓存的分级内存分配器。
+            ///
+            /// 小于等于 kMaxSmallSize 的申请按尺寸分级，每个线程为每个级别维护一个无锁的空闲链表。
+            /// 线程本地缓存过多时，一次性把 GetBatchCount 个块作为一批交给全局中心缓存；线程本地缓存为空时，也是整批取回。
+            /// 因此“A线程申请、B线程释放”这类生产者/消费者模式只会按批次竞争中心缓存的锁，而不是每次释放都进入全局堆锁。
+            ///
+            /// 更大的申请直接转发到 CRT 堆。
+            /// </summary>
+            class ThreadCacheAllocator
+            {
+            public:
+                static constexpr size_t kSizeClassCount = 20;
+                static constexpr size_t kMaxSmallSize = 1024;
+
+                struct Statistics
+                {
+                    // 申请次数（不含大块内存）
+                    size_t uAllocCount;
+                    // 释放次数（不含大块内存）
+                    size_t uFreeCount;
+                    // 直接由线程本地缓存满足的申请次数
+                    size_t uCacheHitCount;
+                    // 从中心缓存取回的批次数
+                    size_t uCentralFetchCount;
+                    // 归还到中心缓存的批次数
+                    size_t uCentralReleaseCount;
+                    // 中心缓存已满而还给 CRT 堆的批次数
+                    size_t uHeapReleaseCount;
+                    // 超过 kMaxSmallSize，直接转发给 CRT 堆的申请次数
+                    size_t uLargeAllocCount;
+                    // 当前缓存在所有线程以及中心缓存中的空闲字节数
+                    size_t cbCached;
+                    // 按级别统计的申请次数
+                    size_t uAllocCountBySizeClass[kSizeClassCount];
+                };
+
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                static void* __YYAPI Alloc(_In_ size_t _cbSize) noexcept;
+
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                static void* __YYAPI AllocAndZero(_In_ size_t _cbSize) noexcept;
+
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                static void* __YYAPI ReAlloc(_Pre_maybenull_ _Post_invalid_ void* _pBlock, _In_ size_t _cbSize) noexcept;
+
+                /// <summary>
+                /// 与 _recalloc 行为一致，扩大内存块时新增的部分填充为 0。
+                /// </summary>
+                _Success_(return != NULL) _Check_return_ _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                static void* __YYAPI ReAllocAndZero(_Pre_maybenull_ _Post_invalid_ void* _pBlock, _In_ size_t _cbSize) noexcept;
+
+                static void __YYAPI Free(_Pre_maybenull_ _Post_invalid_ void* _pBlock) noexcept;
+
+                /// <summary>
+                /// 获取内存块实际可用的字节数。
+                /// </summary>
+                static size_t __YYAPI GetBlockSize(_In_ const void* _pBlock) noexcept;
+
+                /// <summary>
+                /// 将当前线程缓存的所有空闲块归还到中心缓存。线程退出时会自动调用。
+                /// </summary>
+                static void __YYAPI FlushCurrentThreadCache() noexcept;
+
+                /// <summary>
+                /// 重新读取当前线程所在的 NUMA 节点。节点变化时先把线程缓存归还到原节点的中心缓存，之后改为与新节点的中心缓存交换。
+                /// 线程缓存默认使用线程首次申请内存时所在的节点，而 Windows 系统线程池的线程会在不同节点之间执行任务，
+                /// 因此 ParallelTaskRunner 每次开始执行时都会调用。当前线程还没有使用过分配器时不做任何事情。
+                /// </summary>
+                static void __YYAPI RefreshCurrentThreadNumaNode() noexcept;
+
+                /// <summary>
+                /// 汇总所有线程的统计信息。结果只是近似值，其他线程可能正在修改自己的计数。
+                /// </summary>
+                static void __YYAPI GetStatistics(_Out_ Statistics* _pStatistics) noexcept;
+
+                /// <summary>
+                /// 返回尺寸所属的级别，超过 kMaxSmallSize 时返回 kSizeClassCount。
+                /// 0~128 字节按 16 字节分级，之后每个 2 的幂区间再均分为 4 级。
+                /// </summary>
+                static constexpr size_t __YYAPI GetSizeClass(_In_ size_t _cbSize) noexcept
+                {
+                    return _cbSize <= 128 ? (_cbSize == 0 ? 0 : (_cbSize + 15) / 16 - 1)
+                        : _cbSize <= 256 ? 8 + ((_cbSize - 1) >> 5) - 4
+                        : _cbSize <= 512 ? 12 + ((_cbSize - 1) >> 6) - 4
+                        : _cbSize <= kMaxSmallSize ? 16 + ((_cbSize - 1) >> 7) - 4
+                        : kSizeClassCount;
+                }
+
+                static constexpr size_t __YYAPI GetSizeClassSize(_In_ size_t _uSizeClass) noexcept
+                {
+                    return _uSizeClass < 8 ? (_uSizeClass + 1) * 16
+                        : (size_t(128) << ((_uSizeClass - 8) / 4)) + ((_uSizeClass - 8) % 4 + 1) * (size_t(32) << ((_uSizeClass - 8) / 4));
+                }
+
+                /// <summary>
+                /// 线程缓存与中心缓存之间一次搬移的块数，约 8KB，至少 4 个。
+                /// </summary>
+                static constexpr uint32_t __YYAPI GetBatchCount(_In_ size_t _uSizeClass) noexcept
+                {
+                    return 8 * 1024 / GetSizeClassSize(_uSizeClass) > 32 ? 32
+                        : 8 * 1024 / GetSizeClassSize(_uSizeClass) < 4 ? 4
+                        : uint32_t(8 * 1024 / GetSizeClassSize(_uSizeClass));
+                }
+            };
+        } // namespace Memory
+    } // namespace Base
+} // namespace YY
+
+#pragma pack(pop)
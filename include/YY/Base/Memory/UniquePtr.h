@@ -14,6 +14,8 @@ RefPtr 是 类似于shared_ptr的智能指针。
 */
 
 #pragma once
+#include <type_traits>
+
 #include <YY/Base/YY.h>
 
 #pragma pack(push, __YY_PACKING)
@@ -31,6 +33,9 @@ namespace YY
                 _Type* p = nullptr;
 
             public:
+                // 仅持有一个指针，可以直接按字节搬移
+                using TriviallyRelocatable = std::true_type;
+
                 UniquePtr(const UniquePtr& _pOther) = delete;
                 UniquePtr& __YYAPI operator=(_In_opt_ const UniquePtr& _pOther) = delete;
 
@@ -147,6 +152,9 @@ namespace YY
                 _Type* p = nullptr;
 
             public:
+                // 仅持有一个指针，可以直接按字节搬移
+                using TriviallyRelocatable = std::true_type;
+
                 UniquePtr(const UniquePtr& _pOther) = delete;
                 UniquePtr& __YYAPI operator=(_In_opt_ const UniquePtr& _pOther) = delete;
 
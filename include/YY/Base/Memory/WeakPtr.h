@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <type_traits>
 
 #include <YY/Base/YY.h>
 #include <YY/Base/Sync/Interlocked.h>
@@ -27,6 +28,9 @@ namespace YY
                 _Type* p = nullptr;
 
             public:
+                // 仅持有一个指针，可以直接按字节搬移
+                using TriviallyRelocatable = std::true_type;
+
                 constexpr WeakPtr() noexcept = default;
 
                 WeakPtr(_In_opt_ _Type* _pOther) noexcept
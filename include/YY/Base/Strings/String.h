@@ -24,6 +24,7 @@ LockBuffer 与 UnlockBuffer 必须成对出现。
 #include <stdlib.h>
 #include <algorithm>
 #include <limits>
+#include <type_traits>
 
 #include <YY/Base/Strings/StringView.h>
 #include <YY/Base/Encoding.h>
@@ -32,6 +33,7 @@ LockBuffer 与 UnlockBuffer 必须成对出现。
 #include <YY/Base/ErrorCode.h>
 #include <YY/Base/Sync/Interlocked.h>
 #include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Memory/Arena.h>
 
 #pragma pack(push, __YY_PACKING)
 
@@ -157,6 +159,8 @@ namespace YY
                 using Char = _char_t;
                 using StringView = StringView<char_t, _eEncoding>;
                 using ValueType = _char_t;
+                // 内部只有一个指向 StringData 缓冲区的指针，可以直接按字节搬移
+                using TriviallyRelocatable = std::true_type;
 
             private:
                 constexpr static Encoding eEncoding = _eEncoding;
@@ -172,6 +176,18 @@ namespace YY
                 {
                 }
 
+                /// <summary>
+                /// 创建一个从 _oArena 分配内存的空字符串，之后的扩容与写时复制都从同一个 Arena 分配。
+                /// </summary>
+                explicit StringBase(_In_ Arena& _oArena)
+                {
+                    auto _pStringData = StringData::AllocStringData(0, &_oArena);
+                    if (!_pStringData)
+                        throw Exception(_S("StringBase构造失败。"), E_OUTOFMEMORY);
+
+                    szString = _pStringData->GetStringBuffer();
+                }
+
                 explicit StringBase(_In_reads_opt_(_cchSrc) const char_t* _szSrc, _In_ size_t _cchSrc)
                     : szString(StringData::GetEmtpyStringData()->GetStringBuffer())
                 {
@@ -1062,11 +1078,13 @@ namespace YY
 
                 struct StringData
                 {
+                    // 内存来自 Arena，通过 Arena::GetBlockArena 获取所属的 Arena，释放时不需要 free
+                    static constexpr uint16_t kArenaAllocatedMark = 0x0001u;
+
                     union
                     {
                         struct
                         {
-                            // 暂不使用
                             uint16_t fMarks;
                             uint16_t eEncoding;
                             // 如果 >= 0，那么表示这块内存的引用次数
@@ -1092,7 +1110,7 @@ namespace YY
                         if (_uAllocLength == 0)
                             return GetEmtpyStringData();
 
-                        auto _pNewStringData = AllocStringData(_uAllocLength);
+                        auto _pNewStringData = AllocStringData(_uAllocLength, GetArena());
                         if (!_pNewStringData)
                             return nullptr;
 
@@ -1122,7 +1140,11 @@ namespace YY
 
                         const auto _cbStringDataBuffer = sizeof(StringData) + _uNewCapacity * sizeof(char_t);
 
-                        auto _pNewStringData = (StringData*)ReAlloc(_pOldStringData, _cbStringDataBuffer);
+                        auto _pNewStringData = (StringData*)Arena::ReAllocBlock(
+                            _pOldStringData,
+                            _pOldStringData->GetArena(),
+                            sizeof(StringData) + (_pOldStringData->uCapacity + 1) * sizeof(char_t),
+                            _cbStringDataBuffer);
                         if (!_pNewStringData)
                             return nullptr;
 
@@ -1131,9 +1153,14 @@ namespace YY
                         return _pNewStringData;
                     }
 
-                    static _Ret_maybenull_ StringData* __YYAPI AllocStringData(_In_ uint_t _uAllocLength)
+                    /// <summary>
+                    /// 申请新的 StringData。
+                    /// </summary>
+                    /// <param name="_uAllocLength">期望的容量（字符数，不含结尾的 '\0'）</param>
+                    /// <param name="_pArena">从哪个 Arena 分配，为 nullptr 时从堆分配。长度为 0 时依然会申请内存用于记录 Arena。</param>
+                    static _Ret_maybenull_ StringData* __YYAPI AllocStringData(_In_ uint_t _uAllocLength, _In_opt_ Arena* _pArena = nullptr)
                     {
-                        if (_uAllocLength == 0)
+                        if (_uAllocLength == 0 && _pArena == nullptr)
                             return GetEmtpyStringData();
 
                         ++_uAllocLength;
@@ -1142,11 +1169,11 @@ namespace YY
 
                         const auto _cbNewStringData = sizeof(StringData) + _uAllocLength * sizeof(char_t);
 
-                        auto _pNewStringData = (StringData*)Alloc(_cbNewStringData);
+                        auto _pNewStringData = (StringData*)Arena::AllocBlock(_pArena, _cbNewStringData);
                         if (!_pNewStringData)
                             return nullptr;
 
-                        _pNewStringData->fMarks = 0;
+                        _pNewStringData->fMarks = _pArena ? kArenaAllocatedMark : 0u;
                         _pNewStringData->eEncoding = uint16_t(_eEncoding);
                         _pNewStringData->iRef = 1;
                         _pNewStringData->uCapacity = _uAllocLength - 1;
@@ -1203,14 +1230,14 @@ namespace YY
                         if (iRef < 0)
                         {
                             // 锁定时 隐含 内容引用计数 为 1，所以 Release 后将释放。
-                            free(this);
+                            Arena::FreeBlock(this, GetArena());
                             return 0;
                         }
 
                         const auto uRefNew = Sync::Decrement(&iRef);
                         if (uRefNew == 0)
                         {
-                            free(this);
+                            Arena::FreeBlock(this, GetArena());
                         }
 
                         return (uint32_t)uRefNew;
@@ -1226,6 +1253,19 @@ namespace YY
                         return iRef > 1;
                     }
 
+                    bool __YYAPI IsArenaAllocated() const
+                    {
+                        return (fMarks & kArenaAllocatedMark) != 0;
+                    }
+
+                    /// <summary>
+                    /// 返回内存所属的 Arena，来自堆时返回 nullptr。
+                    /// </summary>
+                    _Ret_maybenull_ Arena* __YYAPI GetArena() const
+                    {
+                        return IsArenaAllocated() ? Arena::GetBlockArena(this) : nullptr;
+                    }
+
                     void __YYAPI Lock()
                     {
                         if (iRef > 1 || iRef == 0)
@@ -0,0 +1,105 @@
+﻿#pragma once
+#include <YY/Base/YY.h>
+#include <YY/Base/Memory/Alloc.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Sync
+        {
+            /// <summary>
+            /// 基于纪元（Epoch）的延迟内存回收，供无锁容器使用。
+            ///
+            /// 读取无锁结构之前调用 Enter（或者使用 EpochGuard），读取结束后调用 Leave。
+            /// 将节点从无锁结构中摘除后，不能立即释放，而是通过 Retire 交给 Epoch。
+            /// 只有当所有在摘除之前进入临界区的线程都已经离开后，才会真正调用释放回调，因此并发的读取者不会访问到已经释放的内存，也不会产生 ABA 问题。
+            ///
+            /// 全局纪元只有在所有处于临界区的线程都观察到当前纪元后才能推进，在纪元 E 中退休的对象会在全局纪元推进到 E + 2 后释放。
+            /// 注意：临界区应当尽可能短，长时间停留在临界区中会阻止所有线程回收内存。
+            /// </summary>
+            class Epoch
+            {
+            public:
+                typedef void(__YYAPI* RetireCallback)(_In_ void* _pObject);
+
+                /// <summary>
+                /// 进入临界区，允许嵌套。
+                /// </summary>
+                static void __YYAPI Enter() noexcept;
+
+                /// <summary>
+                /// 离开临界区，必须与 Enter 配对。
+                /// </summary>
+                static void __YYAPI Leave() noexcept;
+
+                /// <summary>
+                /// 判断当前线程是否处于临界区。
+                /// </summary>
+                static bool __YYAPI IsEntered() noexcept;
+
+                /// <summary>
+                /// 延迟释放一个已经从共享结构中摘除的对象，安全后调用 _pfnRetire(_pObject)。
+                /// 可以在临界区内或者临界区外调用。
+                /// </summary>
+                static void __YYAPI Retire(_In_ void* _pObject, _In_ RetireCallback _pfnRetire) noexcept;
+
+                /// <summary>
+                /// 延迟执行 Memory::Delete。
+                /// </summary>
+                template<typename _Type>
+                static void __YYAPI RetireDelete(_In_ _Type* _pObject) noexcept
+                {
+                    Retire(_pObject, &DeleteObject<_Type>);
+                }
+
+                /// <summary>
+                /// 尝试推进全局纪元，并释放当前线程以及已退出线程中已经安全的对象。
+                /// Retire 会定期自动调用，一般不需要手动调用。
+                /// </summary>
+                static void __YYAPI Collect() noexcept;
+
+                /// <summary>
+                /// 等待当前线程以及已退出线程退休的所有对象全部释放。
+                /// 警告：不能在临界区内调用，否则将死锁；其他线程长时间停留在临界区时，此函数也会一直等待。
+                /// </summary>
+                static void __YYAPI Synchronize() noexcept;
+
+                /// <summary>
+                /// 获取当前的全局纪元，仅用于诊断。
+                /// </summary>
+                static uintptr_t __YYAPI GetGlobalEpoch() noexcept;
+
+            private:
+                template<typename _Type>
+                static void __YYAPI DeleteObject(_In_ void* _pObject) noexcept
+                {
+                    Memory::Delete(static_cast<_Type*>(_pObject));
+                }
+            };
+
+            class EpochGuard
+            {
+            public:
+                EpochGuard() noexcept
+                {
+                    Epoch::Enter();
+                }
+
+                EpochGuard(const EpochGuard&) = delete;
+                EpochGuard& operator=(const EpochGuard&) = delete;
+
+                ~EpochGuard()
+                {
+                    Epoch::Leave();
+                }
+            };
+        } // namespace Sync
+    } // namespace Base
+
+    using namespace YY::Base::Sync;
+} // namespace YY
+
+#pragma pack(pop)
@@ -467,13 +467,20 @@ namespace YY
             /// <returns></returns>
             inline bool __YYAPI CompareExchangeTwoPoints(_Inout_updates_(2) volatile intptr_t* _pDestinationPoints, _In_reads_(2) const intptr_t* _pExchangePoints, _Inout_updates_(2) intptr_t* _pComparandResult)
             {
-#if defined(_X86_) || defined(_ARM_)
+#if defined(_X86_) || defined(_ARM_) || defined(__i386__) || defined(__arm__)
                 static_assert(sizeof(intptr_t) * 2 == sizeof(int64_t), "");
                 auto _iComparand = *reinterpret_cast<int64_t*>(_pComparandResult);
 
                 auto _iPreValue = CompareExchange(reinterpret_cast<volatile int64_t*>(_pDestinationPoints), *reinterpret_cast<const int64_t*>(_pExchangePoints), _iComparand);
                 *reinterpret_cast<int64_t*>(_pComparandResult) = _iPreValue;
                 return _iPreValue == _iComparand;
+#elif !defined(_MSC_VER)
+                static_assert(sizeof(intptr_t) * 2 == sizeof(__int128), "");
+                auto _iComparand = *reinterpret_cast<__int128*>(_pComparandResult);
+
+                auto _iPreValue = __sync_val_compare_and_swap(reinterpret_cast<volatile __int128*>(_pDestinationPoints), _iComparand, *reinterpret_cast<const __int128*>(_pExchangePoints));
+                *reinterpret_cast<__int128*>(_pComparandResult) = _iPreValue;
+                return _iPreValue == _iComparand;
 #else
                 static_assert(sizeof(intptr_t) == sizeof(LONG64), "");
                 return InterlockedCompareExchange128(reinterpret_cast<volatile LONG64*>(_pDestinationPoints), reinterpret_cast<const LONG64*>(_pExchangePoints)[1], reinterpret_cast<const LONG64*>(_pExchangePoints)[0], reinterpret_cast<LONG64*>(_pComparandResult));
@@ -122,6 +122,134 @@ namespace YY
                     return ExchangePoint((Entry**)&pHead, (Entry*)nullptr);
                 }
             };
+
+            /// <summary>
+            /// 多生产者、多消费者的无锁单向链表。
+            /// 链表头同时保存一个版本号，每次修改都会递增，使用双指针宽度的 CAS（CompareExchangeTwoPoints）更新，因此 Pop 不会产生 ABA 问题。
+            /// <para/>注意：Pop 可能读取到刚刚被其他线程弹出的元素的 pNext（随后 CAS 会失败并重试），
+            /// 因此元素被弹出后，其内存不能立即归还给操作系统（例如对象池中的元素、线程信息等常驻对象），或者配合 Sync::Epoch 延迟释放。
+            /// </summary>
+            template<class Entry>
+            class InterlockedSingleLinkedList<Entry, ProducerType::Multi, ConsumerType::Multi>
+            {
+            private:
+                struct Head
+                {
+                    Entry* pFirst;
+                    uintptr_t uTag;
+                };
+
+                // 双指针宽度的 CAS 要求链表头按 sizeof(Head) 对齐，而 __YY_PACKING 会限制成员的对齐，因此预留足够的空间，运行时再对齐。
+                // 一般不应该直接操作此成员
+                uintptr_t arrHeadBuffer[4];
+
+            public:
+                constexpr InterlockedSingleLinkedList()
+                    : arrHeadBuffer {}
+                {
+                }
+
+                ~InterlockedSingleLinkedList()
+                {
+                    for (auto _pEntry = Flush(); _pEntry;)
+                    {
+                        auto _pNext = _pEntry->pNext;
+                        delete _pEntry;
+                        _pEntry = _pNext;
+                    }
+                }
+
+                InterlockedSingleLinkedList(const InterlockedSingleLinkedList&) = delete;
+                InterlockedSingleLinkedList& operator=(const InterlockedSingleLinkedList&) = delete;
+
+                /// <summary>
+                /// 向单向链表插入一段链表。
+                /// <para/>注意：_pEntryBegin -> ... -> _pEntryEnd之间的元素必须首尾相连，不能产生环路，否则将死循环。
+                /// <para/>插入前：Head -> ABC
+                /// <para/>插入后：Head -> _pEntryBegin -> ... -> _pEntryEnd -> ABC
+                /// </summary>
+                void Push(_In_ Entry* _pEntryBegin, _In_ Entry* _pEntryEnd)
+                {
+                    Head _oExpected = LoadHead();
+                    for (;;)
+                    {
+                        _pEntryEnd->pNext = _oExpected.pFirst;
+
+                        const Head _oNewHead = { _pEntryBegin, _oExpected.uTag + 1 };
+                        if (CompareExchangeHead(_oNewHead, &_oExpected))
+                            break;
+                    }
+                }
+
+                void Push(_In_ Entry* _pEntry)
+                {
+                    return Push(_pEntry, _pEntry);
+                }
+
+                /// <summary>
+                /// 从链表弹出一个元素，可以在多个线程中并行调用。
+                /// </summary>
+                /// <returns>返回当前List头部元素，链表为空时返回 nullptr。</returns>
+                _Ret_maybenull_ Entry* Pop()
+                {
+                    Head _oExpected = LoadHead();
+                    for (;;)
+                    {
+                        if (_oExpected.pFirst == nullptr)
+                            return nullptr;
+
+                        // 元素可能已经被其他线程弹出，此时 pNext 的值没有意义，但版本号一定已经改变，CAS 必然失败。
+                        const Head _oNewHead = { static_cast<Entry*>(_oExpected.pFirst->pNext), _oExpected.uTag + 1 };
+                        if (CompareExchangeHead(_oNewHead, &_oExpected))
+                        {
+                            _oExpected.pFirst->pNext = nullptr;
+                            return _oExpected.pFirst;
+                        }
+                    }
+                }
+
+                /// <summary>
+                /// 清空当前列表，并返回之前链表的首个元素。可以与 Pop 并行调用。
+                /// </summary>
+                /// <returns>链表的首个元素地址。</returns>
+                _Ret_maybenull_ Entry* Flush()
+                {
+                    Head _oExpected = LoadHead();
+                    for (;;)
+                    {
+                        if (_oExpected.pFirst == nullptr)
+                            return nullptr;
+
+                        const Head _oNewHead = { nullptr, _oExpected.uTag + 1 };
+                        if (CompareExchangeHead(_oNewHead, &_oExpected))
+                            return _oExpected.pFirst;
+                    }
+                }
+
+            private:
+                Head* GetHead() noexcept
+                {
+                    return reinterpret_cast<Head*>((reinterpret_cast<uintptr_t>(arrHeadBuffer) + sizeof(Head) - 1) & ~uintptr_t(sizeof(Head) - 1));
+                }
+
+                Head LoadHead() noexcept
+                {
+                    // 两个字段不需要一致，不一致时随后的 CAS 会失败并带回最新的值
+                    auto _pHead = GetHead();
+                    Head _oHead;
+                    _oHead.uTag = reinterpret_cast<const volatile uintptr_t&>(_pHead->uTag);
+                    _oHead.pFirst = reinterpret_cast<Entry* const volatile&>(_pHead->pFirst);
+                    return _oHead;
+                }
+
+                bool CompareExchangeHead(_In_ const Head& _oNewHead, _Inout_ Head* _pExpected)
+                {
+                    return CompareExchangeTwoPoints(
+                        reinterpret_cast<volatile intptr_t*>(GetHead()),
+                        reinterpret_cast<const intptr_t*>(&_oNewHead),
+                        reinterpret_cast<intptr_t*>(_pExpected));
+                }
+            };
         }
     }
 }
@@ -30,6 +30,14 @@ namespace YY
                 Error,
             };
 
+            /// <summary>
+            /// 阻塞等待 *_phrResult 不再是 E_PENDING，或者直到达到指定超时时间。
+            /// 无限期等待时，如果当前线程正在执行开启了 SetHelpWhileWaiting 的 ParallelTaskRunner 的任务，那么先帮助执行同一个 ParallelTaskRunner 中排队的任务，
+            /// 没有可执行的任务时才真正阻塞。阻塞时通知线程池当前线程已经阻塞。
+            /// </summary>
+            /// <returns>如果在超时前 *_phrResult 不再是 E_PENDING（或者被唤醒）则返回 true；如果超时则返回 false。</returns>
+            bool __YYAPI WaitForPendingResult(_In_ const volatile HRESULT* _phrResult, _In_ YY::TimeSpan _oTimeout);
+
             class AsyncInfo : public YY::RefValue
             {
             protected:
@@ -141,23 +149,7 @@ namespace YY
                     if (IsCanceled())
                         return false;
 
-                    DWORD _uMilliseconds;
-                    auto _iTimeoutMilliseconds = _oTimeout.GetTotalMilliseconds();
-                    if (_iTimeoutMilliseconds <= 0)
-                    {
-                        _uMilliseconds = 0;
-                    }
-                    else if (_iTimeoutMilliseconds > UINT32_MAX)
-                    {
-                        _uMilliseconds = UINT32_MAX;
-                    }
-                    else
-                    {
-                        _uMilliseconds = (DWORD)_iTimeoutMilliseconds;
-                    }
-
-                    HRESULT _hrPending = E_PENDING;
-                    return WaitOnAddress(&hr, &_hrPending, sizeof(_hrPending), _uMilliseconds);
+                    return WaitForPendingResult(&hr, _oTimeout);
                 }
 
                 void __YYAPI ThrowIfWaitTaskFailed()
@@ -0,0 +1,158 @@
+﻿#pragma once
+#include <YY/Base/YY.h>
+#include <YY/Base/Sync/SRWLock.h>
+#include <YY/Base/Containers/SingleLinkedList.h>
+#include <YY/Base/Threading/Task.h>
+#include <YY/Base/Threading/ValueTask.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// 异步锁的等待者，锁被授予时完成。
+            /// </summary>
+            class AsyncLockWaiter
+                : public AsyncOperationImpl<void>
+                , public SingleLinkedListEntryImpl<AsyncLockWaiter>
+            {
+            public:
+                // 仅 AsyncReaderWriterLock 使用
+                bool bShared = false;
+            };
+
+            /// <summary>
+            /// 可以在协程中 co_await 的信号量，等待期间不会阻塞线程。
+            ///
+            /// 等待者按 FIFO 顺序获得许可，协程在 co_await 时所在的 TaskRunner 中恢复。
+            /// 存在许可时 WaitAsync 返回已完成的 ValueTask，不会申请内存。
+            /// </summary>
+            class AsyncSemaphore
+            {
+            private:
+                // 有等待者时 uCount 一定为 0，因此无锁获取许可不会插队
+                volatile uint32_t uCount;
+                Sync::SRWLock oLock;
+                SingleLinkedList<AsyncLockWaiter> oWaiters;
+
+            public:
+                explicit AsyncSemaphore(uint32_t _uInitialCount) noexcept
+                    : uCount(_uInitialCount)
+                {
+                }
+
+                AsyncSemaphore(const AsyncSemaphore&) = delete;
+                AsyncSemaphore& operator=(const AsyncSemaphore&) = delete;
+
+                /// <summary>
+                /// 取消所有仍在等待的 Task。
+                /// </summary>
+                ~AsyncSemaphore();
+
+                /// <summary>
+                /// 获取一个许可。
+                /// </summary>
+                /// <returns>获得许可后完成的 ValueTask。</returns>
+                ValueTask<void> __YYAPI WaitAsync();
+
+                /// <summary>
+                /// 尝试立即获取一个许可。
+                /// </summary>
+                bool __YYAPI TryWait() noexcept;
+
+                /// <summary>
+                /// 归还许可，优先交给最早的等待者。
+                /// </summary>
+                void __YYAPI Release(uint32_t _uCount = 1);
+            };
+
+            /// <summary>
+            /// 可以在协程中 co_await 的互斥锁，等待期间不会阻塞线程。不支持递归。
+            /// <para/>co_await _oMutex.LockAsync(); ... _oMutex.Unlock();
+            /// </summary>
+            class AsyncMutex
+            {
+            private:
+                AsyncSemaphore oSemaphore;
+
+            public:
+                AsyncMutex() noexcept
+                    : oSemaphore(1)
+                {
+                }
+
+                ValueTask<void> __YYAPI LockAsync()
+                {
+                    return oSemaphore.WaitAsync();
+                }
+
+                bool __YYAPI TryLock() noexcept
+                {
+                    return oSemaphore.TryWait();
+                }
+
+                void __YYAPI Unlock()
+                {
+                    oSemaphore.Release();
+                }
+            };
+
+            /// <summary>
+            /// 可以在协程中 co_await 的读写锁，等待期间不会阻塞线程。
+            ///
+            /// 严格按照 FIFO 顺序授予：存在等待的写入者时，新的读取者也需要排队，因此写入者不会饿死。
+            /// 队首的连续多个读取者会被同时授予。
+            /// </summary>
+            class AsyncReaderWriterLock
+            {
+            private:
+                Sync::SRWLock oLock;
+                // 持有共享锁的个数
+                uint32_t cReaders = 0;
+                bool bWriter = false;
+                SingleLinkedList<AsyncLockWaiter> oWaiters;
+
+            public:
+                AsyncReaderWriterLock() = default;
+
+                AsyncReaderWriterLock(const AsyncReaderWriterLock&) = delete;
+                AsyncReaderWriterLock& operator=(const AsyncReaderWriterLock&) = delete;
+
+                ~AsyncReaderWriterLock();
+
+                ValueTask<void> __YYAPI LockAsync();
+
+                bool __YYAPI TryLock() noexcept;
+
+                void __YYAPI Unlock();
+
+                ValueTask<void> __YYAPI LockSharedAsync();
+
+                bool __YYAPI TryLockShared() noexcept;
+
+                void __YYAPI UnlockShared();
+
+            private:
+                ValueTask<void> __YYAPI AcquireAsync(bool _bShared);
+
+                /// <summary>
+                /// 释放 _cReaders 个共享锁或者独占锁，并将锁授予队首的等待者。
+                /// </summary>
+                void __YYAPI Release(uint32_t _cReaders, bool _bWriter);
+
+                /// <summary>
+                /// 从队首开始授予锁，被授予的等待者移动到 _oReadyWaiters，由调用者在锁外完成。必须在锁内调用。
+                /// </summary>
+                void __YYAPI GrantWaiters(_Inout_ SingleLinkedList<AsyncLockWaiter>& _oReadyWaiters) noexcept;
+            };
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
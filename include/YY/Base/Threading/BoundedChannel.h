@@ -0,0 +1,482 @@
+﻿#pragma once
+#include <new>
+#include <utility>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/Sync/Interlocked.h>
+#include <YY/Base/Sync/SRWLock.h>
+#include <YY/Base/Sync/AutoLock.h>
+#include <YY/Base/Containers/Optional.h>
+#include <YY/Base/Containers/SingleLinkedList.h>
+#include <YY/Base/Threading/Task.h>
+#include <YY/Base/Threading/ValueTask.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// 固定容量的无锁环形缓冲区，用于生产者/消费者流水线。
+            ///
+            /// 与 InterlockedQueue 不同，BoundedChannel 不会扩容：队列已满时 TryPush 直接失败，由调用者决定丢弃或者等待，从而实现背压。
+            /// 每个槽位记录一个序号（Dmitry Vyukov 的有界队列算法），生产者与消费者只在同一个槽位上才会竞争。
+            /// eProducer/eConsumer 为 Single 时，对应一侧使用普通写入代替 CAS。
+            ///
+            /// PushAsync/PopAsync 不需要等待时返回已完成的 ValueTask，不会申请内存；
+            /// 队列已满/为空时才创建等待者，co_await 时挂起协程，
+            /// 另一侧腾出空间/放入元素后直接将元素交给等待者，协程在 co_await 时所在的 TaskRunner 中恢复。
+            /// 注意：Single 一侧在上一次 PushAsync/PopAsync 完成之前，不能再次调用 TryPush/TryPop/PushAsync/PopAsync。
+            /// </summary>
+            template<typename _Type, size_t uCapacity, ProducerType eProducer = ProducerType::Multi, ConsumerType eConsumer = ConsumerType::Multi>
+            class BoundedChannel
+            {
+                static_assert(uCapacity >= 2 && (uCapacity & (uCapacity - 1)) == 0, "BoundedChannel capacity must be a power of 2.");
+
+            private:
+                static constexpr size_t kCacheLineSize = 64;
+                static constexpr size_t kIndexMask = uCapacity - 1;
+
+                struct Slot
+                {
+                    // 等于写入位置时可以写入，等于写入位置 + 1 时可以读取
+                    volatile size_t uSequence;
+                    union
+                    {
+                        alignas(_Type) char oValueBuffer[sizeof(_Type)];
+                    };
+                };
+
+                class PushWaiter
+                    : public AsyncOperationImpl<void>
+                    , public SingleLinkedListEntryImpl<PushWaiter>
+                {
+                public:
+                    _Type oValue;
+
+                    template<typename... Args>
+                    PushWaiter(Args&&... _oArgs)
+                        : oValue(std::forward<Args>(_oArgs)...)
+                    {
+                    }
+
+                    /// <summary>
+                    /// 在写入元素之前占有等待者，占有成功后等待者无法再被取消，随后必须调用 NotifyClaimed。
+                    /// </summary>
+                    /// <returns>等待者已经被取消时返回 false。</returns>
+                    bool __YYAPI TryClaim() noexcept
+                    {
+                        if (this->IsCanceled())
+                        {
+                            this->Cancel();
+                            return false;
+                        }
+
+                        return this->BeginNotifyCompletedHandlers(AsyncStatus::Completed);
+                    }
+
+                    void __YYAPI NotifyClaimed()
+                    {
+                        this->NotifyCompletedHandlers(S_OK);
+                    }
+                };
+
+                class PopWaiter
+                    : public AsyncOperationImpl<_Type>
+                    , public SingleLinkedListEntryImpl<PopWaiter>
+                {
+                public:
+                    Optional<_Type> oValue;
+                };
+
+                // 生产者与消费者各自独占一个缓存行，避免伪共享
+                volatile size_t uHead = 0;
+                byte_t HeadPadding[kCacheLineSize - sizeof(size_t)];
+                volatile size_t uTail = 0;
+                byte_t TailPadding[kCacheLineSize - sizeof(size_t)];
+                Slot arrSlots[uCapacity];
+
+                // 以下成员只在队列已满/为空时使用
+                volatile uint32_t cWaitingProducers = 0;
+                volatile uint32_t cWaitingConsumers = 0;
+                // 已经从队列中取出，但是等待者在完成前被取消的元素，消费者优先读取它们
+                volatile uint32_t cReturnedValues = 0;
+                Sync::SRWLock oWaiterLock;
+                SingleLinkedList<PushWaiter> oPushWaiters;
+                SingleLinkedList<PopWaiter> oPopWaiters;
+                SingleLinkedList<PopWaiter> oReturnedValues;
+
+            public:
+                BoundedChannel() noexcept
+                {
+                    for (size_t _uIndex = 0; _uIndex != uCapacity; ++_uIndex)
+                    {
+                        arrSlots[_uIndex].uSequence = _uIndex;
+                    }
+                }
+
+                BoundedChannel(const BoundedChannel&) = delete;
+                BoundedChannel& operator=(const BoundedChannel&) = delete;
+
+                ~BoundedChannel()
+                {
+                    while (auto _pWaiter = oPushWaiters.Pop())
+                    {
+                        YY::RefPtr<PushWaiter>::FromPtr(_pWaiter)->Cancel();
+                    }
+
+                    while (auto _pWaiter = oPopWaiters.Pop())
+                    {
+                        YY::RefPtr<PopWaiter>::FromPtr(_pWaiter)->Cancel();
+                    }
+
+                    while (auto _pWaiter = oReturnedValues.Pop())
+                    {
+                        _pWaiter->Release();
+                    }
+
+                    while (TryPopCore([](_Type&&) {}))
+                    {
+                    }
+                }
+
+                static constexpr size_t __YYAPI GetCapacity() noexcept
+                {
+                    return uCapacity;
+                }
+
+                /// <summary>
+                /// 尝试写入一个元素，队列已满时立即返回 false，并且 _oValue 保持不变。
+                /// </summary>
+                bool __YYAPI TryPush(const _Type& _oValue)
+                {
+                    if (!TryPushCore(_oValue))
+                        return false;
+
+                    WakeWaiters();
+                    return true;
+                }
+
+                bool __YYAPI TryPush(_Type&& _oValue)
+                {
+                    if (!TryPushCore(std::move(_oValue)))
+                        return false;
+
+                    WakeWaiters();
+                    return true;
+                }
+
+                /// <summary>
+                /// 尝试读取一个元素，队列为空时立即返回 false。
+                /// </summary>
+                bool __YYAPI TryPop(_Out_ _Type* _pValue)
+                {
+                    auto _pfnReceive = [_pValue](_Type&& _oValue)
+                    {
+                        *_pValue = std::move(_oValue);
+                    };
+
+                    if (cReturnedValues)
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oWaiterLock);
+                        if (TryPopReturnedValue(_pfnReceive))
+                            return true;
+                    }
+
+                    if (!TryPopCore(_pfnReceive))
+                        return false;
+
+                    WakeWaiters();
+                    return true;
+                }
+
+                /// <summary>
+                /// 写入一个元素，队列已满时返回的 ValueTask 会一直等待，直到元素被放入队列。
+                /// </summary>
+                ValueTask<void> __YYAPI PushAsync(_Type _oValue)
+                {
+                    if (TryPush(std::move(_oValue)))
+                        return ValueTask<void>();
+
+                    auto _pWaiter = YY::RefPtr<PushWaiter>::CreateFromPool(std::move(_oValue));
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oWaiterLock);
+                        // 先登记再重试，与 WakeWaiters 配合保证不会丢失唤醒
+                        Sync::Increment(&cWaitingProducers);
+                        if (!TryPushCore(std::move(_pWaiter->oValue)))
+                        {
+                            oPushWaiters.Push(YY::RefPtr<PushWaiter>(_pWaiter).Detach());
+                            return Task<void>(std::move(_pWaiter));
+                        }
+
+                        Sync::Decrement(&cWaitingProducers);
+                    }
+
+                    WakeWaiters();
+                    return ValueTask<void>();
+                }
+
+                /// <summary>
+                /// 读取一个元素，队列为空时返回的 ValueTask 会一直等待，直到有新的元素写入。
+                /// </summary>
+                ValueTask<_Type> __YYAPI PopAsync()
+                {
+                    Optional<_Type> _oValue;
+                    auto _pfnReceive = [&_oValue](_Type&& _oNewValue)
+                    {
+                        _oValue.Emplace(std::move(_oNewValue));
+                    };
+
+                    if (cReturnedValues)
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oWaiterLock);
+                        if (TryPopReturnedValue(_pfnReceive))
+                            return ValueTask<_Type>(std::move(_oValue.GetValue()));
+                    }
+
+                    if (!TryPopCore(_pfnReceive))
+                    {
+                        // 在锁外申请等待者
+                        auto _pWaiter = YY::RefPtr<PopWaiter>::CreateFromPool();
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oWaiterLock);
+                        Sync::Increment(&cWaitingConsumers);
+                        if (!TryPopReturnedValue(_pfnReceive) && !TryPopCore(_pfnReceive))
+                        {
+                            oPopWaiters.Push(YY::RefPtr<PopWaiter>(_pWaiter).Detach());
+                            return Task<_Type>(std::move(_pWaiter));
+                        }
+
+                        Sync::Decrement(&cWaitingConsumers);
+                    }
+
+                    WakeWaiters();
+                    return ValueTask<_Type>(std::move(_oValue.GetValue()));
+                }
+
+            private:
+                template<typename... Args>
+                bool __YYAPI TryPushCore(Args&&... _oArgs)
+                {
+                    size_t _uPosition = uTail;
+                    Slot* _pSlot;
+                    for (;;)
+                    {
+                        _pSlot = &arrSlots[_uPosition & kIndexMask];
+                        const intptr_t _iDiff = intptr_t(_pSlot->uSequence) - intptr_t(_uPosition);
+                        if (_iDiff < 0)
+                            return false;
+
+                        if (_iDiff > 0)
+                        {
+                            // 其他生产者已经占用了该位置
+                            _uPosition = uTail;
+                            continue;
+                        }
+
+                        if YY_CPP17_IF_CONSTEXPR (eProducer == ProducerType::Single)
+                        {
+                            uTail = _uPosition + 1;
+                            break;
+                        }
+                        else
+                        {
+                            const auto _uLast = Sync::CompareExchange(&uTail, _uPosition + 1, _uPosition);
+                            if (_uLast == _uPosition)
+                                break;
+
+                            _uPosition = _uLast;
+                        }
+                    }
+
+                    new (_pSlot->oValueBuffer) _Type(std::forward<Args>(_oArgs)...);
+                    // 需要完整的内存屏障，保证随后读取 cWaitingConsumers 发生在发布之后
+                    Sync::Exchange(&_pSlot->uSequence, _uPosition + 1);
+                    return true;
+                }
+
+                template<typename Callback>
+                bool __YYAPI TryPopCore(Callback&& _pfnReceive)
+                {
+                    size_t _uPosition = uHead;
+                    Slot* _pSlot;
+                    for (;;)
+                    {
+                        _pSlot = &arrSlots[_uPosition & kIndexMask];
+                        const intptr_t _iDiff = intptr_t(_pSlot->uSequence) - intptr_t(_uPosition + 1);
+                        if (_iDiff < 0)
+                            return false;
+
+                        if (_iDiff > 0)
+                        {
+                            _uPosition = uHead;
+                            continue;
+                        }
+
+                        if YY_CPP17_IF_CONSTEXPR (eConsumer == ConsumerType::Single)
+                        {
+                            uHead = _uPosition + 1;
+                            break;
+                        }
+                        else
+                        {
+                            const auto _uLast = Sync::CompareExchange(&uHead, _uPosition + 1, _uPosition);
+                            if (_uLast == _uPosition)
+                                break;
+
+                            _uPosition = _uLast;
+                        }
+                    }
+
+                    auto _pValue = reinterpret_cast<_Type*>(_pSlot->oValueBuffer);
+                    _pfnReceive(std::move(*_pValue));
+                    _pValue->~_Type();
+                    Sync::Exchange(&_pSlot->uSequence, _uPosition + uCapacity);
+                    return true;
+                }
+
+                /// <summary>
+                /// 读取一个之前被退回的元素，调用者必须持有 oWaiterLock。
+                /// </summary>
+                template<typename Callback>
+                bool __YYAPI TryPopReturnedValue(Callback&& _pfnReceive)
+                {
+                    auto _pWaiter = oReturnedValues.Pop();
+                    if (!_pWaiter)
+                        return false;
+
+                    Sync::Decrement(&cReturnedValues);
+                    auto _pOwnedWaiter = YY::RefPtr<PopWaiter>::FromPtr(_pWaiter);
+                    _pfnReceive(std::move(_pOwnedWaiter->oValue.GetValue()));
+                    return true;
+                }
+
+                /// <summary>
+                /// 将队列中的元素直接交给等待的消费者，将等待的生产者的元素放入队列。
+                /// 等待者在释放锁以后才完成，避免在锁内恢复协程。
+                ///
+                /// 已经取消的等待者直接丢弃。生产者在写入之前先被占有，因此被取消的写入不会进入队列；
+                /// 消费者在交付元素的瞬间被取消时，元素退回到 oReturnedValues，由下一个消费者读取。
+                /// </summary>
+                void __YYAPI WakeWaiters()
+                {
+                    for (;;)
+                    {
+                        if (cWaitingProducers == 0 && cWaitingConsumers == 0)
+                            return;
+
+                        SingleLinkedList<PushWaiter> _oReadyPushWaiters;
+                        SingleLinkedList<PopWaiter> _oReadyPopWaiters;
+                        SingleLinkedList<PushWaiter> _oFinishedPushWaiters;
+                        SingleLinkedList<PopWaiter> _oCanceledPopWaiters;
+                        // 已经占有但是队列暂时已满的生产者，它留在队首，由后续的 WakeWaiters 写入
+                        YY::RefPtr<PushWaiter> _pClaimedPushWaiter;
+                        {
+                            Sync::AutoLock<Sync::SRWLock> _oLock(oWaiterLock);
+                            for (bool _bProgress = true; _bProgress;)
+                            {
+                                _bProgress = false;
+
+                                while (auto _pWaiter = oPopWaiters.GetFirst())
+                                {
+                                    if (_pWaiter->GetStatus() != AsyncStatus::Started)
+                                    {
+                                        _oCanceledPopWaiters.Push(oPopWaiters.Pop());
+                                    }
+                                    else
+                                    {
+                                        auto _pfnReceive = [_pWaiter](_Type&& _oValue)
+                                        {
+                                            _pWaiter->oValue.Emplace(std::move(_oValue));
+                                        };
+
+                                        if (!TryPopReturnedValue(_pfnReceive) && !TryPopCore(_pfnReceive))
+                                            break;
+
+                                        _oReadyPopWaiters.Push(oPopWaiters.Pop());
+                                        _bProgress = true;
+                                    }
+
+                                    Sync::Decrement(&cWaitingConsumers);
+                                }
+
+                                while (auto _pWaiter = oPushWaiters.GetFirst())
+                                {
+                                    // Completed 表示之前已经占有（并且通知过），只差写入
+                                    auto _eStatus = _pWaiter->GetStatus();
+                                    bool _bClaimed = false;
+                                    if (_eStatus == AsyncStatus::Started)
+                                    {
+                                        _bClaimed = _pWaiter->TryClaim();
+                                        _eStatus = _bClaimed ? AsyncStatus::Completed : _pWaiter->GetStatus();
+                                    }
+
+                                    if (_eStatus == AsyncStatus::Completed)
+                                    {
+                                        if (!TryPushCore(std::move(_pWaiter->oValue)))
+                                        {
+                                            if (_bClaimed)
+                                                _pClaimedPushWaiter = _pWaiter;
+                                            break;
+                                        }
+
+                                        _bProgress = true;
+                                    }
+
+                                    oPushWaiters.Pop();
+                                    if (_bClaimed)
+                                        _oReadyPushWaiters.Push(_pWaiter);
+                                    else
+                                        _oFinishedPushWaiters.Push(_pWaiter);
+
+                                    Sync::Decrement(&cWaitingProducers);
+                                }
+                            }
+                        }
+
+                        if (_pClaimedPushWaiter)
+                            _pClaimedPushWaiter->NotifyClaimed();
+
+                        while (auto _pWaiter = _oReadyPushWaiters.Pop())
+                        {
+                            YY::RefPtr<PushWaiter>::FromPtr(_pWaiter)->NotifyClaimed();
+                        }
+
+                        while (auto _pWaiter = _oFinishedPushWaiters.Pop())
+                        {
+                            _pWaiter->Release();
+                        }
+
+                        while (auto _pWaiter = _oCanceledPopWaiters.Pop())
+                        {
+                            _pWaiter->Release();
+                        }
+
+                        bool _bReturned = false;
+                        while (auto _pWaiter = _oReadyPopWaiters.Pop())
+                        {
+                            auto _pOwnedWaiter = YY::RefPtr<PopWaiter>::FromPtr(_pWaiter);
+                            if (_pOwnedWaiter->Resolve(std::move(_pOwnedWaiter->oValue.GetValue())))
+                                continue;
+
+                            // 交付前被取消，Resolve 失败时元素没有被移走，退回给下一个消费者
+                            Sync::AutoLock<Sync::SRWLock> _oLock(oWaiterLock);
+                            oReturnedValues.Push(_pOwnedWaiter.Detach());
+                            Sync::Increment(&cReturnedValues);
+                            _bReturned = true;
+                        }
+
+                        if (!_bReturned)
+                            return;
+                    }
+                }
+            };
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
@@ -0,0 +1,361 @@
+﻿#pragma once
+#include <utility>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/ErrorCode.h>
+#include <YY/Base/Sync/SRWLock.h>
+#include <YY/Base/Sync/AutoLock.h>
+#include <YY/Base/Memory/ObjectPool.h>
+#include <YY/Base/Containers/Optional.h>
+#include <YY/Base/Containers/SingleLinkedList.h>
+#include <YY/Base/Threading/Task.h>
+#include <YY/Base/Threading/ValueTask.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// 协程之间传递消息的异步通道，支持多个写入者（扇入）以及多个读取者（扇出）。
+            ///
+            /// 有读取者在等待时，WriteAsync 直接将元素交给最早等待的读取者并完成其 Task，
+            /// 读取者的 TaskAwaiter 在回调中恢复协程（已经位于目标 TaskRunner 时不会再投递任务）。
+            /// 已经取消的读取者与写入者会被跳过，元素不会因此丢失，也不会写入已经取消的元素。
+            /// WriteAsync/ReadAsync 不需要等待时返回已完成的 ValueTask，不会申请 AsyncOperation。
+            /// 有界模式下缓冲区已满时 WriteAsync 返回的 Task 会等待，直到有读取者取走元素；无界模式下 WriteAsync 总是立即完成。
+            ///
+            /// Complete 之后不再接受新的写入；缓冲区中的元素以及已经在等待的写入依然可以读取，全部读取后 ReadAsync 返回空的 Optional。
+            /// </summary>
+            template<typename _Type>
+            class Channel
+            {
+            private:
+                struct ItemEntry : public SingleLinkedListEntryImpl<ItemEntry>
+                {
+                    _Type oValue;
+
+                    template<typename... Args>
+                    ItemEntry(Args&&... _oArgs)
+                        : oValue(std::forward<Args>(_oArgs)...)
+                    {
+                    }
+                };
+
+                class WriteWaiter
+                    : public AsyncOperationImpl<void>
+                    , public SingleLinkedListEntryImpl<WriteWaiter>
+                {
+                public:
+                    _Type oValue;
+
+                    WriteWaiter(_Type&& _oValue)
+                        : oValue(std::move(_oValue))
+                    {
+                    }
+
+                    /// <summary>
+                    /// 在取走 oValue 之前锁定完成状态，避免取走已经取消的写入。
+                    /// </summary>
+                    /// <returns>写入已经取消时返回 false。</returns>
+                    bool __YYAPI TryClaim() noexcept
+                    {
+                        if (this->IsCanceled())
+                        {
+                            this->Cancel();
+                            return false;
+                        }
+
+                        return this->BeginNotifyCompletedHandlers(AsyncStatus::Completed);
+                    }
+
+                    void __YYAPI NotifyClaimed()
+                    {
+                        this->NotifyCompletedHandlers(S_OK);
+                    }
+                };
+
+                class ReadWaiter
+                    : public AsyncOperationImpl<Optional<_Type>>
+                    , public SingleLinkedListEntryImpl<ReadWaiter>
+                {
+                };
+
+                Sync::SRWLock oLock;
+                // 0 表示无界
+                uint32_t uCapacity;
+                uint32_t cItems = 0;
+                bool bCompleted = false;
+                SingleLinkedList<ItemEntry> oItems;
+                SingleLinkedList<WriteWaiter> oWriteWaiters;
+                SingleLinkedList<ReadWaiter> oReadWaiters;
+
+            public:
+                /// <summary>
+                /// 创建通道。
+                /// </summary>
+                /// <param name="_uCapacity">缓冲区最多保存的元素个数，0 表示无界。</param>
+                explicit Channel(uint32_t _uCapacity = 0) noexcept
+                    : uCapacity(_uCapacity)
+                {
+                }
+
+                Channel(const Channel&) = delete;
+                Channel& operator=(const Channel&) = delete;
+
+                ~Channel()
+                {
+                    while (auto _pItem = oItems.Pop())
+                    {
+                        ObjectPool<ItemEntry>::Delete(_pItem);
+                    }
+
+                    while (auto _pWaiter = oWriteWaiters.Pop())
+                    {
+                        YY::RefPtr<WriteWaiter>::FromPtr(_pWaiter)->Cancel();
+                    }
+
+                    while (auto _pWaiter = oReadWaiters.Pop())
+                    {
+                        YY::RefPtr<ReadWaiter>::FromPtr(_pWaiter)->Cancel();
+                    }
+                }
+
+                /// <summary>
+                /// 尝试写入一个元素。缓冲区已满或者通道已经 Complete 时返回 false，并且 _oValue 保持不变。
+                /// </summary>
+                bool __YYAPI TryWrite(_Type&& _oValue)
+                {
+                    for (;;)
+                    {
+                        YY::RefPtr<ReadWaiter> _pReader;
+                        {
+                            Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                            if (bCompleted)
+                                return false;
+
+                            if (!oReadWaiters.IsEmpty())
+                            {
+                                _pReader = YY::RefPtr<ReadWaiter>::FromPtr(oReadWaiters.Pop());
+                            }
+                            else if (uCapacity == 0 || cItems < uCapacity)
+                            {
+                                return PushItem(std::move(_oValue));
+                            }
+                            else
+                            {
+                                return false;
+                            }
+                        }
+
+                        // 读取者已经取消时尝试下一个读取者
+                        if (ResolveReader(_pReader, _oValue))
+                            return true;
+                    }
+                }
+
+                bool __YYAPI TryWrite(const _Type& _oValue)
+                {
+                    _Type _oCopy(_oValue);
+                    return TryWrite(std::move(_oCopy));
+                }
+
+                /// <summary>
+                /// 写入一个元素。
+                /// 有界模式下缓冲区已满时，返回的 ValueTask 会等待到元素被放入缓冲区或者直接被读取者取走。
+                /// 通道已经 Complete 时，返回的 ValueTask 失败，错误代码为 E_NOT_VALID_STATE。
+                /// </summary>
+                ValueTask<void> __YYAPI WriteAsync(_Type _oValue)
+                {
+                    for (;;)
+                    {
+                        YY::RefPtr<ReadWaiter> _pReader;
+                        {
+                            Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                            if (bCompleted)
+                                return CreateErrorResult<void>(E_NOT_VALID_STATE);
+
+                            if (!oReadWaiters.IsEmpty())
+                            {
+                                _pReader = YY::RefPtr<ReadWaiter>::FromPtr(oReadWaiters.Pop());
+                            }
+                            else if (uCapacity == 0 || cItems < uCapacity)
+                            {
+                                if (!PushItem(std::move(_oValue)))
+                                    return CreateErrorResult<void>(E_OUTOFMEMORY);
+
+                                return ValueTask<void>();
+                            }
+                            else
+                            {
+                                auto _pWaiter = YY::RefPtr<WriteWaiter>::CreateFromPool(std::move(_oValue));
+                                if (!_pWaiter)
+                                    return CreateErrorResult<void>(E_OUTOFMEMORY);
+
+                                oWriteWaiters.Push(YY::RefPtr<WriteWaiter>(_pWaiter).Detach());
+                                return Task<void>(std::move(_pWaiter));
+                            }
+                        }
+
+                        // 在锁外完成，读取者的协程可能在这里直接恢复；读取者已经取消时尝试下一个读取者
+                        if (ResolveReader(_pReader, _oValue))
+                            return ValueTask<void>();
+                    }
+                }
+
+                /// <summary>
+                /// 尝试读取一个元素，没有可读取的元素时返回 false。
+                /// </summary>
+                bool __YYAPI TryRead(_Out_ _Type* _pValue)
+                {
+                    YY::RefPtr<WriteWaiter> _pWriter;
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                        if (!PopItem([_pValue](_Type&& _oValue) { *_pValue = std::move(_oValue); }, &_pWriter))
+                            return false;
+                    }
+
+                    if (_pWriter)
+                        _pWriter->NotifyClaimed();
+
+                    return true;
+                }
+
+                /// <summary>
+                /// 读取一个元素。没有可读取的元素时，返回的 Task 会等待到有新的元素写入。
+                /// </summary>
+                /// <returns>通道已经 Complete 并且所有元素都已经读取时，返回空的 Optional。</returns>
+                ValueTask<Optional<_Type>> __YYAPI ReadAsync()
+                {
+                    Optional<_Type> _oValue;
+                    YY::RefPtr<WriteWaiter> _pWriter;
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                        if (!PopItem([&_oValue](_Type&& _oItem) { _oValue.Emplace(std::move(_oItem)); }, &_pWriter) && !bCompleted)
+                        {
+                            auto _pWaiter = YY::RefPtr<ReadWaiter>::CreateFromPool();
+                            if (!_pWaiter)
+                                return CreateErrorResult<Optional<_Type>>(E_OUTOFMEMORY);
+
+                            oReadWaiters.Push(YY::RefPtr<ReadWaiter>(_pWaiter).Detach());
+                            return Task<Optional<_Type>>(std::move(_pWaiter));
+                        }
+                    }
+
+                    if (_pWriter)
+                        _pWriter->NotifyClaimed();
+
+                    return ValueTask<Optional<_Type>>(std::move(_oValue));
+                }
+
+                /// <summary>
+                /// 标记通道不再写入。已经读取完毕时，所有等待的读取者立即以空的 Optional 完成。
+                /// </summary>
+                /// <returns>如果通道之前已经 Complete，返回 false。</returns>
+                bool __YYAPI Complete()
+                {
+                    SingleLinkedList<ReadWaiter> _oReadWaiters;
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                        if (bCompleted)
+                            return false;
+
+                        bCompleted = true;
+                        // 有读取者在等待，说明缓冲区为空，也没有等待的写入者
+                        _oReadWaiters.Push(std::move(oReadWaiters));
+                    }
+
+                    while (auto _pWaiter = _oReadWaiters.Pop())
+                    {
+                        YY::RefPtr<ReadWaiter>::FromPtr(_pWaiter)->Resolve(Optional<_Type>());
+                    }
+
+                    return true;
+                }
+
+                bool __YYAPI IsCompleted()
+                {
+                    Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                    return bCompleted;
+                }
+
+            private:
+                template<typename ResultType>
+                static Task<ResultType> __YYAPI CreateErrorResult(HRESULT _hr)
+                {
+                    auto _pAsyncOperation = YY::RefPtr<AsyncOperationImpl<ResultType>>::Create();
+                    if (!_pAsyncOperation)
+                        throw Exception(E_OUTOFMEMORY);
+
+                    _pAsyncOperation->SetErrorCode(_hr);
+                    return Task<ResultType>(std::move(_pAsyncOperation));
+                }
+
+                /// <summary>
+                /// 将元素交给读取者。读取者已经取消时返回 false，并且 _oValue 保持不变。
+                /// </summary>
+                static bool __YYAPI ResolveReader(_In_ ReadWaiter* _pReader, _Inout_ _Type& _oValue)
+                {
+                    Optional<_Type> _oResult(std::move(_oValue));
+                    if (_pReader->Resolve(std::move(_oResult)))
+                        return true;
+
+                    // Resolve 失败时不会取走结果
+                    _oValue = std::move(_oResult.GetValue());
+                    return false;
+                }
+
+                bool __YYAPI PushItem(_Type&& _oValue)
+                {
+                    auto _pItem = ObjectPool<ItemEntry>::New(std::move(_oValue));
+                    if (!_pItem)
+                        return false;
+
+                    oItems.Push(_pItem);
+                    ++cItems;
+                    return true;
+                }
+
+                /// <summary>
+                /// 取出缓冲区中最早的元素，并将最早等待且没有取消的写入者的元素补入缓冲区。必须在锁内调用。
+                /// 返回的写入者已经锁定完成状态，调用者需要在锁外调用 NotifyClaimed。
+                /// </summary>
+                template<typename Callback>
+                bool __YYAPI PopItem(_In_ Callback&& _pfnReceive, _Out_ YY::RefPtr<WriteWaiter>* _ppWriter)
+                {
+                    auto _pItem = oItems.Pop();
+                    if (!_pItem)
+                        return false;
+
+                    _pfnReceive(std::move(_pItem->oValue));
+                    --cItems;
+
+                    while (auto _pWriter = oWriteWaiters.Pop())
+                    {
+                        auto _pClaimedWriter = YY::RefPtr<WriteWaiter>::FromPtr(_pWriter);
+                        if (!_pClaimedWriter->TryClaim())
+                            continue;
+
+                        // 复用刚刚取出的节点
+                        _pItem->oValue = std::move(_pClaimedWriter->oValue);
+                        oItems.Push(_pItem);
+                        ++cItems;
+                        *_ppWriter = std::move(_pClaimedWriter);
+                        return true;
+                    }
+
+                    ObjectPool<ItemEntry>::Delete(_pItem);
+
+                    return true;
+                }
+            };
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <YY/Base/YY.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// 协程帧的线程本地回收器，供 Promise 的 operator new/delete 使用。
+            ///
+            /// 帧按 kGranularity 字节分桶，释放的帧缓存在当前线程对应的桶中（每个桶最多 kMaxCachedFrames 个），
+            /// 之后同一线程创建大小相近的协程时直接复用，不需要访问堆。
+            /// 协程经常在一个线程创建、在另一个线程结束，此时帧缓存到结束协程的线程中。
+            /// 超过 kMaxFrameSize 的帧直接使用 Memory::Alloc。
+            /// </summary>
+            class CoroutineFrameAllocator
+            {
+            public:
+                static constexpr size_t kGranularity = 64;
+                static constexpr size_t kBucketCount = 32;
+                static constexpr size_t kMaxFrameSize = kGranularity * kBucketCount;
+                static constexpr uint32_t kMaxCachedFrames = 16;
+
+                _Ret_maybenull_ _Post_writable_byte_size_(_cbSize)
+                static void* __YYAPI Alloc(_In_ size_t _cbSize) noexcept;
+
+                /// <summary>
+                /// 释放 Alloc 申请的帧，_cbSize 必须与申请时相同（协程的 operator delete 总是提供帧大小）。
+                /// </summary>
+                static void __YYAPI Free(_Pre_maybenull_ _Post_invalid_ void* _pFrame, _In_ size_t _cbSize) noexcept;
+
+                /// <summary>
+                /// 将当前线程缓存的帧全部还给堆。
+                /// </summary>
+                static void __YYAPI FlushCurrentThreadCache() noexcept;
+
+                static constexpr size_t __YYAPI GetBucket(_In_ size_t _cbSize) noexcept
+                {
+                    return _cbSize == 0 ? 0 : (_cbSize - 1) / kGranularity;
+                }
+            };
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
@@ -0,0 +1,88 @@
+﻿#pragma once
+#include <YY/Base/YY.h>
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+#include <coroutine>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// 在当前线程内联恢复协程，避免连续完成的 co_await 链不断加深调用栈。
+            ///
+            /// 最外层的 Resume 负责循环恢复协程。只有协程结束（co_return 或者抛出异常）时触发的 Resume 才会排入当前线程的队列，
+            /// 待结束的协程帧释放后再由最外层依次恢复，因此无论链有多长，栈深度都保持不变。
+            /// 其他情况下（例如协程体内直接调用 Resolve）Resume 作为新的最外层同步恢复协程，与不使用 CoroutineTrampoline 时的语义相同。
+            ///
+            /// 同步阻塞（Task::GetResult、TaskEntry::WaitTask、SendTask 等）以及 RunUIMessageLoop 会自动使用 BlockingScope，
+            /// 先恢复已经排队的协程。
+            /// </summary>
+            class CoroutineTrampoline
+            {
+            public:
+                /// <summary>
+                /// 排队中的协程，由调用者提供存储（通常位于挂起的协程帧内），因此排队不需要申请内存。
+                /// </summary>
+                struct Entry
+                {
+                    Entry* pNext = nullptr;
+                    std::coroutine_handle<> hCoroutine;
+                };
+
+                /// <summary>
+                /// 在当前线程恢复 _pEntry 对应的协程。
+                /// 协程恢复后 _pEntry 可能随帧一起释放，因此调用者在此之后不能再访问 _pEntry。
+                /// </summary>
+                static void __YYAPI Resume(_In_ Entry* _pEntry) noexcept;
+
+                /// <summary>
+                /// 当前线程是否正在通过 Resume 恢复协程。
+                /// </summary>
+                static bool __YYAPI IsRunning() noexcept;
+
+                /// <summary>
+                /// 协程结束、完成它的 Task 时使用。作用域内的 Resume 在已经存在最外层时只排队，由最外层在协程帧释放后恢复。
+                /// </summary>
+                class CompletionScope
+                {
+                public:
+                    CompletionScope() noexcept;
+
+                    CompletionScope(const CompletionScope&) = delete;
+                    CompletionScope& operator=(const CompletionScope&) = delete;
+
+                    ~CompletionScope();
+                };
+
+                /// <summary>
+                /// 当前线程即将阻塞等待或者进入嵌套的消息循环时使用。构造时立即恢复排在当前线程队列中的协程，作用域内的 Resume 重新作为最外层直接恢复协程，
+                /// 析构时还原。否则等待的结果如果依赖排队中的协程（或者等待期间才恢复的协程），当前线程将永远等不到。
+                /// </summary>
+                class BlockingScope
+                {
+                private:
+                    uint32_t cCompletions;
+                    bool bRunning;
+
+                public:
+                    BlockingScope() noexcept;
+
+                    BlockingScope(const BlockingScope&) = delete;
+                    BlockingScope& operator=(const BlockingScope&) = delete;
+
+                    ~BlockingScope();
+                };
+            };
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
+#endif
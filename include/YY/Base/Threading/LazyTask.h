@@ -0,0 +1,184 @@
+﻿#pragma once
+#include <YY/Base/YY.h>
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+#include <utility>
+
+#include <YY/Base/Memory/RefPtr.h>
+#include <YY/Base/Threading/TaskRunner.h>
+#include <YY/Base/Threading/Task.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            template<typename ResultType_>
+            class LazyTask;
+
+            template<typename ReturnType_>
+            struct LazyPromise : public Promise<ReturnType_>
+            {
+                LazyTask<ReturnType_> get_return_object() noexcept
+                {
+                    return LazyTask<ReturnType_>(std::coroutine_handle<LazyPromise>::from_promise(*this), this->pAsyncOperation);
+                }
+
+                std::suspend_always initial_suspend() noexcept
+                {
+                    return {};
+                }
+            };
+
+            /// <summary>
+            /// 投递到其他 TaskRunner 等待启动的协程。任务被丢弃（TaskRunner 已经销毁等）时取消结果并释放协程帧。
+            /// </summary>
+            class LazyTaskStarter : public YY::RefValue
+            {
+            private:
+                std::coroutine_handle<> hCoroutine;
+                YY::RefPtr<AsyncInfo> pAsyncInfo;
+
+            public:
+                LazyTaskStarter(std::coroutine_handle<> _hCoroutine, YY::RefPtr<AsyncInfo> _pAsyncInfo) noexcept
+                    : hCoroutine(_hCoroutine)
+                    , pAsyncInfo(std::move(_pAsyncInfo))
+                {
+                }
+
+                ~LazyTaskStarter()
+                {
+                    if (hCoroutine)
+                    {
+                        pAsyncInfo->Cancel();
+                        hCoroutine.destroy();
+                    }
+                }
+
+                void __YYAPI Resume()
+                {
+                    if (auto _hCoroutine = std::exchange(hCoroutine, nullptr))
+                        _hCoroutine.resume();
+                }
+            };
+
+            /// <summary>
+            /// 延迟启动的协程：调用协程函数时只创建协程帧，直到第一次 co_await 或者 Start 时才开始执行。
+            ///
+            /// 与 Task 不同，LazyTask 不会在创建时立即执行或者投递，适合稍后再组合（WhenAll/WhenAny）或者交给指定 TaskRunner 的工作，
+            /// 由消费者决定在哪里启动，避免一次多余的线程切换。
+            /// co_await LazyTask 时在当前线程直接启动。LazyTask 从未启动就被销毁时，协程帧被释放，结果以取消状态结束。
+            /// </summary>
+            template<typename ResultType_>
+            class LazyTask
+            {
+            public:
+                using ResultType = ResultType_;
+                using promise_type = LazyPromise<ResultType_>;
+
+            private:
+                std::coroutine_handle<promise_type> hCoroutine;
+                YY::RefPtr<AsyncOperation<ResultType>> pAsyncOperation;
+
+            public:
+                LazyTask(std::coroutine_handle<promise_type> _hCoroutine, YY::RefPtr<AsyncOperation<ResultType>> _pAsyncOperation) noexcept
+                    : hCoroutine(_hCoroutine)
+                    , pAsyncOperation(std::move(_pAsyncOperation))
+                {
+                }
+
+                LazyTask(LazyTask&& _oOther) noexcept
+                    : hCoroutine(std::exchange(_oOther.hCoroutine, nullptr))
+                    , pAsyncOperation(std::move(_oOther.pAsyncOperation))
+                {
+                }
+
+                LazyTask(const LazyTask&) = delete;
+                LazyTask& operator=(const LazyTask&) = delete;
+
+                LazyTask& operator=(LazyTask&& _oOther) noexcept
+                {
+                    if (this != &_oOther)
+                    {
+                        Reset();
+                        hCoroutine = std::exchange(_oOther.hCoroutine, nullptr);
+                        pAsyncOperation = std::move(_oOther.pAsyncOperation);
+                    }
+
+                    return *this;
+                }
+
+                ~LazyTask()
+                {
+                    Reset();
+                }
+
+                bool __YYAPI IsStarted() const noexcept
+                {
+                    return hCoroutine == nullptr;
+                }
+
+                /// <summary>
+                /// 启动协程。重复调用时只返回同一个 Task。
+                /// </summary>
+                /// <param name="_pTaskRunner">执行协程的 TaskRunner。为 nullptr 或者就是当前 TaskRunner 时，在当前线程直接启动，否则投递到该 TaskRunner。</param>
+                /// <returns>表示协程结果的 Task。投递失败时结果以取消状态结束。</returns>
+                Task<ResultType> __YYAPI Start(_In_opt_ TaskRunner* _pTaskRunner = nullptr)
+                {
+                    if (auto _hCoroutine = std::exchange(hCoroutine, nullptr))
+                    {
+                        if (_pTaskRunner == nullptr || _pTaskRunner == TaskRunner::GetCurrent())
+                        {
+                            _hCoroutine.resume();
+                        }
+                        else
+                        {
+                            auto _pStarter = YY::RefPtr<LazyTaskStarter>::Create(_hCoroutine, pAsyncOperation);
+                            if (!_pStarter)
+                            {
+                                pAsyncOperation->Cancel();
+                                _hCoroutine.destroy();
+                            }
+                            else
+                            {
+                                // 投递失败时 _pStarter 随回调一起销毁，负责取消并释放协程帧
+                                _pTaskRunner->PostTask(
+                                    [_pStarter = std::move(_pStarter)]()
+                                    {
+                                        _pStarter->Resume();
+                                    });
+                            }
+                        }
+                    }
+
+                    return Task<ResultType>(pAsyncOperation);
+                }
+
+                auto __YYAPI operator co_await()
+                {
+                    Start();
+                    return TaskAwaiter<ResultType>(pAsyncOperation, TaskRunner::GetCurrent());
+                }
+
+            private:
+                void __YYAPI Reset() noexcept
+                {
+                    if (auto _hCoroutine = std::exchange(hCoroutine, nullptr))
+                    {
+                        pAsyncOperation->Cancel();
+                        _hCoroutine.destroy();
+                    }
+                }
+            };
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
+
+#endif
@@ -0,0 +1,335 @@
+﻿#pragma once
+#include <type_traits>
+#include <utility>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/Exception.h>
+#include <YY/Base/Sync/Interlocked.h>
+#include <YY/Base/Sync/SRWLock.h>
+#include <YY/Base/Sync/AutoLock.h>
+#include <YY/Base/Containers/Span.h>
+#include <YY/Base/Threading/Task.h>
+#include <YY/Base/Threading/TaskRunner.h>
+#include <YY/Base/Utils/SystemInfo.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// ParallelForRange 等函数共享的状态，同时作为 ParallelForRangeAsync 返回的 AsyncOperation。
+            ///
+            /// 区间按引导式自调度（guided self-scheduling）切分：每次领取剩余元素的 1/(2*参与者个数)，但不少于 uGrainSize，
+            /// 开始时块较大以减少领取次数，接近结束时块变小以平衡负载。领取只需要一次 CAS，不会为每个元素投递任务。
+            /// </summary>
+            template<typename RangeBody_>
+            class ParallelForState : public AsyncOperationImpl<void>
+            {
+            private:
+                const size_t uEnd;
+                const size_t uGrainSize;
+                const size_t cTotal;
+                const uint32_t cParticipants;
+                volatile size_t uNext;
+                volatile size_t cCompleted = 0;
+                volatile uint32_t bFailed = 0;
+                std::exception_ptr pException;
+                HRESULT hrFailed = S_OK;
+                RangeBody_ pfnRangeBody;
+
+            public:
+                template<typename Body>
+                ParallelForState(size_t _uBegin, size_t _uEnd, size_t _uGrainSize, uint32_t _cParticipants, Body&& _pfnRangeBody)
+                    : uEnd(_uEnd)
+                    , uGrainSize(_uGrainSize)
+                    , cTotal(_uEnd - _uBegin)
+                    , cParticipants(_cParticipants)
+                    , uNext(_uBegin)
+                    , pfnRangeBody(std::forward<Body>(_pfnRangeBody))
+                {
+                }
+
+                /// <summary>
+                /// 不断领取并执行区块，直到没有剩余的区块。最后一个完成的区块负责完成 AsyncOperation。
+                /// </summary>
+                void __YYAPI RunChunks()
+                {
+                    size_t _uChunkBegin;
+                    size_t _uChunkEnd;
+                    while (TakeChunk(&_uChunkBegin, &_uChunkEnd))
+                    {
+                        // 出现异常后依然领取剩余区块，但不再执行，保证完成计数能够归零
+                        if (bFailed == 0)
+                        {
+                            try
+                            {
+                                pfnRangeBody(_uChunkBegin, _uChunkEnd);
+                            }
+                            catch (const YY::Exception& _oEx)
+                            {
+                                SetFailed(std::current_exception(), _oEx.GetErrorCode());
+                            }
+                            catch (...)
+                            {
+                                SetFailed(std::current_exception(), E_FAIL);
+                            }
+                        }
+
+                        if (Sync::Add(&cCompleted, _uChunkEnd - _uChunkBegin) == cTotal)
+                        {
+                            if (bFailed)
+                                SetExceptionPtr(pException, hrFailed);
+                            else
+                                Resolve();
+                        }
+                    }
+                }
+
+            private:
+                bool __YYAPI TakeChunk(_Out_ size_t* _puChunkBegin, _Out_ size_t* _puChunkEnd) noexcept
+                {
+                    size_t _uBegin = uNext;
+                    for (;;)
+                    {
+                        if (_uBegin >= uEnd)
+                            return false;
+
+                        const size_t _cRemaining = uEnd - _uBegin;
+                        size_t _cChunk = _cRemaining / (size_t(cParticipants) * 2);
+                        if (_cChunk < uGrainSize)
+                            _cChunk = uGrainSize;
+                        if (_cChunk > _cRemaining)
+                            _cChunk = _cRemaining;
+
+                        const auto _uLast = Sync::CompareExchange(&uNext, _uBegin + _cChunk, _uBegin);
+                        if (_uLast == _uBegin)
+                        {
+                            *_puChunkBegin = _uBegin;
+                            *_puChunkEnd = _uBegin + _cChunk;
+                            return true;
+                        }
+
+                        _uBegin = _uLast;
+                    }
+                }
+
+                void __YYAPI SetFailed(std::exception_ptr _pException, HRESULT _hr) noexcept
+                {
+                    if (Sync::CompareExchange(&bFailed, 1u, 0u) != 0)
+                        return;
+
+                    pException = std::move(_pException);
+                    hrFailed = _hr;
+                }
+            };
+
+            /// <summary>
+            /// 计算参与并行的线程数（包括调用线程）。
+            /// </summary>
+            inline uint32_t __YYAPI GetParallelParticipantCount(_In_ ParallelTaskRunner* _pTaskRunner, _In_ size_t _cTotal, _In_ size_t _uGrainSize) noexcept
+            {
+                uint32_t _cParticipants = _pTaskRunner->GetParallelMaximum();
+                if (_cParticipants == 0)
+                    _cParticipants = GetEffectiveProcessorCount();
+
+                const size_t _cChunks = (_cTotal + _uGrainSize - 1) / _uGrainSize;
+                if (_cChunks < _cParticipants)
+                    _cParticipants = uint32_t(_cChunks);
+
+                return _cParticipants;
+            }
+
+            /// <summary>
+            /// 并行执行 _pfnRangeBody(_uChunkBegin, _uChunkEnd)，覆盖区间 [_uBegin, _uEnd)，并阻塞到全部完成。
+            /// 调用线程也参与执行，因此在 _pTaskRunner 自身的任务中调用也不会死锁。
+            /// </summary>
+            /// <param name="_pTaskRunner">提供辅助线程的 ParallelTaskRunner，为 nullptr 时在调用线程中串行执行。</param>
+            /// <param name="_uGrainSize">每次领取的最少元素个数。单个元素的开销很小时应适当增大，以摊薄领取的开销。</param>
+            /// <exception cref="YY::Exception">任意区块抛出异常时，剩余区块不再执行，并在调用线程中重新抛出第一个异常。</exception>
+            template<typename RangeBody>
+            void __YYAPI ParallelForRange(_In_opt_ ParallelTaskRunner* _pTaskRunner, _In_ size_t _uBegin, _In_ size_t _uEnd, _In_ RangeBody&& _pfnRangeBody, _In_ size_t _uGrainSize = 1)
+            {
+                if (_uBegin >= _uEnd)
+                    return;
+
+                if (_uGrainSize == 0)
+                    _uGrainSize = 1;
+
+                const auto _cParticipants = _pTaskRunner ? GetParallelParticipantCount(_pTaskRunner, _uEnd - _uBegin, _uGrainSize) : 1u;
+                if (_cParticipants <= 1)
+                {
+                    _pfnRangeBody(_uBegin, _uEnd);
+                    return;
+                }
+
+                // 调用者阻塞到所有区块完成，因此辅助线程可以直接引用 _pfnRangeBody
+                using StateType = ParallelForState<typename std::remove_reference<RangeBody>::type&>;
+                auto _pState = YY::RefPtr<StateType>::Create(_uBegin, _uEnd, _uGrainSize, _cParticipants, _pfnRangeBody);
+                if (!_pState)
+                    throw Exception(E_OUTOFMEMORY);
+
+                for (uint32_t _uIndex = 1; _uIndex != _cParticipants; ++_uIndex)
+                {
+                    // 辅助任务开始得太晚时领取不到区块，直接退出，不会访问 _pfnRangeBody
+                    _pTaskRunner->PostTask(
+                        [_pState]()
+                        {
+                            _pState->RunChunks();
+                        });
+                }
+
+                _pState->RunChunks();
+                _pState->GetResult();
+            }
+
+            /// <summary>
+            /// 并行执行 _pfnBody(_uIndex)，_uIndex 取遍 [_uBegin, _uEnd)，并阻塞到全部完成。调用线程也参与执行。
+            /// </summary>
+            template<typename Body>
+            void __YYAPI ParallelFor(_In_opt_ ParallelTaskRunner* _pTaskRunner, _In_ size_t _uBegin, _In_ size_t _uEnd, _In_ Body&& _pfnBody, _In_ size_t _uGrainSize = 1)
+            {
+                ParallelForRange(
+                    _pTaskRunner,
+                    _uBegin,
+                    _uEnd,
+                    [&_pfnBody](size_t _uChunkBegin, size_t _uChunkEnd)
+                    {
+                        for (; _uChunkBegin != _uChunkEnd; ++_uChunkBegin)
+                        {
+                            _pfnBody(_uChunkBegin);
+                        }
+                    },
+                    _uGrainSize);
+            }
+
+            /// <summary>
+            /// 对 _oItems 中的每个元素并行执行 _pfnBody(_oItem)，并阻塞到全部完成。调用线程也参与执行。
+            /// </summary>
+            template<typename _Type, typename Body>
+            void __YYAPI ParallelForEach(_In_opt_ ParallelTaskRunner* _pTaskRunner, _In_ Span<_Type> _oItems, _In_ Body&& _pfnBody, _In_ size_t _uGrainSize = 1)
+            {
+                auto _pItems = _oItems.GetData();
+                ParallelForRange(
+                    _pTaskRunner,
+                    0,
+                    _oItems.GetSize(),
+                    [_pItems, &_pfnBody](size_t _uChunkBegin, size_t _uChunkEnd)
+                    {
+                        for (; _uChunkBegin != _uChunkEnd; ++_uChunkBegin)
+                        {
+                            _pfnBody(_pItems[_uChunkBegin]);
+                        }
+                    },
+                    _uGrainSize);
+            }
+
+            /// <summary>
+            /// 并行归约：每个区块计算 _pfnMap(_uChunkBegin, _uChunkEnd) 得到部分结果，再使用 _pfnCombine 合并。
+            /// 区块的合并顺序不确定，因此 _pfnCombine 必须满足结合律与交换律。
+            /// </summary>
+            /// <param name="_oIdentity">区间为空时的结果，同时作为合并的初始值。</param>
+            /// <returns>所有部分结果合并后的值。</returns>
+            template<typename _Type, typename MapCallback, typename CombineCallback>
+            _Type __YYAPI ParallelReduce(
+                _In_opt_ ParallelTaskRunner* _pTaskRunner,
+                _In_ size_t _uBegin,
+                _In_ size_t _uEnd,
+                _In_ _Type _oIdentity,
+                _In_ MapCallback&& _pfnMap,
+                _In_ CombineCallback&& _pfnCombine,
+                _In_ size_t _uGrainSize = 1)
+            {
+                Sync::SRWLock _oLock;
+                _Type _oResult = std::move(_oIdentity);
+                ParallelForRange(
+                    _pTaskRunner,
+                    _uBegin,
+                    _uEnd,
+                    [&](size_t _uChunkBegin, size_t _uChunkEnd)
+                    {
+                        // 引导式切分的区块数量约为 O(P·log(N/P))（P 为参与者个数，N 为元素个数），远少于元素个数，因此合并时加锁的开销可以忽略
+                        _Type _oPartial = _pfnMap(_uChunkBegin, _uChunkEnd);
+                        Sync::AutoLock<Sync::SRWLock> _oAutoLock(_oLock);
+                        _oResult = _pfnCombine(std::move(_oResult), std::move(_oPartial));
+                    },
+                    _uGrainSize);
+
+                return _oResult;
+            }
+
+            /// <summary>
+            /// ParallelForRange 的异步版本：调用线程不参与执行，_pfnRangeBody 会被复制到共享状态中。
+            /// </summary>
+            /// <returns>所有区块完成后完成的 Task。任意区块抛出异常时，Task 以第一个异常失败。</returns>
+            template<typename RangeBody>
+            Task<void> __YYAPI ParallelForRangeAsync(_In_ ParallelTaskRunner* _pTaskRunner, _In_ size_t _uBegin, _In_ size_t _uEnd, _In_ RangeBody&& _pfnRangeBody, _In_ size_t _uGrainSize = 1)
+            {
+                if (_uGrainSize == 0)
+                    _uGrainSize = 1;
+
+                const auto _cTotal = _uBegin < _uEnd ? _uEnd - _uBegin : 0;
+                if (_cTotal == 0)
+                {
+                    auto _pAsyncOperation = YY::RefPtr<AsyncOperationImpl<void>>::Create();
+                    _pAsyncOperation->Resolve();
+                    return Task<void>(std::move(_pAsyncOperation));
+                }
+
+                const auto _cParticipants = GetParallelParticipantCount(_pTaskRunner, _cTotal, _uGrainSize);
+                using StateType = ParallelForState<typename std::decay<RangeBody>::type>;
+                auto _pState = YY::RefPtr<StateType>::Create(_uBegin, _uEnd, _uGrainSize, _cParticipants, std::forward<RangeBody>(_pfnRangeBody));
+                if (!_pState)
+                    throw Exception(E_OUTOFMEMORY);
+
+                HRESULT _hr = E_FAIL;
+                for (uint32_t _uIndex = 0; _uIndex != _cParticipants; ++_uIndex)
+                {
+                    auto _hrPost = _pTaskRunner->PostTask(
+                        [_pState]()
+                        {
+                            _pState->RunChunks();
+                        });
+
+                    // 只要有一个辅助任务开始执行，它就会领取完所有剩余区块
+                    if (SUCCEEDED(_hrPost))
+                        _hr = S_OK;
+                    else if (_hr != S_OK)
+                        _hr = _hrPost;
+                }
+
+                if (FAILED(_hr))
+                    _pState->SetErrorCode(_hr);
+
+                return Task<void>(std::move(_pState));
+            }
+
+            /// <summary>
+            /// ParallelFor 的异步版本：调用线程不参与执行，_pfnBody 会被复制到共享状态中。
+            /// </summary>
+            template<typename Body>
+            Task<void> __YYAPI ParallelForAsync(_In_ ParallelTaskRunner* _pTaskRunner, _In_ size_t _uBegin, _In_ size_t _uEnd, _In_ Body&& _pfnBody, _In_ size_t _uGrainSize = 1)
+            {
+                return ParallelForRangeAsync(
+                    _pTaskRunner,
+                    _uBegin,
+                    _uEnd,
+                    [_pfnBody = typename std::decay<Body>::type(std::forward<Body>(_pfnBody))](size_t _uChunkBegin, size_t _uChunkEnd) mutable
+                    {
+                        for (; _uChunkBegin != _uChunkEnd; ++_uChunkBegin)
+                        {
+                            _pfnBody(_uChunkBegin);
+                        }
+                    },
+                    _uGrainSize);
+            }
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
@@ -0,0 +1,273 @@
+﻿#pragma once
+#include <algorithm>
+#include <functional>
+#include <new>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Containers/Span.h>
+#include <YY/Base/Containers/Sort.h>
+#include <YY/Base/Threading/Parallel.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// ParallelSort 的采样排序（samplesort）实现。
+            ///
+            /// 1. 等间距抽取 kOversampling * cBuckets 个样本并排序，从中选出最多 cBuckets - 1 个互不相等的分隔值；
+            /// 2. 把输入切成 cBlocks 块，并行统计每块落入各个桶的元素个数；
+            /// 3. 按 (桶, 块) 顺序求前缀和，得到每块每个桶在临时缓冲区中的写入位置，并行把元素移动到缓冲区；
+            /// 4. 并行排序每个桶，再移动回原区间。
+            /// 每一步的写入位置互不重叠，因此不需要任何锁。
+            ///
+            /// 样本中存在重复的分隔值说明输入含有大量重复元素，这时每个分隔值额外拥有一个相等桶，
+            /// 等于分隔值的元素全部落入相等桶，相等桶不需要排序。否则所有重复元素都会挤进同一个桶，由单个参与者排序。
+            /// </summary>
+            template<typename _Type, typename Less>
+            class ParallelSortHelper
+            {
+            public:
+                static constexpr size_t kOversampling = 32;
+                static constexpr uint32_t kBucketsPerParticipant = 4;
+                static constexpr uint32_t kMaxBuckets = 256;
+
+            private:
+                _Type* pItems;
+                size_t cItems;
+                Less& pfnLess;
+                uint32_t cBuckets = 0;
+                uint32_t cBlocks = 0;
+                // 严格递增
+                _Type* pSplitters = nullptr;
+                uint32_t cSplitters = 0;
+                // 为 true 时桶 2 * i + 1 保存等于 pSplitters[i] 的元素
+                bool bEqualityBuckets = false;
+                // cBlocks * cBuckets，先保存计数，再改为写入位置
+                size_t* pBlockOffsets = nullptr;
+                // cBuckets + 1
+                size_t* pBucketStarts = nullptr;
+                _Type* pBuffer = nullptr;
+
+            public:
+                ParallelSortHelper(_Type* _pItems, size_t _cItems, Less& _pfnLess)
+                    : pItems(_pItems)
+                    , cItems(_cItems)
+                    , pfnLess(_pfnLess)
+                {
+                }
+
+                ParallelSortHelper(const ParallelSortHelper&) = delete;
+                ParallelSortHelper& operator=(const ParallelSortHelper&) = delete;
+
+                ~ParallelSortHelper()
+                {
+                    for (uint32_t _uIndex = 0; _uIndex != cSplitters; ++_uIndex)
+                    {
+                        pSplitters[_uIndex].~_Type();
+                    }
+
+                    Memory::Free(pSplitters);
+                    Memory::Free(pBlockOffsets);
+                    Memory::Free(pBucketStarts);
+                    Memory::Free(pBuffer);
+                }
+
+                /// <returns>临时内存不足时返回 false，此时元素保持不变。</returns>
+                bool __YYAPI Sort(_In_ ParallelTaskRunner* _pTaskRunner, _In_ uint32_t _cParticipants)
+                {
+                    if (!ChooseSplitters((std::min)(_cParticipants * kBucketsPerParticipant, kMaxBuckets)))
+                        return false;
+
+                    cBlocks = _cParticipants * 2;
+                    pBlockOffsets = (size_t*)Memory::Alloc(sizeof(size_t) * cBlocks * cBuckets);
+                    pBucketStarts = (size_t*)Memory::Alloc(sizeof(size_t) * (cBuckets + 1));
+                    pBuffer = (_Type*)Memory::Alloc(sizeof(_Type) * cItems);
+                    if (!pBlockOffsets || !pBucketStarts || !pBuffer)
+                        return false;
+
+                    const size_t _cBlockItems = (cItems + cBlocks - 1) / cBlocks;
+                    ParallelFor(
+                        _pTaskRunner,
+                        0,
+                        cBlocks,
+                        [this, _cBlockItems](size_t _uBlock)
+                        {
+                            CountBlock(_uBlock, _cBlockItems);
+                        });
+
+                    size_t _uOffset = 0;
+                    for (uint32_t _uBucket = 0; _uBucket != cBuckets; ++_uBucket)
+                    {
+                        pBucketStarts[_uBucket] = _uOffset;
+                        for (uint32_t _uBlock = 0; _uBlock != cBlocks; ++_uBlock)
+                        {
+                            auto& _uSlot = pBlockOffsets[_uBlock * cBuckets + _uBucket];
+                            const auto _cCount = _uSlot;
+                            _uSlot = _uOffset;
+                            _uOffset += _cCount;
+                        }
+                    }
+                    pBucketStarts[cBuckets] = _uOffset;
+
+                    ParallelFor(
+                        _pTaskRunner,
+                        0,
+                        cBlocks,
+                        [this, _cBlockItems](size_t _uBlock)
+                        {
+                            ScatterBlock(_uBlock, _cBlockItems);
+                        });
+
+                    // 桶的大小不均匀，逐个领取以平衡负载
+                    ParallelFor(
+                        _pTaskRunner,
+                        0,
+                        cBuckets,
+                        [this](size_t _uBucket)
+                        {
+                            SortBucket(_uBucket);
+                        });
+
+                    return true;
+                }
+
+            private:
+                bool __YYAPI ChooseSplitters(_In_ uint32_t _cMaxBuckets)
+                {
+                    const size_t _cSamples = kOversampling * _cMaxBuckets;
+                    auto _pSamples = (_Type*)Memory::Alloc(sizeof(_Type) * _cSamples);
+                    if (!_pSamples)
+                        return false;
+
+                    for (size_t _uIndex = 0; _uIndex != _cSamples; ++_uIndex)
+                    {
+                        // 32 位下 _uIndex * cItems 可能超出 size_t
+                        new (_pSamples + _uIndex) _Type(pItems[size_t(uint64_t(_uIndex) * cItems / _cSamples)]);
+                    }
+
+                    SortHelper<_Type, Less>::Sort(_pSamples, _pSamples + _cSamples, pfnLess);
+
+                    pSplitters = (_Type*)Memory::Alloc(sizeof(_Type) * (_cMaxBuckets - 1));
+                    if (pSplitters)
+                    {
+                        for (uint32_t _uIndex = 1; _uIndex != _cMaxBuckets; ++_uIndex)
+                        {
+                            auto& _oSample = _pSamples[_uIndex * kOversampling];
+                            if (cSplitters && !pfnLess(pSplitters[cSplitters - 1], _oSample))
+                            {
+                                bEqualityBuckets = true;
+                                continue;
+                            }
+
+                            new (pSplitters + cSplitters) _Type(std::move(_oSample));
+                            ++cSplitters;
+                        }
+
+                        cBuckets = bEqualityBuckets ? cSplitters * 2 + 1 : cSplitters + 1;
+                    }
+
+                    for (size_t _uIndex = 0; _uIndex != _cSamples; ++_uIndex)
+                    {
+                        _pSamples[_uIndex].~_Type();
+                    }
+                    Memory::Free(_pSamples);
+                    return pSplitters != nullptr;
+                }
+
+                uint32_t __YYAPI FindBucket(const _Type& _oItem) const
+                {
+                    // 等于分隔值的元素放到分隔值右侧的桶
+                    const auto _uIndex = uint32_t(std::upper_bound(pSplitters, pSplitters + cSplitters, _oItem, pfnLess) - pSplitters);
+                    if (!bEqualityBuckets)
+                        return _uIndex;
+
+                    // _oItem >= pSplitters[_uIndex - 1]，不小于时就是相等
+                    if (_uIndex && !pfnLess(pSplitters[_uIndex - 1], _oItem))
+                        return _uIndex * 2 - 1;
+
+                    return _uIndex * 2;
+                }
+
+                void __YYAPI CountBlock(size_t _uBlock, size_t _cBlockItems)
+                {
+                    auto _pCounts = pBlockOffsets + _uBlock * cBuckets;
+                    std::fill(_pCounts, _pCounts + cBuckets, size_t(0));
+
+                    const size_t _uBegin = (std::min)(_uBlock * _cBlockItems, cItems);
+                    const size_t _uEnd = (std::min)(_uBegin + _cBlockItems, cItems);
+                    for (size_t _uIndex = _uBegin; _uIndex != _uEnd; ++_uIndex)
+                    {
+                        ++_pCounts[FindBucket(pItems[_uIndex])];
+                    }
+                }
+
+                void __YYAPI ScatterBlock(size_t _uBlock, size_t _cBlockItems)
+                {
+                    auto _pOffsets = pBlockOffsets + _uBlock * cBuckets;
+
+                    const size_t _uBegin = (std::min)(_uBlock * _cBlockItems, cItems);
+                    const size_t _uEnd = (std::min)(_uBegin + _cBlockItems, cItems);
+                    for (size_t _uIndex = _uBegin; _uIndex != _uEnd; ++_uIndex)
+                    {
+                        auto& _uOffset = _pOffsets[FindBucket(pItems[_uIndex])];
+                        new (pBuffer + _uOffset) _Type(std::move(pItems[_uIndex]));
+                        ++_uOffset;
+                    }
+                }
+
+                void __YYAPI SortBucket(size_t _uBucket)
+                {
+                    const auto _uBegin = pBucketStarts[_uBucket];
+                    const auto _uEnd = pBucketStarts[_uBucket + 1];
+                    // 相等桶内的元素全部相等，已经有序
+                    if (!bEqualityBuckets || (_uBucket & 1) == 0)
+                        SortHelper<_Type, Less>::Sort(pBuffer + _uBegin, pBuffer + _uEnd, pfnLess);
+
+                    for (auto _uIndex = _uBegin; _uIndex != _uEnd; ++_uIndex)
+                    {
+                        pItems[_uIndex] = std::move(pBuffer[_uIndex]);
+                        pBuffer[_uIndex].~_Type();
+                    }
+                }
+            };
+
+            /// <summary>
+            /// 并行排序，不稳定。元素个数达到 kParallelSortThreshold 时使用 _pTaskRunner 执行采样排序，
+            /// 否则（或者临时内存不足时）退化为 Containers::Sort。调用线程也参与执行并阻塞到排序完成。
+            /// 比较函数以及元素的移动操作不能抛出异常。
+            /// </summary>
+            /// <param name="_pTaskRunner">提供辅助线程的 ParallelTaskRunner，为 nullptr 时在调用线程中排序。</param>
+            template<typename _Type, typename Less = std::less<_Type>>
+            void __YYAPI ParallelSort(_In_opt_ ParallelTaskRunner* _pTaskRunner, _In_ Span<_Type> _oItems, _In_ Less _pfnLess = Less())
+            {
+                constexpr size_t kParallelSortThreshold = 1 << 16;
+
+                auto _pItems = _oItems.GetData();
+                const size_t _cItems = _oItems.GetSize();
+                if (_pTaskRunner && _cItems >= kParallelSortThreshold)
+                {
+                    // 每个参与者至少分到 kParallelSortThreshold / 4 个元素，否则调度开销超过收益
+                    const auto _cParticipants = GetParallelParticipantCount(_pTaskRunner, _cItems, kParallelSortThreshold / 4);
+                    if (_cParticipants > 1)
+                    {
+                        ParallelSortHelper<_Type, Less> _oHelper(_pItems, _cItems, _pfnLess);
+                        if (_oHelper.Sort(_pTaskRunner, _cParticipants))
+                            return;
+                    }
+                }
+
+                SortHelper<_Type, Less>::Sort(_pItems, _pItems + _cItems, _pfnLess);
+            }
+        } // namespace Threading
+    } // namespace Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
@@ -1,11 +1,16 @@
 ﻿#pragma once
+#include <new>
 #include <type_traits>
 #include <utility>
 #include <YY/Base/Threading/Async.h>
+#include <YY/Base/Threading/CoroutineFrameAllocator.h>
+#include <YY/Base/Threading/CoroutineTrampoline.h>
 #include <YY/Base/Threading/CancellationToken.h>
 #include <YY/Base/Memory/WeakPtr.h>
 #include <YY/Base/Memory/RefPtr.h>
 #include <YY/Base/Functional/FunctionTraits.h>
+#include <YY/Base/Containers/Array.h>
+#include <YY/Base/Containers/Span.h>
 
 #if defined(_HAS_CXX20) && _HAS_CXX20
 #include <coroutine>
@@ -370,6 +375,320 @@ namespace YY
                 return Task<int32_t>(std::move(_pWhenAnyTaskAsyncOperation));
             }
 
+            template<typename ResultType_>
+            struct WhenAllResultTraits
+            {
+                using ResultType = Array<ResultType_>;
+            };
+
+            template<>
+            struct WhenAllResultTraits<void>
+            {
+                using ResultType = HRESULT;
+            };
+
+            /// <summary>
+            /// 等待一组任务的公共部分。所有任务的 CompletedHandler 位于一次申请的连续内存中，
+            /// 并且只使用一个原子计数器记录尚未完成（或者尚未移除）的 CompletedHandler，计数归零时释放自身引用。
+            /// </summary>
+            template<typename SourceResultType_, typename ResultType_>
+            class WhenSpanTaskAsyncOperationBase : public AsyncOperationImpl<ResultType_>
+            {
+            protected:
+                class CompletedHandler : public AsyncOperationCompletedHandler<SourceResultType_>
+                {
+                public:
+                    WhenSpanTaskAsyncOperationBase* pOwner = nullptr;
+                    YY::RefPtr<AsyncOperation<SourceResultType_>> pAsyncOperation;
+
+                    void __YYAPI OnCompleted(AsyncOperation<SourceResultType_>* _pAsyncInfo, AsyncStatus _eStatus) override
+                    {
+                        UNREFERENCED_PARAMETER(_pAsyncInfo);
+                        pOwner->OnTaskCompleted(this, _eStatus);
+                    }
+                };
+
+                CompletedHandler* pHandlers = nullptr;
+                size_t cHandlers = 0;
+                // 额外的 1 属于安装过程，保证安装完成之前不会结束
+                volatile uint32_t cPendingHandlers = 1;
+
+            public:
+                ~WhenSpanTaskAsyncOperationBase()
+                {
+                    for (size_t _uIndex = 0; _uIndex != cHandlers; ++_uIndex)
+                    {
+                        pHandlers[_uIndex].~CompletedHandler();
+                    }
+
+                    Memory::Free(pHandlers);
+                }
+
+            protected:
+                bool __YYAPI AllocHandlers(_In_ Span<const Task<SourceResultType_>> _oTasks)
+                {
+                    const auto _cTasks = _oTasks.GetSize();
+                    if (_cTasks >= UINT32_MAX)
+                        return false;
+
+                    pHandlers = (CompletedHandler*)Memory::Alloc(sizeof(CompletedHandler) * _cTasks);
+                    if (!pHandlers && _cTasks)
+                        return false;
+
+                    for (; cHandlers != _cTasks; ++cHandlers)
+                    {
+                        auto _pHandler = new (pHandlers + cHandlers) CompletedHandler();
+                        _pHandler->pOwner = this;
+                        _pHandler->pAsyncOperation = _oTasks.GetData()[cHandlers].GetAsyncOperation();
+                    }
+
+                    return true;
+                }
+
+                size_t __YYAPI GetHandlerIndex(_In_ const CompletedHandler* _pHandler) const noexcept
+                {
+                    return _pHandler - pHandlers;
+                }
+
+                /// <summary>
+                /// 减少 _cCount 个未完成的 CompletedHandler，全部完成时调用 OnAllHandlersCompleted 并释放安装时增加的引用。
+                /// </summary>
+                void __YYAPI ReleaseHandlers(_In_ uint32_t _cCount)
+                {
+                    if (_cCount == 0 || Sync::Subtract(&cPendingHandlers, _cCount) != 0)
+                        return;
+
+                    auto _pThis = YY::RefPtr<WhenSpanTaskAsyncOperationBase>::FromPtr(this);
+                    OnAllHandlersCompleted();
+                }
+
+                virtual void __YYAPI OnTaskCompleted(_In_ CompletedHandler* _pHandler, _In_ AsyncStatus _eStatus) = 0;
+
+                virtual void __YYAPI OnAllHandlersCompleted() = 0;
+            };
+
+            template<typename SourceResultType_>
+            class WhenAllSpanTaskAsyncOperation
+                : public WhenSpanTaskAsyncOperationBase<SourceResultType_, typename WhenAllResultTraits<SourceResultType_>::ResultType>
+            {
+            private:
+                using BaseType = WhenSpanTaskAsyncOperationBase<SourceResultType_, typename WhenAllResultTraits<SourceResultType_>::ResultType>;
+                using CompletedHandler = typename BaseType::CompletedHandler;
+
+                volatile HRESULT hrFirstError = S_OK;
+
+            public:
+                void __YYAPI InstallCompletedHandlers(_In_ Span<const Task<SourceResultType_>> _oTasks)
+                {
+                    if (!this->AllocHandlers(_oTasks))
+                    {
+                        this->SetErrorCode(E_OUTOFMEMORY);
+                        return;
+                    }
+
+                    this->cPendingHandlers = uint32_t(this->cHandlers + 1);
+                    // 计数归零时释放
+                    this->AddRef();
+
+                    for (size_t _uIndex = 0; _uIndex != this->cHandlers; ++_uIndex)
+                    {
+                        auto _pHandler = &this->pHandlers[_uIndex];
+                        if (!_pHandler->pAsyncOperation)
+                        {
+                            Sync::CompareExchange(&hrFirstError, E_INVALIDARG, S_OK);
+                            this->ReleaseHandlers(1);
+                        }
+                        else if (!_pHandler->pAsyncOperation->AddCompletedHandler(_pHandler))
+                        {
+                            OnTaskCompleted(_pHandler, _pHandler->pAsyncOperation->GetStatus());
+                        }
+                    }
+
+                    this->ReleaseHandlers(1);
+                }
+
+            protected:
+                void __YYAPI OnTaskCompleted(_In_ CompletedHandler* _pHandler, _In_ AsyncStatus _eStatus) override
+                {
+                    if (_eStatus != AsyncStatus::Completed)
+                    {
+                        auto _hr = _eStatus == AsyncStatus::Canceled ? __HRESULT_FROM_WIN32(ERROR_CANCELLED) : _pHandler->pAsyncOperation->GetErrorCode();
+                        Sync::CompareExchange(&hrFirstError, _hr, S_OK);
+                    }
+
+                    this->ReleaseHandlers(1);
+                }
+
+                void __YYAPI OnAllHandlersCompleted() override
+                {
+                    Finish(typename std::is_void<SourceResultType_>::type());
+                }
+
+            private:
+                // Task<void> 没有结果，只汇总错误代码
+                void __YYAPI Finish(std::true_type)
+                {
+                    this->Resolve((HRESULT)hrFirstError);
+                }
+
+                void __YYAPI Finish(std::false_type)
+                {
+                    if (hrFirstError != S_OK)
+                    {
+                        this->SetErrorCode(hrFirstError);
+                        return;
+                    }
+
+                    typename WhenAllResultTraits<SourceResultType_>::ResultType _oResults;
+                    if (FAILED(_oResults.Reserve(this->cHandlers)))
+                    {
+                        this->SetErrorCode(E_OUTOFMEMORY);
+                        return;
+                    }
+
+                    for (size_t _uIndex = 0; _uIndex != this->cHandlers; ++_uIndex)
+                    {
+                        _oResults.Add(this->pHandlers[_uIndex].pAsyncOperation->GetResult());
+                    }
+
+                    this->Resolve(std::move(_oResults));
+                }
+            };
+
+            template<typename SourceResultType_>
+            class WhenAnySpanTaskAsyncOperation : public WhenSpanTaskAsyncOperationBase<SourceResultType_, int32_t>
+            {
+            private:
+                using BaseType = WhenSpanTaskAsyncOperationBase<SourceResultType_, int32_t>;
+                using CompletedHandler = typename BaseType::CompletedHandler;
+
+                // 成功注册的 CompletedHandler 个数，安装完成后不再改变
+                size_t cRegisteredHandlers = 0;
+                volatile uint32_t bInstalled = 0;
+
+            public:
+                void __YYAPI InstallCompletedHandlers(_In_ Span<const Task<SourceResultType_>> _oTasks)
+                {
+                    if (_oTasks.IsEmpty() || _oTasks.GetSize() > INT32_MAX)
+                    {
+                        this->SetErrorCode(E_INVALIDARG);
+                        return;
+                    }
+
+                    if (!this->AllocHandlers(_oTasks))
+                    {
+                        this->SetErrorCode(E_OUTOFMEMORY);
+                        return;
+                    }
+
+                    this->cPendingHandlers = uint32_t(this->cHandlers + 1);
+                    this->AddRef();
+
+                    for (; cRegisteredHandlers != this->cHandlers; ++cRegisteredHandlers)
+                    {
+                        // 已经有任务完成，剩余的任务不需要再注册
+                        if (this->GetStatus() != AsyncStatus::Started)
+                            break;
+
+                        auto _pHandler = &this->pHandlers[cRegisteredHandlers];
+                        if (!_pHandler->pAsyncOperation || !_pHandler->pAsyncOperation->AddCompletedHandler(_pHandler))
+                        {
+                            this->Resolve((int32_t)cRegisteredHandlers);
+                            break;
+                        }
+                    }
+
+                    // 需要完整的内存屏障，与 OnTaskCompleted 配合，保证至少一方会移除剩余的 CompletedHandler
+                    Sync::Exchange(&bInstalled, 1u);
+                    if (this->GetStatus() != AsyncStatus::Started)
+                        RemoveCompletedHandlers();
+
+                    // 未注册的 CompletedHandler 以及安装过程本身
+                    this->ReleaseHandlers(uint32_t(this->cHandlers - cRegisteredHandlers + 1));
+                }
+
+            protected:
+                void __YYAPI OnTaskCompleted(_In_ CompletedHandler* _pHandler, _In_ AsyncStatus _eStatus) override
+                {
+                    UNREFERENCED_PARAMETER(_eStatus);
+
+                    if (this->Resolve((int32_t)this->GetHandlerIndex(_pHandler)) && bInstalled)
+                        RemoveCompletedHandlers();
+
+                    this->ReleaseHandlers(1);
+                }
+
+                void __YYAPI OnAllHandlersCompleted() override
+                {
+                }
+
+            private:
+                void __YYAPI RemoveCompletedHandlers()
+                {
+                    for (size_t _uIndex = 0; _uIndex != cRegisteredHandlers; ++_uIndex)
+                    {
+                        auto _pHandler = &this->pHandlers[_uIndex];
+                        if (_pHandler->pAsyncOperation->RemoveCompletedHandler(_pHandler))
+                            this->ReleaseHandlers(1);
+                    }
+                }
+            };
+
+            /// <summary>
+            /// 创建一个任务，该任务将在数组中所有任务完成时完成。适合数量在运行时才能确定的一批任务。
+            /// 所有任务共用一次内存申请以及一个原子计数器。
+            /// </summary>
+            /// <param name="_oTasks">需要等待的任务，不能包含空 Task。</param>
+            /// <returns>所有任务都成功时，结果为按相同顺序排列的结果数组；否则以第一个失败任务的错误代码失败。</returns>
+            template<typename ResultType_>
+            static Task<Array<ResultType_>> __YYAPI WhenAll(_In_ Span<const Task<ResultType_>> _oTasks)
+            {
+                auto _pWhenAllTaskAsyncOperation = YY::RefPtr<WhenAllSpanTaskAsyncOperation<ResultType_>>::Create();
+                _pWhenAllTaskAsyncOperation->InstallCompletedHandlers(_oTasks);
+                return Task<Array<ResultType_>>(std::move(_pWhenAllTaskAsyncOperation));
+            }
+
+            template<typename ResultType_>
+            static Task<Array<ResultType_>> __YYAPI WhenAll(_In_ Span<Task<ResultType_>> _oTasks)
+            {
+                return WhenAll(Span<const Task<ResultType_>>(_oTasks.GetData(), _oTasks.GetSize()));
+            }
+
+            /// <summary>
+            /// 创建一个任务，该任务将在数组中所有任务完成时完成。
+            /// </summary>
+            /// <returns>如果所有任务都成功完成，则结果为 S_OK；否则为第一个失败任务的错误代码。</returns>
+            static inline Task<HRESULT> __YYAPI WhenAll(_In_ Span<const Task<void>> _oTasks)
+            {
+                auto _pWhenAllTaskAsyncOperation = YY::RefPtr<WhenAllSpanTaskAsyncOperation<void>>::Create();
+                _pWhenAllTaskAsyncOperation->InstallCompletedHandlers(_oTasks);
+                return Task<HRESULT>(std::move(_pWhenAllTaskAsyncOperation));
+            }
+
+            static inline Task<HRESULT> __YYAPI WhenAll(_In_ Span<Task<void>> _oTasks)
+            {
+                return WhenAll(Span<const Task<void>>(_oTasks.GetData(), _oTasks.GetSize()));
+            }
+
+            /// <summary>
+            /// 创建一个任务，该任务将在数组中任意一个任务完成（包括失败或者取消）时完成。
+            /// 结果确定后，其余任务上的 CompletedHandler 会被立即移除。
+            /// </summary>
+            /// <returns>第一个完成的任务的索引。数组为空时以 E_INVALIDARG 失败。</returns>
+            template<typename ResultType_>
+            static Task<int32_t> __YYAPI WhenAny(_In_ Span<const Task<ResultType_>> _oTasks)
+            {
+                auto _pWhenAnyTaskAsyncOperation = YY::RefPtr<WhenAnySpanTaskAsyncOperation<ResultType_>>::Create();
+                _pWhenAnyTaskAsyncOperation->InstallCompletedHandlers(_oTasks);
+                return Task<int32_t>(std::move(_pWhenAnyTaskAsyncOperation));
+            }
+
+            template<typename ResultType_>
+            static Task<int32_t> __YYAPI WhenAny(_In_ Span<Task<ResultType_>> _oTasks)
+            {
+                return WhenAny(Span<const Task<ResultType_>>(_oTasks.GetData(), _oTasks.GetSize()));
+            }
+
             template<typename CallbackType_, typename ResultType_ = typename FunctionTraits<CallbackType_>::ReturnType>
             class TaskAsyncOperation : public AsyncOperationImpl<ResultType_>
             {
@@ -724,11 +1043,32 @@ namespace YY
             };
 
 #if defined(_HAS_CXX20) && _HAS_CXX20
+            /// <summary>
+            /// 协程帧从 CoroutineFrameAllocator 申请，短小的协程反复调用时不需要访问堆。
+            /// </summary>
+            struct PromiseBase
+            {
+                static void* operator new(size_t _cbSize)
+                {
+                    auto _pFrame = CoroutineFrameAllocator::Alloc(_cbSize);
+                    if (!_pFrame)
+                        throw std::bad_alloc();
+
+                    return _pFrame;
+                }
+
+                static void operator delete(void* _pFrame, size_t _cbSize) noexcept
+                {
+                    CoroutineFrameAllocator::Free(_pFrame, _cbSize);
+                }
+            };
+
             template<typename ReturnType_>
-            struct Promise
+            struct Promise : public PromiseBase
             {
                 using ReturnType = ReturnType_;
-                YY::RefPtr<AsyncOperationImpl<ReturnType>> pAsyncOperation = YY::RefPtr<AsyncOperationImpl<ReturnType>>::Create();
+                // 协程结束时帧立即释放，而 Task 可能持有 AsyncOperation 更久，因此 AsyncOperation 单独从对象池申请
+                YY::RefPtr<AsyncOperationImpl<ReturnType>> pAsyncOperation = YY::RefPtr<AsyncOperationImpl<ReturnType>>::CreateFromPool();
 
                 Task<ReturnType> get_return_object() noexcept
                 {
@@ -747,6 +1087,8 @@ namespace YY
 
                 void return_value(ReturnType&& _oValue)
                 {
+                    // 等待者排入 CoroutineTrampoline，待协程帧释放后再恢复
+                    CoroutineTrampoline::CompletionScope _oCompletionScope;
                     if (pAsyncOperation->IsCanceled())
                     {
                         pAsyncOperation->ThrowIfWaitTaskFailed();
@@ -757,6 +1099,7 @@ namespace YY
 
                 void unhandled_exception()
                 {
+                    CoroutineTrampoline::CompletionScope _oCompletionScope;
                     try
                     {
                         throw;
@@ -773,10 +1116,10 @@ namespace YY
             };
 
             template<>
-            struct Promise<void>
+            struct Promise<void> : public PromiseBase
             {
                 using ReturnType = void;
-                YY::RefPtr<AsyncOperationImpl<void>> pAsyncOperation = YY::RefPtr<AsyncOperationImpl<void>>::Create();
+                YY::RefPtr<AsyncOperationImpl<void>> pAsyncOperation = YY::RefPtr<AsyncOperationImpl<void>>::CreateFromPool();
 
                 Task<ReturnType> get_return_object() noexcept
                 {
@@ -795,6 +1138,7 @@ namespace YY
 
                 void return_void()
                 {
+                    CoroutineTrampoline::CompletionScope _oCompletionScope;
                     if (pAsyncOperation)
                     {
                         if (pAsyncOperation->IsCanceled())
@@ -811,6 +1155,7 @@ namespace YY
                     if (!pAsyncOperation)
                         return;
 
+                    CoroutineTrampoline::CompletionScope _oCompletionScope;
                     try
                     {
                         throw;
@@ -826,13 +1171,21 @@ namespace YY
                 }
             };
 
+            /// <summary>
+            /// co_await Task 时使用的等待器。
+            ///
+            /// await_suspend 返回协程句柄（对称转移）：Task 已经完成时直接转移回当前协程，不经过递归恢复。
+            /// Task 完成时如果已经位于目标 TaskRunner（或者不需要切换线程），协程通过 CoroutineTrampoline 内联恢复，
+            /// 不会重新投递任务，连续完成的 co_await 链也不会加深调用栈；否则投递到目标 TaskRunner 中恢复。
+            /// </summary>
             template<typename ResultType_>
             class TaskAwaiter : protected AsyncOperationCompletedHandler<ResultType_>
             {
             private:
                 YY::RefPtr<AsyncOperation<ResultType_>> pAsyncOperation;
                 YY::WeakPtr<TaskRunner> pResumeTaskRunnerWeak;
-                std::coroutine_handle<> hCoroutine;
+                // 等待器位于挂起的协程帧内，排队恢复时直接使用这里的存储
+                CoroutineTrampoline::Entry oResumeEntry;
 
             public:
                 TaskAwaiter(YY::RefPtr<AsyncOperation<ResultType_>> _pAsyncOperation, YY::RefPtr<TaskRunner> _pResumeTaskRunner) noexcept
@@ -851,19 +1204,22 @@ namespace YY
                     return pAsyncOperation->GetStatus() != AsyncStatus::Started;
                 }
 
-                bool await_suspend(std::coroutine_handle<> _hCoroutine) noexcept
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> _hCoroutine) noexcept
                 {
                     if (pAsyncOperation->IsCanceled())
                     {
-                        return false;
+                        return _hCoroutine;
                     }
 
-                    hCoroutine = _hCoroutine;
+                    oResumeEntry.hCoroutine = _hCoroutine;
                     if (!pAsyncOperation->AddCompletedHandler(this))
                     {
-                        return false;
+                        // 在 await_ready 之后完成，直接转移回当前协程
+                        return _hCoroutine;
                     }
-                    return true;
+
+                    // 注册成功后协程可能已经在其他线程恢复，不能再访问 this
+                    return std::noop_coroutine();
                 }
 
                 ResultType_ await_resume()
@@ -874,35 +1230,31 @@ namespace YY
                 void __YYAPI OnCompleted(AsyncOperation<ResultType_>* _pAsyncInfo, AsyncStatus _eStatus) override
                 {
                     UNREFERENCED_PARAMETER(_pAsyncInfo);
-                    
+
+                    if (!oResumeEntry.hCoroutine)
+                        return;
+
                     if (pResumeTaskRunnerWeak == nullptr)
                     {
-                        if (hCoroutine)
-                        {
-                            hCoroutine.resume();
-                        }
+                        CoroutineTrampoline::Resume(&oResumeEntry);
                     }
                     else if (auto _pResumeTaskRunner = pResumeTaskRunnerWeak.Get())
                     {
                         if (_pResumeTaskRunner == YY::TaskRunner::GetCurrent())
                         {
-                            if (hCoroutine)
-                            {
-                                hCoroutine.resume();
-                            }
-
+                            CoroutineTrampoline::Resume(&oResumeEntry);
                             return;
                         }
 
                         _pResumeTaskRunner->PostTask(
-                            [hCoroutine = hCoroutine.address()]()
+                            [pResumeEntry = &oResumeEntry]()
                             {
-                                std::coroutine_handle<>::from_address(hCoroutine).resume();
+                                CoroutineTrampoline::Resume(pResumeEntry);
                             });
                     }
                     else
                     {
-                        hCoroutine.destroy();
+                        oResumeEntry.hCoroutine.destroy();
                     }
                 }
             };
@@ -45,11 +45,29 @@ namespace YY
 
             YY_APPLY_ENUM_CALSS_BIT_OPERATOR(TaskEntryStyle);
 
+            /// <summary>
+            /// 任务优先级。TaskRunner 优先执行优先级更高的任务，但也会定期执行低优先级的任务，避免其饿死。
+            /// </summary>
+            enum class TaskPriority : uint8_t
+            {
+                // 用户正在等待结果的交互任务，比如输入响应。
+                UserBlocking = 0,
+                // 默认优先级。
+                Normal,
+                // 后台任务，不影响用户交互，完成时间不敏感。
+                Background,
+                Count,
+            };
+
+            // 不限定 NUMA 节点，由线程池就近选择。
+            constexpr uint32_t kAnyNumaNode = UINT32_MAX;
+
             class TaskRunner;
 
             struct TaskEntry : public RefValue
             {
                 TaskEntryStyle fStyle = TaskEntryStyle::None;
+                TaskPriority ePriority = TaskPriority::Normal;
                 // 操作结果，任务可能被取消。
                 HRESULT hr = E_PENDING;
 
@@ -244,9 +262,10 @@ namespace YY
                 /// <typeparam name="ResultType_">任务结果类型。</typeparam>
                 /// <param name="_pfnAsyncCallback">异步回调函数。</param>
                 /// <param name="_pCancellationToken">取消Token。</param> 
+                /// <param name="_ePriority">任务优先级。</param> 
                 /// <returns>返回一个表示异步操作的任务对象。</returns>
                 template<typename AsyncCallbackType_, typename ResultType_ = decltype(std::declval<AsyncCallbackType_>()())>
-                Task<ResultType_> __YYAPI CreateTask(AsyncCallbackType_ && _pfnAsyncCallback, _In_opt_ YY::RefPtr<CancellationToken> _pCancellationToken = nullptr)
+                Task<ResultType_> __YYAPI CreateTask(AsyncCallbackType_ && _pfnAsyncCallback, _In_opt_ YY::RefPtr<CancellationToken> _pCancellationToken = nullptr, _In_ TaskPriority _ePriority = TaskPriority::Normal)
                 {
                     using AsyncCallbackType = typename std::decay<AsyncCallbackType_>::type;
                     auto _pTaskAsyncOperation = YY::RefPtr<TaskAsyncOperation<AsyncCallbackType_, ResultType_>>::Create(std::forward<AsyncCallbackType_>(_pfnAsyncCallback), _pCancellationToken);
@@ -263,7 +282,8 @@ namespace YY
                             [_pTaskAsyncOperation]()
                             {
                                 _pTaskAsyncOperation->Resume();
-                            });
+                            },
+                            _ePriority);
                     }
 
                     return Task<ResultType_>(std::move(_pTaskAsyncOperation));
@@ -362,6 +382,37 @@ namespace YY
                 /// <returns></returns>
                 HRESULT __YYAPI PostTask(_In_ std::function<void(void)>&& _pfnTaskCallback);
 
+                /// <summary>
+                /// 以指定优先级将任务异步执行。
+                /// </summary>
+                /// <param name="_pfnTaskCallback">需要异步执行回调。</param>
+                /// <param name="_ePriority">任务优先级。同一优先级的任务按投递顺序执行；SequencedTaskRunner 依然保证任务串行，但不同优先级的任务之间不保证投递顺序。</param>
+                /// <returns></returns>
+                HRESULT __YYAPI PostTask(_In_ std::function<void(void)>&& _pfnTaskCallback, _In_ TaskPriority _ePriority);
+
+                /// <summary>
+                /// 如果 TaskRunner 当前空闲（没有正在执行以及排队的任务），那么直接在调用线程中执行任务，否则与 PostTask 相同。
+                /// 
+                /// 直接执行时，调用者获得 TaskRunner 的执行权，任务中 TaskRunner::GetCurrent() 返回该 TaskRunner，
+                /// 期间投递的其他任务排在其后，依然保证串行。这样跨 TaskRunner 的请求/响应链可以省去一次线程切换。
+                /// 
+                /// 注意：
+                /// * 任务可能在调用者的线程中同步执行，调用者需要能够接受阻塞。
+                /// * 目前仅 SequencedTaskRunner::Create 创建的 TaskRunner 支持直接执行，其他 TaskRunner 总是投递。
+                /// * 嵌套直接执行的层数有限，超过后改为投递，避免请求链过长时耗尽调用栈。
+                /// </summary>
+                /// <param name="_pfnTaskCallback">需要执行的回调。</param>
+                /// <returns></returns>
+                HRESULT __YYAPI RunOrPostTask(_In_ std::function<void(void)>&& _pfnTaskCallback);
+
+                /// <summary>
+                /// 批量将任务异步执行，执行顺序与 _oTaskCallbacks 一致。_oTaskCallbacks 中的回调将被移走。
+                /// 与逐个 PostTask 相比，整批任务只锁定一次队列、只更新一次唤醒计数，并一次性唤醒所需的线程。
+                /// </summary>
+                /// <param name="_oTaskCallbacks">需要异步执行回调。</param>
+                /// <returns>失败时返回第一个错误代码。任务很多时会分批投递，因此失败时可能已经投递了部分任务。</returns>
+                HRESULT __YYAPI PostTasks(_In_ Span<std::function<void(void)>> _oTaskCallbacks, _In_ TaskPriority _ePriority = TaskPriority::Normal);
+
                 /// <summary>
                 /// 同步执行Callback。严重警告：这可能阻塞调用者，甚至产生死锁！！！
                 /// </summary>
@@ -425,6 +476,17 @@ namespace YY
             protected:
                 virtual HRESULT __YYAPI PostTaskInternal(_In_ RefPtr<TaskEntry> _pTask) = 0;
 
+                /// <summary>
+                /// 批量投递任务，_oTasks 中每个元素各持有一次引用计数，调用后全部转移给 TaskRunner。
+                /// 默认实现逐个调用 PostTaskInternal。
+                /// </summary>
+                virtual HRESULT __YYAPI PostTasksInternal(_In_ Span<TaskEntry*> _oTasks);
+
+                /// <summary>
+                /// TaskRunner 空闲时在调用线程中直接执行任务，否则投递。默认实现总是调用 PostTaskInternal。
+                /// </summary>
+                virtual HRESULT __YYAPI RunOrPostTaskInternal(_In_ RefPtr<TaskEntry> _pTask);
+
                 virtual HRESULT __YYAPI SetTimerInternal(_In_ RefPtr<Timer> _pTask);
 
                 virtual HRESULT __YYAPI SetWaitInternal(_In_ RefPtr<WaitAsyncOperation> _pTask);
@@ -451,6 +513,50 @@ namespace YY
                 /// <returns>返回TaskRunner指针，函数几乎不会失败，但是如果内存不足，那么将返回 nullptr。</returns>
                 static RefPtr<SequencedTaskRunner> __YYAPI Create(uString _szThreadDescription = uString());
 
+                /// <summary>
+                /// 从线程池创建一个TaskRunner，并指定每次占用线程池线程的时间片。
+                /// 
+                /// 连续执行的任务数量达到 _cQuantumTasks，或者执行时间达到 _uQuantumTime 后，TaskRunner 将线程还给线程池，
+                /// 并重新排队到线程池末尾，剩余任务在下一次调度时继续执行。这样繁忙的 TaskRunner 不会长期独占线程，其他 TaskRunner 的延迟也有上限。
+                /// 
+                /// 默认的 Create 不限制时间片，一直执行到队列为空才归还线程。
+                /// </summary>
+                /// <param name="_cQuantumTasks">每个时间片最多执行的任务数量，0 表示不限制。</param>
+                /// <param name="_uQuantumTime">每个时间片最长的执行时间，TimeSpan::GetMax() 表示不限制。单个任务的执行时间不会被打断，并且每执行 16 个任务才检查一次时间。</param>
+                /// <param name="_szThreadDescription">线程描述。对于Windows平台，该信息设置后调试器可直接从线程查看此信息。</param>
+                /// <returns>返回TaskRunner指针，函数几乎不会失败，但是如果内存不足，那么将返回 nullptr。</returns>
+                static RefPtr<SequencedTaskRunner> __YYAPI Create(_In_ uint32_t _cQuantumTasks, _In_ TimeSpan _uQuantumTime, uString _szThreadDescription = uString());
+            };
+
+            enum class ThreadSchedulingPriority
+            {
+                // 保持线程原有的调度策略以及优先级。
+                Default = 0,
+                // Windows：THREAD_PRIORITY_HIGHEST；Linux：SCHED_RR。
+                High,
+                // Windows：THREAD_PRIORITY_TIME_CRITICAL；Linux：SCHED_FIFO。
+                TimeCritical,
+            };
+
+            /// <summary>
+            /// ThreadTaskRunner 的创建选项，适合对任务派发延迟敏感的场景。
+            /// 亲和性以及调度优先级在线程开始执行 TaskRunner 时设置，设置失败（比如 Linux 没有 CAP_SYS_NICE 权限）时忽略并且保持原样。
+            /// </summary>
+            struct ThreadTaskRunnerOptions
+            {
+                // 使用后台循环，参考 ThreadTaskRunner::Create 的 _bBackgroundLoop 参数。
+                bool bBackgroundLoop = true;
+                // 为 true 时新建一个线程专门执行该 TaskRunner，TaskRunner 退出后线程随之结束，不会归还线程池。
+                // 借用线程池线程时，亲和性以及优先级会在 TaskRunner 退出后还原。
+                bool bDedicatedThread = false;
+                ThreadSchedulingPriority ePriority = ThreadSchedulingPriority::Default;
+                // 允许执行的逻辑处理器，第 N 位代表处理器 N（Windows 为当前处理器组内的编号），0 表示不限制。
+                uint64_t fProcessorAffinityMask = 0;
+                // 任务队列为空后先忙等待多久再进入睡眠，期间投递任务无需唤醒线程。只对后台循环有效，0 表示不忙等待。
+                // 忙等待期间将完全占用一个处理器，一般与 fProcessorAffinityMask 以及 bDedicatedThread 配合使用。
+                TimeSpan uBusyPollTime;
+                // 线程描述。对于Windows平台，该信息设置后调试器可直接从线程查看此信息。
+                uString szThreadDescription;
             };
 
             // 任务串行并且拥有固定线程的任务执行器
@@ -467,6 +573,12 @@ namespace YY
                 /// <returns></returns>
                 static RefPtr<ThreadTaskRunner> __YYAPI Create(_In_ bool _bBackgroundLoop = true, uString _szThreadDescription = uString());
 
+                /// <summary>
+                /// 按照 _oOptions 创建 ThreadTaskRunner，可以指定处理器亲和性、调度优先级、独占线程以及忙等待时间。
+                /// </summary>
+                /// <returns>如果内存不足或者无法创建线程，那么将返回 nullptr。</returns>
+                static RefPtr<ThreadTaskRunner> __YYAPI Create(_In_ const ThreadTaskRunnerOptions& _oOptions);
+
                 /// <summary>
                 /// 获取当前线程绑定的TaskRunner。
                 /// </summary>
@@ -526,9 +638,14 @@ namespace YY
                 // 允许并行执行的最大个数
                 // 如果为 0，则表示跟随系统物理线程数
                 volatile uint32_t uParallelMaximum;
+                // 执行任务的线程所在的 NUMA 节点，kAnyNumaNode 表示不限定
+                const uint32_t uNumaNode;
+                // 阻塞等待的线程是否帮助执行排队中的任务
+                volatile bool bHelpWhileWaiting = false;
 
-                ParallelTaskRunner(uint32_t _uParallelMaximum)
+                ParallelTaskRunner(uint32_t _uParallelMaximum, uint32_t _uNumaNode = kAnyNumaNode)
                     : uParallelMaximum(_uParallelMaximum)
+                    , uNumaNode(_uNumaNode)
                 {
                 }
 
@@ -545,6 +662,15 @@ namespace YY
                 /// <returns></returns>
                 static RefPtr<ParallelTaskRunner> __YYAPI Create(uint32_t _uParallelMaximum = 0u, uString _szThreadDescription = uString()) noexcept;
 
+                /// <summary>
+                /// 创建一个固定在指定 NUMA 节点上执行任务的 ParallelTaskRunner。
+                /// 任务只由该节点的处理器执行，任务申请的内存也优先来自该节点，适合处理集中在某个节点上的数据。
+                /// </summary>
+                /// <param name="_uParallelMaximum">最大允许的物理线程并发数，如果此参数为0，则按系统CPU逻辑线程数并行。</param>
+                /// <param name="_uNumaNode">NUMA 节点编号，可以通过 GetProcessorInfo().cNumaNodes 获取节点数。kAnyNumaNode 表示不限定。</param>
+                /// <param name="_szThreadDescription">线程描述。对于Windows平台，该信息设置后调试器可直接从线程查看此信息。</param>
+                static RefPtr<ParallelTaskRunner> __YYAPI Create(uint32_t _uParallelMaximum, uint32_t _uNumaNode, uString _szThreadDescription = uString()) noexcept;
+
                 uint32_t __YYAPI GetParallelMaximum() const noexcept
                 {
                     return uParallelMaximum;
@@ -554,6 +680,27 @@ namespace YY
                 {
                     uParallelMaximum = _uParallelMaximum;
                 }
+
+                uint32_t __YYAPI GetNumaNode() const noexcept
+                {
+                    return uNumaNode;
+                }
+
+                bool __YYAPI IsHelpWhileWaiting() const noexcept
+                {
+                    return bHelpWhileWaiting;
+                }
+
+                /// <summary>
+                /// 设置本 TaskRunner 的任务无限期阻塞等待（Task::GetResult、TaskEntry::WaitTask 等）时，是否先在当前线程帮助执行本 TaskRunner 中排队的任务。
+                /// 
+                /// 默认关闭。被帮助的任务运行在等待者的调用栈内，如果它需要获取等待者已经持有的锁，或者它本身依赖等待者的结果，将会死锁，
+                /// 因此只有任务之间没有这类依赖时才应该开启。开启后 _uParallelMaximum 较小的 TaskRunner 中嵌套等待本 TaskRunner 的任务也不会永久阻塞。
+                /// </summary>
+                void __YYAPI SetHelpWhileWaiting(bool _bHelpWhileWaiting) noexcept
+                {
+                    bHelpWhileWaiting = _bHelpWhileWaiting;
+                }
             };
         }
     }
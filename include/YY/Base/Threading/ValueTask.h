@@ -0,0 +1,261 @@
+﻿#pragma once
+#include <utility>
+
+#include <YY/Base/YY.h>
+#include <YY/Base/Containers/Optional.h>
+#include <YY/Base/Threading/Task.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+#if defined(_HAS_CXX20) && _HAS_CXX20
+            template<typename ResultType_>
+            class ValueTaskAwaiter;
+#endif
+
+            /// <summary>
+            /// 大多数情况下同步完成的异步结果。
+            ///
+            /// 同步完成时结果直接保存在对象内，不申请 AsyncOperation；只有真正需要等待时才包装一个 Task。
+            /// 已完成的 ValueTask 不共享任何状态，调用者无法取消或者向其他调用者的结果添加回调。
+            /// </summary>
+            template<typename ResultType_>
+            class ValueTask
+            {
+            public:
+                using ResultType = ResultType_;
+
+            private:
+                Optional<ResultType> oResult;
+                YY::RefPtr<AsyncOperation<ResultType>> pAsyncOperation;
+
+            public:
+                ValueTask(const ResultType& _oResult)
+                    : oResult(_oResult)
+                {
+                }
+
+                ValueTask(ResultType&& _oResult) noexcept
+                    : oResult(std::move(_oResult))
+                {
+                }
+
+                ValueTask(const Task<ResultType>& _oTask) noexcept
+                    : pAsyncOperation(_oTask.GetAsyncOperation())
+                {
+                }
+
+                /// <summary>
+                /// 获取等待中的异步操作。同步完成时返回 nullptr。
+                /// </summary>
+                YY::RefPtr<AsyncOperation<ResultType>> GetAsyncOperation() const noexcept
+                {
+                    return pAsyncOperation;
+                }
+
+                HRESULT __YYAPI GetErrorCode() const noexcept
+                {
+                    return oResult.HasValue() ? S_OK : pAsyncOperation->GetErrorCode();
+                }
+
+                AsyncStatus __YYAPI GetStatus() const noexcept
+                {
+                    return oResult.HasValue() ? AsyncStatus::Completed : pAsyncOperation->GetStatus();
+                }
+
+                ResultType __YYAPI GetResult() const
+                {
+                    return oResult.HasValue() ? oResult.GetValue() : pAsyncOperation->GetResult();
+                }
+
+                /// <summary>
+                /// 转换为 Task，以便使用 Then、WhenAll 等。同步完成时需要申请一个已完成的 AsyncOperation。
+                /// </summary>
+                Task<ResultType> __YYAPI AsTask() const
+                {
+                    if (!oResult.HasValue())
+                        return Task<ResultType>(pAsyncOperation);
+
+                    auto _pAsyncOperation = YY::RefPtr<AsyncOperationImpl<ResultType>>::Create();
+                    if (!_pAsyncOperation)
+                        throw Exception(E_OUTOFMEMORY);
+
+                    _pAsyncOperation->Resolve(oResult.GetValue());
+                    return Task<ResultType>(std::move(_pAsyncOperation));
+                }
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+                ValueTaskAwaiter<ResultType> __YYAPI operator co_await() &&
+                {
+                    if (oResult.HasValue())
+                        return ValueTaskAwaiter<ResultType>(std::move(oResult.GetValue()));
+
+                    return ValueTaskAwaiter<ResultType>(pAsyncOperation);
+                }
+
+                ValueTaskAwaiter<ResultType> __YYAPI operator co_await() const&
+                {
+                    if (oResult.HasValue())
+                        return ValueTaskAwaiter<ResultType>(oResult.GetValue());
+
+                    return ValueTaskAwaiter<ResultType>(pAsyncOperation);
+                }
+#endif
+            };
+
+            template<>
+            class ValueTask<void>
+            {
+            public:
+                using ResultType = void;
+
+            private:
+                // 为空时表示已经同步完成
+                YY::RefPtr<AsyncOperation<void>> pAsyncOperation;
+
+            public:
+                /// <summary>
+                /// 构造一个已经完成的 ValueTask。
+                /// </summary>
+                constexpr ValueTask() noexcept = default;
+
+                ValueTask(const Task<void>& _oTask) noexcept
+                    : pAsyncOperation(_oTask.GetAsyncOperation())
+                {
+                }
+
+                /// <summary>
+                /// 获取等待中的异步操作。同步完成时返回 nullptr。
+                /// </summary>
+                YY::RefPtr<AsyncOperation<void>> GetAsyncOperation() const noexcept
+                {
+                    return pAsyncOperation;
+                }
+
+                HRESULT __YYAPI GetErrorCode() const noexcept
+                {
+                    return pAsyncOperation ? pAsyncOperation->GetErrorCode() : S_OK;
+                }
+
+                AsyncStatus __YYAPI GetStatus() const noexcept
+                {
+                    return pAsyncOperation ? pAsyncOperation->GetStatus() : AsyncStatus::Completed;
+                }
+
+                void __YYAPI GetResult() const
+                {
+                    if (pAsyncOperation)
+                        pAsyncOperation->GetResult();
+                }
+
+                /// <summary>
+                /// 转换为 Task，以便使用 Then、WhenAll 等。同步完成时需要申请一个已完成的 AsyncOperation。
+                /// </summary>
+                Task<void> __YYAPI AsTask() const
+                {
+                    if (pAsyncOperation)
+                        return Task<void>(pAsyncOperation);
+
+                    auto _pAsyncOperation = YY::RefPtr<AsyncOperationImpl<void>>::Create();
+                    if (!_pAsyncOperation)
+                        throw Exception(E_OUTOFMEMORY);
+
+                    _pAsyncOperation->Resolve();
+                    return Task<void>(std::move(_pAsyncOperation));
+                }
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+                ValueTaskAwaiter<void> __YYAPI operator co_await() const;
+#endif
+            };
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+            /// <summary>
+            /// co_await ValueTask 时使用的等待器。同步完成时 await_ready 直接返回 true，否则与 co_await Task 的行为相同。
+            /// </summary>
+            template<typename ResultType_>
+            class ValueTaskAwaiter
+            {
+            private:
+                Optional<ResultType_> oResult;
+                TaskAwaiter<ResultType_> oTaskAwaiter;
+
+            public:
+                ValueTaskAwaiter(ResultType_ _oResult)
+                    : oResult(std::move(_oResult))
+                    , oTaskAwaiter(nullptr, nullptr)
+                {
+                }
+
+                ValueTaskAwaiter(YY::RefPtr<AsyncOperation<ResultType_>> _pAsyncOperation) noexcept
+                    : oTaskAwaiter(std::move(_pAsyncOperation), TaskRunner::GetCurrent())
+                {
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return oResult.HasValue() || oTaskAwaiter.await_ready();
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> _hCoroutine) noexcept
+                {
+                    return oTaskAwaiter.await_suspend(_hCoroutine);
+                }
+
+                ResultType_ await_resume()
+                {
+                    if (oResult.HasValue())
+                        return std::move(oResult.GetValue());
+
+                    return oTaskAwaiter.await_resume();
+                }
+            };
+
+            template<>
+            class ValueTaskAwaiter<void>
+            {
+            private:
+                bool bCompleted;
+                TaskAwaiter<void> oTaskAwaiter;
+
+            public:
+                ValueTaskAwaiter(YY::RefPtr<AsyncOperation<void>> _pAsyncOperation) noexcept
+                    : bCompleted(_pAsyncOperation == nullptr)
+                    , oTaskAwaiter(std::move(_pAsyncOperation), bCompleted ? nullptr : TaskRunner::GetCurrent())
+                {
+                }
+
+                bool await_ready() const noexcept
+                {
+                    return bCompleted || oTaskAwaiter.await_ready();
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> _hCoroutine) noexcept
+                {
+                    return oTaskAwaiter.await_suspend(_hCoroutine);
+                }
+
+                void await_resume()
+                {
+                    if (!bCompleted)
+                        oTaskAwaiter.await_resume();
+                }
+            };
+
+            inline ValueTaskAwaiter<void> __YYAPI ValueTask<void>::operator co_await() const
+            {
+                return ValueTaskAwaiter<void>(pAsyncOperation);
+            }
+#endif
+        } // namespace YY::Base::Threading
+    } // namespace YY::Base
+
+    using namespace YY::Base::Threading;
+} // namespace YY
+
+#pragma pack(pop)
@@ -73,6 +73,48 @@ namespace YY
             /// </summary>
             /// <returns></returns>
             Version __YYAPI GetOperatingSystemVersion() noexcept;
+
+            /// <summary>
+            /// 处理器拓扑信息，无法获取的项为 0。
+            /// </summary>
+            struct ProcessorInfo
+            {
+                // 当前进程实际可以使用的处理器数，已经考虑处理器亲和性以及 CPU 配额（Linux cgroup、Windows 作业对象），至少为 1。
+                uint32_t cEffectiveProcessors = 0;
+                // 系统中的逻辑处理器数。
+                uint32_t cLogicalProcessors = 0;
+                // 系统中的物理核心数。
+                uint32_t cPhysicalCores = 0;
+                // 每个物理核心的逻辑处理器数（SMT），不支持 SMT 时为 1。
+                uint32_t cSmtSiblings = 0;
+                // NUMA 节点数。
+                uint32_t cNumaNodes = 0;
+                // 各级缓存的大小（字节）。
+                uint32_t cbL1DataCache = 0;
+                uint32_t cbL2Cache = 0;
+                uint32_t cbL3Cache = 0;
+                // 缓存行大小（字节）。
+                uint32_t cbCacheLine = 0;
+            };
+
+            /// <summary>
+            /// 获取处理器拓扑信息。拓扑只在第一次调用时读取，cEffectiveProcessors 与 GetEffectiveProcessorCount 相同。
+            /// * Linux平台：从 /sys 以及 /proc 读取。
+            /// </summary>
+            ProcessorInfo __YYAPI GetProcessorInfo() noexcept;
+
+            /// <summary>
+            /// 获取当前进程实际可以使用的处理器数，用于确定并行度等默认值。
+            /// 结果会缓存，每秒最多重新读取一次，因此容器的 CPU 配额或者亲和性改变后会自动生效。
+            /// </summary>
+            /// <returns>至少为 1。</returns>
+            uint32_t __YYAPI GetEffectiveProcessorCount() noexcept;
+
+            /// <summary>
+            /// 获取当前线程正在运行的处理器所属的 NUMA 节点。未固定亲和性的线程随时可能被调度到其他节点，因此结果只能作为提示。
+            /// </summary>
+            /// <returns>NUMA 节点编号，系统不支持 NUMA 时返回 0。</returns>
+            uint32_t __YYAPI GetCurrentNumaNode() noexcept;
         }
     }
 
@@ -55,7 +55,7 @@ public:
 
 Task<uint32_t>__YYAPI AsyncFile::ReadAsync(uint64_t _uOffset, void* _pBuffer, uint32_t _cbBufferToRead, YY::RefPtr<CancellationToken> _pCancellationToken) noexcept
 {
-    auto _pFileIoAsyncOperation = RefPtr<FileIoAsyncOperation>::Create(_pCancellationToken);
+    auto _pFileIoAsyncOperation = RefPtr<FileIoAsyncOperation>::CreateFromPool(_pCancellationToken);
     _pFileIoAsyncOperation->Offset = (uint32_t)_uOffset;
     _pFileIoAsyncOperation->OffsetHigh = (uint32_t)(_uOffset >> 32);
 
@@ -110,7 +110,7 @@ Task<uint32_t>__YYAPI AsyncFile::ReadAsync(uint64_t _uOffset, void* _pBuffer, ui
 
 Task<uint32_t>__YYAPI AsyncFile::WriteAsync(uint64_t _uOffset, const void* _pBuffer, uint32_t _cbBufferToWrite, YY::RefPtr<CancellationToken> _pCancellationToken) noexcept
 {
-    auto _pFileIoAsyncOperation = RefPtr<FileIoAsyncOperation>::Create(_pCancellationToken);
+    auto _pFileIoAsyncOperation = RefPtr<FileIoAsyncOperation>::CreateFromPool(_pCancellationToken);
     _pFileIoAsyncOperation->Offset = (uint32_t)_uOffset;
     _pFileIoAsyncOperation->OffsetHigh = (uint32_t)(_uOffset >> 32);
 
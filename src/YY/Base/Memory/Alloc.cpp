@@ -0,0 +1,43 @@
+﻿#include <YY/Base/Memory/Alloc.h>
+
+#if YY_MEMORY_USE_THREAD_CACHE
+#include <YY/Base/Memory/ThreadCacheAllocator.h>
+
+__YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Memory
+        {
+            // 未开启 YY_MEMORY_USE_THREAD_CACHE 时这些函数在 Alloc.h 中内联转发到 CRT 堆，不需要额外的函数调用。
+
+            void* __YYAPI Alloc(size_t _cbSize)
+            {
+                return ThreadCacheAllocator::Alloc(_cbSize);
+            }
+
+            void* __YYAPI AllocAndZero(size_t _cbSize)
+            {
+                return ThreadCacheAllocator::AllocAndZero(_cbSize);
+            }
+
+            void* __YYAPI ReAlloc(void* _pBlock, size_t _cbSize)
+            {
+                return ThreadCacheAllocator::ReAlloc(_pBlock, _cbSize);
+            }
+
+            void* __YYAPI ReAllocAndZero(void* _pBlock, size_t _cbSize)
+            {
+                return ThreadCacheAllocator::ReAllocAndZero(_pBlock, _cbSize);
+            }
+
+            void __YYAPI Free(void* _pBlock)
+            {
+                ThreadCacheAllocator::Free(_pBlock);
+            }
+        } // namespace Memory
+    } // namespace Base
+} // namespace YY
+#endif
@@ -0,0 +1,454 @@
+﻿#include <YY/Base/Memory/ThreadCacheAllocator.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <YY/Base/Sync/Interlocked.h>
+#include <YY/Base/Sync/SRWLock.h>
+#include <YY/Base/Sync/AutoLock.h>
+#include <YY/Base/Utils/SystemInfo.h>
+
+__YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Memory
+        {
+            namespace
+            {
+                // 每个块前面的头信息，对用户指针保持 16 字节对齐。
+                struct BlockHeader
+                {
+                    // 块实际可用的大小
+                    size_t cbSize;
+                    uint32_t uSizeClass;
+                    uint32_t uMagic;
+                };
+
+                constexpr size_t kHeaderSize = (sizeof(BlockHeader) + 15) & ~size_t(15);
+                constexpr uint32_t kBlockMagic = 0x414D5959u;
+                constexpr size_t kLargeSizeClass = ThreadCacheAllocator::kSizeClassCount;
+                // 每个级别中心缓存最多保留的批次数，超过后直接还给 CRT 堆。
+                constexpr uint32_t kMaxCentralBatchCount = 64;
+                // 中心缓存按 NUMA 节点区分，更多的节点按编号取余共用中心缓存。
+                constexpr uint32_t kMaxNumaNodeCount = 8;
+
+                struct FreeNode
+                {
+                    FreeNode* pNext;
+                };
+
+                struct FreeBatch
+                {
+                    FreeNode* pFirst = nullptr;
+                    uint32_t cCount = 0;
+                };
+
+                struct CentralCache
+                {
+                    Sync::SRWLock oLock;
+                    FreeBatch arrBatches[kMaxCentralBatchCount];
+                    uint32_t cBatches = 0;
+                };
+
+                struct ThreadCache
+                {
+                    struct FreeList
+                    {
+                        FreeNode* pFirst = nullptr;
+                        uint32_t cCount = 0;
+                    };
+
+                    FreeList arrFreeLists[ThreadCacheAllocator::kSizeClassCount];
+
+                    // 线程首次使用分配器（或者最近一次 RefreshCurrentThreadNumaNode）时所在的 NUMA 节点，批次只与该节点的中心缓存交换。
+                    // 块的物理内存通常由申请它的线程首次访问，因此跨节点交换会让其他节点的线程拿到远端内存。
+                    uint32_t uNumaNode = 0;
+
+                    // 统计数据只由所属线程修改，其他线程汇总时仅做读取。
+                    volatile size_t uAllocCount = 0;
+                    volatile size_t uFreeCount = 0;
+                    volatile size_t uCacheHitCount = 0;
+                    volatile size_t uCentralFetchCount = 0;
+                    volatile size_t uCentralReleaseCount = 0;
+                    volatile size_t uHeapReleaseCount = 0;
+                    volatile size_t cbCached = 0;
+                    volatile size_t uAllocCountBySizeClass[ThreadCacheAllocator::kSizeClassCount] = {};
+
+                    ThreadCache* pPrior = nullptr;
+                    ThreadCache* pNext = nullptr;
+
+                    ThreadCache() noexcept;
+
+                    ThreadCache(const ThreadCache&) = delete;
+                    ThreadCache& operator=(const ThreadCache&) = delete;
+
+                    ~ThreadCache();
+
+                    void __YYAPI Flush() noexcept;
+                };
+
+                CentralCache g_arrCentralCaches[kMaxNumaNodeCount][ThreadCacheAllocator::kSizeClassCount];
+                volatile size_t g_cbCentralCached = 0;
+                volatile size_t g_uLargeAllocCount = 0;
+
+                // 保护所有线程缓存组成的链表以及已退出线程的统计数据。
+                Sync::SRWLock g_oThreadCacheListLock;
+                ThreadCache* g_pFirstThreadCache = nullptr;
+                ThreadCacheAllocator::Statistics g_oRetiredStatistics = {};
+
+                thread_local ThreadCache* g_pCurrentThreadCache = nullptr;
+                thread_local bool g_bThreadCacheDestroyed = false;
+
+                inline void __YYAPI IncreaseCounter(volatile size_t& _uCounter, size_t _uValue = 1) noexcept
+                {
+                    _uCounter = _uCounter + _uValue;
+                }
+
+                inline BlockHeader* __YYAPI GetBlockHeader(_In_ const void* _pBlock) noexcept
+                {
+                    return (BlockHeader*)((byte_t*)_pBlock - kHeaderSize);
+                }
+
+                inline void* __YYAPI GetUserBlock(_In_ BlockHeader* _pHeader) noexcept
+                {
+                    return (byte_t*)_pHeader + kHeaderSize;
+                }
+
+                ThreadCache* __YYAPI GetThreadCache() noexcept
+                {
+                    if (g_pCurrentThreadCache)
+                        return g_pCurrentThreadCache;
+
+                    // 线程退出过程中，其他 thread_local 对象的析构函数可能依然会申请、释放内存。
+                    if (g_bThreadCacheDestroyed)
+                        return nullptr;
+
+                    static thread_local ThreadCache s_oThreadCache;
+                    return &s_oThreadCache;
+                }
+
+                _Ret_maybenull_ void* __YYAPI AllocFromHeap(_In_ size_t _uSizeClass, _In_ size_t _cbSize) noexcept
+                {
+                    if (_cbSize > SIZE_MAX - kHeaderSize)
+                        return nullptr;
+
+                    auto _pHeader = (BlockHeader*)malloc(kHeaderSize + _cbSize);
+                    if (!_pHeader)
+                        return nullptr;
+
+                    _pHeader->cbSize = _cbSize;
+                    _pHeader->uSizeClass = uint32_t(_uSizeClass);
+                    _pHeader->uMagic = kBlockMagic;
+                    return GetUserBlock(_pHeader);
+                }
+
+                void __YYAPI FreeChainToHeap(_In_opt_ FreeNode* _pFirst) noexcept
+                {
+                    while (_pFirst)
+                    {
+                        auto _pNext = _pFirst->pNext;
+                        free(GetBlockHeader(_pFirst));
+                        _pFirst = _pNext;
+                    }
+                }
+
+                bool __YYAPI FetchFromCentral(_In_ ThreadCache* _pThreadCache, _In_ size_t _uSizeClass) noexcept
+                {
+                    auto& _oCentralCache = g_arrCentralCaches[_pThreadCache->uNumaNode][_uSizeClass];
+                    FreeBatch _oBatch;
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oAutoLock(_oCentralCache.oLock);
+                        if (_oCentralCache.cBatches == 0)
+                            return false;
+
+                        _oBatch = _oCentralCache.arrBatches[--_oCentralCache.cBatches];
+                    }
+
+                    const auto _cbBatch = _oBatch.cCount * ThreadCacheAllocator::GetSizeClassSize(_uSizeClass);
+                    Sync::Subtract(&g_cbCentralCached, _cbBatch);
+
+                    auto& _oFreeList = _pThreadCache->arrFreeLists[_uSizeClass];
+                    _oFreeList.pFirst = _oBatch.pFirst;
+                    _oFreeList.cCount = _oBatch.cCount;
+                    IncreaseCounter(_pThreadCache->cbCached, _cbBatch);
+                    IncreaseCounter(_pThreadCache->uCentralFetchCount);
+                    return true;
+                }
+
+                void __YYAPI ReleaseToCentral(_In_ ThreadCache* _pThreadCache, _In_ size_t _uSizeClass, _In_ uint32_t _cCount) noexcept
+                {
+                    auto& _oFreeList = _pThreadCache->arrFreeLists[_uSizeClass];
+                    if (_cCount == 0 || _oFreeList.cCount < _cCount)
+                        return;
+
+                    // 从链表头部摘下 _cCount 个块作为一批
+                    FreeBatch _oBatch;
+                    _oBatch.pFirst = _oFreeList.pFirst;
+                    _oBatch.cCount = _cCount;
+
+                    auto _pLast = _oBatch.pFirst;
+                    for (uint32_t _uIndex = 1; _uIndex != _cCount; ++_uIndex)
+                    {
+                        _pLast = _pLast->pNext;
+                    }
+                    _oFreeList.pFirst = _pLast->pNext;
+                    _oFreeList.cCount -= _cCount;
+                    _pLast->pNext = nullptr;
+
+                    const auto _cbBatch = _cCount * ThreadCacheAllocator::GetSizeClassSize(_uSizeClass);
+                    IncreaseCounter(_pThreadCache->cbCached, 0 - _cbBatch);
+
+                    auto& _oCentralCache = g_arrCentralCaches[_pThreadCache->uNumaNode][_uSizeClass];
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oAutoLock(_oCentralCache.oLock);
+                        if (_oCentralCache.cBatches != kMaxCentralBatchCount)
+                        {
+                            _oCentralCache.arrBatches[_oCentralCache.cBatches++] = _oBatch;
+                            _oBatch.pFirst = nullptr;
+                        }
+                    }
+
+                    if (_oBatch.pFirst)
+                    {
+                        IncreaseCounter(_pThreadCache->uHeapReleaseCount);
+                        FreeChainToHeap(_oBatch.pFirst);
+                    }
+                    else
+                    {
+                        IncreaseCounter(_pThreadCache->uCentralReleaseCount);
+                        Sync::Add(&g_cbCentralCached, _cbBatch);
+                    }
+                }
+
+                void __YYAPI AccumulateStatistics(_Inout_ ThreadCacheAllocator::Statistics* _pStatistics, _In_ const ThreadCache* _pThreadCache) noexcept
+                {
+                    _pStatistics->uAllocCount += _pThreadCache->uAllocCount;
+                    _pStatistics->uFreeCount += _pThreadCache->uFreeCount;
+                    _pStatistics->uCacheHitCount += _pThreadCache->uCacheHitCount;
+                    _pStatistics->uCentralFetchCount += _pThreadCache->uCentralFetchCount;
+                    _pStatistics->uCentralReleaseCount += _pThreadCache->uCentralReleaseCount;
+                    _pStatistics->uHeapReleaseCount += _pThreadCache->uHeapReleaseCount;
+                    for (size_t _uSizeClass = 0; _uSizeClass != ThreadCacheAllocator::kSizeClassCount; ++_uSizeClass)
+                    {
+                        _pStatistics->uAllocCountBySizeClass[_uSizeClass] += _pThreadCache->uAllocCountBySizeClass[_uSizeClass];
+                    }
+                }
+
+                ThreadCache::ThreadCache() noexcept
+                    : uNumaNode(Utils::GetCurrentNumaNode() % kMaxNumaNodeCount)
+                {
+                    Sync::AutoLock<Sync::SRWLock> _oAutoLock(g_oThreadCacheListLock);
+                    pNext = g_pFirstThreadCache;
+                    if (pNext)
+                        pNext->pPrior = this;
+                    g_pFirstThreadCache = this;
+
+                    g_pCurrentThreadCache = this;
+                }
+
+                ThreadCache::~ThreadCache()
+                {
+                    g_pCurrentThreadCache = nullptr;
+                    g_bThreadCacheDestroyed = true;
+
+                    Flush();
+
+                    Sync::AutoLock<Sync::SRWLock> _oAutoLock(g_oThreadCacheListLock);
+                    AccumulateStatistics(&g_oRetiredStatistics, this);
+
+                    if (pPrior)
+                        pPrior->pNext = pNext;
+                    else
+                        g_pFirstThreadCache = pNext;
+
+                    if (pNext)
+                        pNext->pPrior = pPrior;
+                }
+
+                void __YYAPI ThreadCache::Flush() noexcept
+                {
+                    for (size_t _uSizeClass = 0; _uSizeClass != ThreadCacheAllocator::kSizeClassCount; ++_uSizeClass)
+                    {
+                        const auto _cBatchCount = ThreadCacheAllocator::GetBatchCount(_uSizeClass);
+                        auto& _oFreeList = arrFreeLists[_uSizeClass];
+                        while (_oFreeList.cCount)
+                        {
+                            ReleaseToCentral(this, _uSizeClass, _oFreeList.cCount < _cBatchCount ? _oFreeList.cCount : _cBatchCount);
+                        }
+                    }
+                }
+            }
+
+            void* __YYAPI ThreadCacheAllocator::Alloc(size_t _cbSize) noexcept
+            {
+                const auto _uSizeClass = GetSizeClass(_cbSize);
+                if (_uSizeClass == kLargeSizeClass)
+                {
+                    Sync::Increment(&g_uLargeAllocCount);
+                    return AllocFromHeap(kLargeSizeClass, _cbSize);
+                }
+
+                auto _pThreadCache = GetThreadCache();
+                if (!_pThreadCache)
+                    return AllocFromHeap(_uSizeClass, GetSizeClassSize(_uSizeClass));
+
+                IncreaseCounter(_pThreadCache->uAllocCount);
+                IncreaseCounter(_pThreadCache->uAllocCountBySizeClass[_uSizeClass]);
+
+                auto& _oFreeList = _pThreadCache->arrFreeLists[_uSizeClass];
+                if (_oFreeList.pFirst)
+                {
+                    IncreaseCounter(_pThreadCache->uCacheHitCount);
+                }
+                else if (!FetchFromCentral(_pThreadCache, _uSizeClass))
+                {
+                    return AllocFromHeap(_uSizeClass, GetSizeClassSize(_uSizeClass));
+                }
+
+                auto _pNode = _oFreeList.pFirst;
+                _oFreeList.pFirst = _pNode->pNext;
+                --_oFreeList.cCount;
+                IncreaseCounter(_pThreadCache->cbCached, 0 - GetSizeClassSize(_uSizeClass));
+                return _pNode;
+            }
+
+            void* __YYAPI ThreadCacheAllocator::AllocAndZero(size_t _cbSize) noexcept
+            {
+                auto _pBlock = Alloc(_cbSize);
+                if (_pBlock)
+                    memset(_pBlock, 0, GetBlockSize(_pBlock));
+
+                return _pBlock;
+            }
+
+            void* __YYAPI ThreadCacheAllocator::ReAlloc(void* _pBlock, size_t _cbSize) noexcept
+            {
+                if (!_pBlock)
+                    return Alloc(_cbSize);
+
+                auto _pHeader = GetBlockHeader(_pBlock);
+                if (_pHeader->uSizeClass == kLargeSizeClass)
+                {
+                    // 大块内存交给 CRT 尝试原地扩展
+                    if (GetSizeClass(_cbSize) == kLargeSizeClass)
+                    {
+                        auto _pNewHeader = (BlockHeader*)realloc(_pHeader, kHeaderSize + _cbSize);
+                        if (!_pNewHeader)
+                            return nullptr;
+
+                        _pNewHeader->cbSize = _cbSize;
+                        return GetUserBlock(_pNewHeader);
+                    }
+                }
+                else if (GetSizeClass(_cbSize) == _pHeader->uSizeClass)
+                {
+                    return _pBlock;
+                }
+
+                auto _pNewBlock = Alloc(_cbSize);
+                if (!_pNewBlock)
+                    return nullptr;
+
+                memcpy(_pNewBlock, _pBlock, _pHeader->cbSize < _cbSize ? _pHeader->cbSize : _cbSize);
+                Free(_pBlock);
+                return _pNewBlock;
+            }
+
+            void* __YYAPI ThreadCacheAllocator::ReAllocAndZero(void* _pBlock, size_t _cbSize) noexcept
+            {
+                const auto _cbOldSize = _pBlock ? GetBlockSize(_pBlock) : 0;
+                auto _pNewBlock = ReAlloc(_pBlock, _cbSize);
+                if (!_pNewBlock)
+                    return nullptr;
+
+                const auto _cbNewSize = GetBlockSize(_pNewBlock);
+                if (_cbNewSize > _cbOldSize)
+                    memset((byte_t*)_pNewBlock + _cbOldSize, 0, _cbNewSize - _cbOldSize);
+
+                return _pNewBlock;
+            }
+
+            void __YYAPI ThreadCacheAllocator::Free(void* _pBlock) noexcept
+            {
+                if (!_pBlock)
+                    return;
+
+                auto _pHeader = GetBlockHeader(_pBlock);
+                const size_t _uSizeClass = _pHeader->uSizeClass;
+                if (_uSizeClass == kLargeSizeClass)
+                {
+                    free(_pHeader);
+                    return;
+                }
+
+                auto _pThreadCache = GetThreadCache();
+                if (!_pThreadCache)
+                {
+                    free(_pHeader);
+                    return;
+                }
+
+                IncreaseCounter(_pThreadCache->uFreeCount);
+                IncreaseCounter(_pThreadCache->cbCached, GetSizeClassSize(_uSizeClass));
+
+                // 保留一批给后续申请使用，多出来的一批交给中心缓存，其他线程可以整批取走。
+                // 先把已有的一批交给中心缓存，再把刚释放的块放在链表头部，下次申请时依然在 CPU 缓存中。
+                auto& _oFreeList = _pThreadCache->arrFreeLists[_uSizeClass];
+                const auto _cBatchCount = GetBatchCount(_uSizeClass);
+                if (_oFreeList.cCount + 1 >= _cBatchCount * 2)
+                {
+                    ReleaseToCentral(_pThreadCache, _uSizeClass, _cBatchCount);
+                }
+
+                auto _pNode = (FreeNode*)_pBlock;
+                _pNode->pNext = _oFreeList.pFirst;
+                _oFreeList.pFirst = _pNode;
+                ++_oFreeList.cCount;
+            }
+
+            size_t __YYAPI ThreadCacheAllocator::GetBlockSize(const void* _pBlock) noexcept
+            {
+                return GetBlockHeader(_pBlock)->cbSize;
+            }
+
+            void __YYAPI ThreadCacheAllocator::FlushCurrentThreadCache() noexcept
+            {
+                if (g_pCurrentThreadCache)
+                    g_pCurrentThreadCache->Flush();
+            }
+
+            void __YYAPI ThreadCacheAllocator::RefreshCurrentThreadNumaNode() noexcept
+            {
+                // 还没有线程缓存时，首次申请内存会读取当时所在的节点
+                auto _pThreadCache = g_pCurrentThreadCache;
+                if (!_pThreadCache)
+                    return;
+
+                const auto _uNumaNode = Utils::GetCurrentNumaNode() % kMaxNumaNodeCount;
+                if (_pThreadCache->uNumaNode == _uNumaNode)
+                    return;
+
+                // 已缓存的块来自原节点，先还给原节点的中心缓存
+                _pThreadCache->Flush();
+                _pThreadCache->uNumaNode = _uNumaNode;
+            }
+
+            void __YYAPI ThreadCacheAllocator::GetStatistics(Statistics* _pStatistics) noexcept
+            {
+                Sync::AutoLock<Sync::SRWLock> _oAutoLock(g_oThreadCacheListLock);
+                *_pStatistics = g_oRetiredStatistics;
+                _pStatistics->uLargeAllocCount = g_uLargeAllocCount;
+                _pStatistics->cbCached = g_cbCentralCached;
+
+                for (auto _pThreadCache = g_pFirstThreadCache; _pThreadCache; _pThreadCache = _pThreadCache->pNext)
+                {
+                    AccumulateStatistics(_pStatistics, _pThreadCache);
+                    _pStatistics->cbCached += _pThreadCache->cbCached;
+                }
+            }
+        } // namespace Memory
+    } // namespace Base
+} // namespace YY
@@ -0,0 +1,293 @@
+﻿#include <YY/Base/Sync/Epoch.h>
+
+#include <stdlib.h>
+#include <thread>
+
+#include <YY/Base/Sync/Interlocked.h>
+
+__YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Sync
+        {
+            namespace
+            {
+                constexpr uint32_t kRetireBlockSize = 64;
+                constexpr uintptr_t kEpochMask = uintptr_t(-1) >> 1;
+
+                struct RetiredObject
+                {
+                    void* pObject;
+                    Epoch::RetireCallback pfnRetire;
+                };
+
+                struct RetireBlock
+                {
+                    RetireBlock* pNext;
+                    // 块内最后一个对象退休时的全局纪元
+                    uintptr_t uEpoch;
+                    uint32_t cCount;
+                    RetiredObject arrObjects[kRetireBlockSize];
+                };
+
+                struct Participant
+                {
+                    // 最低位表示是否处于临界区，其余位是进入临界区时观察到的全局纪元
+                    volatile uintptr_t uState = 0;
+                    // 线程退出后 Participant 不会释放，而是留给新线程复用
+                    volatile uint32_t bInUse = 1;
+                    uint32_t uNestCount = 0;
+                    // 按退休先后排列，pLastBlock 是正在写入的块
+                    RetireBlock* pFirstBlock = nullptr;
+                    RetireBlock* pLastBlock = nullptr;
+                    // 所有 Participant 组成的链表，只增不减，因此遍历时不需要任何同步
+                    Participant* pNext = nullptr;
+                };
+
+                volatile uintptr_t g_uGlobalEpoch = 0;
+                Participant* g_pFirstParticipant = nullptr;
+                // 已经退出的线程尚未回收的块
+                RetireBlock* g_pOrphanBlocks = nullptr;
+
+                thread_local Participant* g_pCurrentParticipant = nullptr;
+
+                struct ParticipantCleanup
+                {
+                    ~ParticipantCleanup();
+                };
+
+                inline bool __YYAPI IsSafeToRelease(_In_ const RetireBlock* _pBlock, _In_ uintptr_t _uGlobalEpoch) noexcept
+                {
+                    return _uGlobalEpoch - _pBlock->uEpoch >= 2;
+                }
+
+                void __YYAPI ReleaseBlock(_In_ RetireBlock* _pBlock) noexcept
+                {
+                    for (uint32_t _uIndex = 0; _uIndex != _pBlock->cCount; ++_uIndex)
+                    {
+                        auto& _oRetiredObject = _pBlock->arrObjects[_uIndex];
+                        _oRetiredObject.pfnRetire(_oRetiredObject.pObject);
+                    }
+
+                    Memory::Free(_pBlock);
+                }
+
+                void __YYAPI PushOrphanBlocks(_In_ RetireBlock* _pFirstBlock, _In_ RetireBlock* _pLastBlock) noexcept
+                {
+                    auto _pHead = g_pOrphanBlocks;
+                    for (;;)
+                    {
+                        _pLastBlock->pNext = _pHead;
+                        auto _pLast = CompareExchangePoint(&g_pOrphanBlocks, _pFirstBlock, _pHead);
+                        if (_pLast == _pHead)
+                            break;
+
+                        _pHead = _pLast;
+                    }
+                }
+
+                _Ret_notnull_ Participant* __YYAPI GetParticipant() noexcept
+                {
+                    if (g_pCurrentParticipant)
+                        return g_pCurrentParticipant;
+
+                    Participant* _pParticipant = nullptr;
+                    for (auto _pItem = g_pFirstParticipant; _pItem; _pItem = _pItem->pNext)
+                    {
+                        if (_pItem->bInUse == 0 && CompareExchange(&_pItem->bInUse, 1u, 0u) == 0)
+                        {
+                            _pParticipant = _pItem;
+                            break;
+                        }
+                    }
+
+                    if (!_pParticipant)
+                    {
+                        _pParticipant = Memory::New<Participant>();
+                        if (!_pParticipant)
+                            abort();
+
+                        auto _pHead = g_pFirstParticipant;
+                        for (;;)
+                        {
+                            _pParticipant->pNext = _pHead;
+                            auto _pLast = CompareExchangePoint(&g_pFirstParticipant, _pParticipant, _pHead);
+                            if (_pLast == _pHead)
+                                break;
+
+                            _pHead = _pLast;
+                        }
+                    }
+
+                    g_pCurrentParticipant = _pParticipant;
+
+                    // 线程退出时归还 Participant。
+                    // 如果线程在清理之后再次使用 Epoch，该 Participant 将一直保持占用，但依然可以正常工作。
+                    static thread_local ParticipantCleanup s_oParticipantCleanup;
+                    (void)s_oParticipantCleanup;
+
+                    return _pParticipant;
+                }
+
+                ParticipantCleanup::~ParticipantCleanup()
+                {
+                    auto _pParticipant = g_pCurrentParticipant;
+                    if (!_pParticipant)
+                        return;
+
+                    Epoch::Collect();
+
+                    // 剩余的对象交给其他线程回收
+                    if (_pParticipant->pFirstBlock)
+                    {
+                        PushOrphanBlocks(_pParticipant->pFirstBlock, _pParticipant->pLastBlock);
+                        _pParticipant->pFirstBlock = nullptr;
+                        _pParticipant->pLastBlock = nullptr;
+                    }
+
+                    g_pCurrentParticipant = nullptr;
+                    _pParticipant->uNestCount = 0;
+                    Exchange(&_pParticipant->uState, uintptr_t(0));
+                    Exchange(&_pParticipant->bInUse, 0u);
+                }
+
+                void __YYAPI TryAdvanceEpoch() noexcept
+                {
+                    const uintptr_t _uGlobalEpoch = g_uGlobalEpoch;
+                    for (auto _pParticipant = g_pFirstParticipant; _pParticipant; _pParticipant = _pParticipant->pNext)
+                    {
+                        const uintptr_t _uState = _pParticipant->uState;
+                        if ((_uState & 1) && (_uState >> 1) != (_uGlobalEpoch & kEpochMask))
+                            return;
+                    }
+
+                    CompareExchange(&g_uGlobalEpoch, _uGlobalEpoch + 1, _uGlobalEpoch);
+                }
+            }
+
+            void __YYAPI Epoch::Enter() noexcept
+            {
+                auto _pParticipant = GetParticipant();
+                if (_pParticipant->uNestCount++ == 0)
+                {
+                    // 需要完整的内存屏障，保证后续对共享结构的读取发生在发布纪元之后
+                    Exchange(&_pParticipant->uState, uintptr_t((g_uGlobalEpoch << 1) | 1));
+                }
+            }
+
+            void __YYAPI Epoch::Leave() noexcept
+            {
+                auto _pParticipant = g_pCurrentParticipant;
+                if (!_pParticipant || _pParticipant->uNestCount == 0)
+                    abort();
+
+                if (--_pParticipant->uNestCount == 0)
+                {
+                    Exchange(&_pParticipant->uState, uintptr_t(_pParticipant->uState & ~uintptr_t(1)));
+                }
+            }
+
+            bool __YYAPI Epoch::IsEntered() noexcept
+            {
+                auto _pParticipant = g_pCurrentParticipant;
+                return _pParticipant && _pParticipant->uNestCount;
+            }
+
+            void __YYAPI Epoch::Retire(void* _pObject, RetireCallback _pfnRetire) noexcept
+            {
+                auto _pParticipant = GetParticipant();
+                auto _pBlock = _pParticipant->pLastBlock;
+                if (!_pBlock || _pBlock->cCount == kRetireBlockSize)
+                {
+                    _pBlock = (RetireBlock*)Memory::Alloc(sizeof(RetireBlock));
+                    if (!_pBlock)
+                        abort();
+
+                    _pBlock->pNext = nullptr;
+                    _pBlock->cCount = 0;
+
+                    if (_pParticipant->pLastBlock)
+                        _pParticipant->pLastBlock->pNext = _pBlock;
+                    else
+                        _pParticipant->pFirstBlock = _pBlock;
+
+                    _pParticipant->pLastBlock = _pBlock;
+                }
+
+                auto& _oRetiredObject = _pBlock->arrObjects[_pBlock->cCount++];
+                _oRetiredObject.pObject = _pObject;
+                _oRetiredObject.pfnRetire = _pfnRetire;
+                _pBlock->uEpoch = g_uGlobalEpoch;
+
+                // 每写满一块尝试回收一次
+                if (_pBlock->cCount == kRetireBlockSize)
+                    Collect();
+            }
+
+            void __YYAPI Epoch::Collect() noexcept
+            {
+                TryAdvanceEpoch();
+                const uintptr_t _uGlobalEpoch = g_uGlobalEpoch;
+
+                if (auto _pParticipant = g_pCurrentParticipant)
+                {
+                    while (_pParticipant->pFirstBlock && IsSafeToRelease(_pParticipant->pFirstBlock, _uGlobalEpoch))
+                    {
+                        auto _pBlock = _pParticipant->pFirstBlock;
+                        _pParticipant->pFirstBlock = _pBlock->pNext;
+                        if (_pParticipant->pFirstBlock == nullptr)
+                            _pParticipant->pLastBlock = nullptr;
+
+                        ReleaseBlock(_pBlock);
+                    }
+                }
+
+                if (g_pOrphanBlocks)
+                {
+                    RetireBlock* _pFirstPending = nullptr;
+                    RetireBlock* _pLastPending = nullptr;
+                    for (auto _pBlock = ExchangePoint(&g_pOrphanBlocks, nullptr); _pBlock;)
+                    {
+                        auto _pNext = _pBlock->pNext;
+                        if (IsSafeToRelease(_pBlock, _uGlobalEpoch))
+                        {
+                            ReleaseBlock(_pBlock);
+                        }
+                        else
+                        {
+                            _pBlock->pNext = _pFirstPending;
+                            _pFirstPending = _pBlock;
+                            if (!_pLastPending)
+                                _pLastPending = _pBlock;
+                        }
+                        _pBlock = _pNext;
+                    }
+
+                    if (_pFirstPending)
+                        PushOrphanBlocks(_pFirstPending, _pLastPending);
+                }
+            }
+
+            void __YYAPI Epoch::Synchronize() noexcept
+            {
+                auto _pParticipant = GetParticipant();
+                for (;;)
+                {
+                    Collect();
+                    if (_pParticipant->pFirstBlock == nullptr && g_pOrphanBlocks == nullptr)
+                        break;
+
+                    std::this_thread::yield();
+                }
+            }
+
+            uintptr_t __YYAPI Epoch::GetGlobalEpoch() noexcept
+            {
+                return g_uGlobalEpoch;
+            }
+        } // namespace Sync
+    } // namespace Base
+} // namespace YY
@@ -0,0 +1,231 @@
+﻿#include <YY/Base/Threading/AsyncLock.h>
+
+#include <YY/Base/Sync/AutoLock.h>
+#include <YY/Base/Sync/Interlocked.h>
+
+__YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            namespace
+            {
+                Task<void> __YYAPI CreateWaiter(_Inout_ SingleLinkedList<AsyncLockWaiter>& _oWaiters, bool _bShared)
+                {
+                    auto _pWaiter = YY::RefPtr<AsyncLockWaiter>::CreateFromPool();
+                    if (!_pWaiter)
+                    {
+                        auto _pAsyncOperation = YY::RefPtr<AsyncOperationImpl<void>>::Create();
+                        if (!_pAsyncOperation)
+                            throw Exception(E_OUTOFMEMORY);
+
+                        _pAsyncOperation->SetErrorCode(E_OUTOFMEMORY);
+                        return Task<void>(std::move(_pAsyncOperation));
+                    }
+
+                    _pWaiter->bShared = _bShared;
+                    _oWaiters.Push(YY::RefPtr<AsyncLockWaiter>(_pWaiter).Detach());
+                    return Task<void>(std::move(_pWaiter));
+                }
+
+                /// <summary>
+                /// 在锁外完成已经授予的等待者，等待者的协程可能在这里直接恢复。
+                /// </summary>
+                /// <returns>已经取消、无法接受授予的等待者个数。</returns>
+                uint32_t __YYAPI ResolveWaiters(_Inout_ SingleLinkedList<AsyncLockWaiter>& _oWaiters)
+                {
+                    uint32_t _cCanceled = 0;
+                    while (auto _pWaiter = _oWaiters.Pop())
+                    {
+                        if (!YY::RefPtr<AsyncLockWaiter>::FromPtr(_pWaiter)->Resolve())
+                            ++_cCanceled;
+                    }
+
+                    return _cCanceled;
+                }
+
+                void __YYAPI CancelWaiters(_Inout_ SingleLinkedList<AsyncLockWaiter>& _oWaiters)
+                {
+                    while (auto _pWaiter = _oWaiters.Pop())
+                    {
+                        YY::RefPtr<AsyncLockWaiter>::FromPtr(_pWaiter)->Cancel();
+                    }
+                }
+            }
+
+            AsyncSemaphore::~AsyncSemaphore()
+            {
+                CancelWaiters(oWaiters);
+            }
+
+            ValueTask<void> __YYAPI AsyncSemaphore::WaitAsync()
+            {
+                // 无竞争时返回已完成的 ValueTask，不申请内存
+                if (TryWait())
+                    return ValueTask<void>();
+
+                Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                // Release 只在锁内增加许可，因此这里再次检查后入队不会丢失唤醒
+                if (TryWait())
+                    return ValueTask<void>();
+
+                return CreateWaiter(oWaiters, false);
+            }
+
+            bool __YYAPI AsyncSemaphore::TryWait() noexcept
+            {
+                for (uint32_t _uCount = uCount; _uCount;)
+                {
+                    const auto _uLast = Sync::CompareExchange(&uCount, _uCount - 1, _uCount);
+                    if (_uLast == _uCount)
+                        return true;
+
+                    _uCount = _uLast;
+                }
+
+                return false;
+            }
+
+            void __YYAPI AsyncSemaphore::Release(uint32_t _uCount)
+            {
+                // 已经取消的等待者不会消耗许可，把它们的许可继续交给后面的等待者
+                while (_uCount)
+                {
+                    SingleLinkedList<AsyncLockWaiter> _oReadyWaiters;
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                        for (; _uCount && !oWaiters.IsEmpty(); --_uCount)
+                        {
+                            _oReadyWaiters.Push(oWaiters.Pop());
+                        }
+
+                        if (_uCount)
+                            Sync::Add(&uCount, _uCount);
+                    }
+
+                    _uCount = ResolveWaiters(_oReadyWaiters);
+                }
+            }
+
+            AsyncReaderWriterLock::~AsyncReaderWriterLock()
+            {
+                CancelWaiters(oWaiters);
+            }
+
+            ValueTask<void> __YYAPI AsyncReaderWriterLock::LockAsync()
+            {
+                return AcquireAsync(false);
+            }
+
+            bool __YYAPI AsyncReaderWriterLock::TryLock() noexcept
+            {
+                Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                if (bWriter || cReaders || !oWaiters.IsEmpty())
+                    return false;
+
+                bWriter = true;
+                return true;
+            }
+
+            void __YYAPI AsyncReaderWriterLock::Unlock()
+            {
+                Release(0, true);
+            }
+
+            ValueTask<void> __YYAPI AsyncReaderWriterLock::LockSharedAsync()
+            {
+                return AcquireAsync(true);
+            }
+
+            bool __YYAPI AsyncReaderWriterLock::TryLockShared() noexcept
+            {
+                Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                if (bWriter || !oWaiters.IsEmpty())
+                    return false;
+
+                ++cReaders;
+                return true;
+            }
+
+            void __YYAPI AsyncReaderWriterLock::UnlockShared()
+            {
+                Release(1, false);
+            }
+
+            ValueTask<void> __YYAPI AsyncReaderWriterLock::AcquireAsync(bool _bShared)
+            {
+                Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                if (oWaiters.IsEmpty() && !bWriter && (_bShared || cReaders == 0))
+                {
+                    if (_bShared)
+                        ++cReaders;
+                    else
+                        bWriter = true;
+
+                    return ValueTask<void>();
+                }
+
+                return CreateWaiter(oWaiters, _bShared);
+            }
+
+            void __YYAPI AsyncReaderWriterLock::Release(uint32_t _cReaders, bool _bWriter)
+            {
+                // 已经取消的等待者无法接受授予，归还它们得到的锁后继续授予后面的等待者
+                while (_cReaders || _bWriter)
+                {
+                    SingleLinkedList<AsyncLockWaiter> _oReadyWaiters;
+                    {
+                        Sync::AutoLock<Sync::SRWLock> _oLock(oLock);
+                        cReaders -= _cReaders;
+                        if (_bWriter)
+                            bWriter = false;
+
+                        GrantWaiters(_oReadyWaiters);
+                    }
+
+                    _cReaders = 0;
+                    _bWriter = false;
+                    while (auto _pWaiter = _oReadyWaiters.Pop())
+                    {
+                        auto _pReadyWaiter = YY::RefPtr<AsyncLockWaiter>::FromPtr(_pWaiter);
+                        if (_pReadyWaiter->Resolve())
+                            continue;
+
+                        if (_pReadyWaiter->bShared)
+                            ++_cReaders;
+                        else
+                            _bWriter = true;
+                    }
+                }
+            }
+
+            void __YYAPI AsyncReaderWriterLock::GrantWaiters(SingleLinkedList<AsyncLockWaiter>& _oReadyWaiters) noexcept
+            {
+                if (bWriter)
+                    return;
+
+                while (auto _pWaiter = oWaiters.GetFirst())
+                {
+                    if (_pWaiter->bShared)
+                    {
+                        ++cReaders;
+                    }
+                    else
+                    {
+                        if (cReaders)
+                            break;
+
+                        bWriter = true;
+                    }
+
+                    _oReadyWaiters.Push(oWaiters.Pop());
+                    if (bWriter)
+                        break;
+                }
+            }
+        } // namespace Threading
+    } // namespace Base
+} // namespace YY
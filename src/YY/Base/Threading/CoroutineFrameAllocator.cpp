@@ -0,0 +1,108 @@
+﻿#include <YY/Base/Threading/CoroutineFrameAllocator.h>
+
+#include <YY/Base/Memory/Alloc.h>
+
+__YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            namespace
+            {
+                struct FreeFrame
+                {
+                    FreeFrame* pNext;
+                };
+
+                // 平凡类型，线程退出清理之后依然可以安全访问
+                struct FrameCache
+                {
+                    FreeFrame* arrFreeLists[CoroutineFrameAllocator::kBucketCount];
+                    uint32_t arrCounts[CoroutineFrameAllocator::kBucketCount];
+                    bool bCleanupRegistered;
+                    bool bThreadExited;
+                };
+
+                struct FrameCacheCleanup
+                {
+                    ~FrameCacheCleanup();
+                };
+
+                thread_local FrameCache g_oFrameCache;
+
+                void __YYAPI RegisterCleanup() noexcept
+                {
+                    if (g_oFrameCache.bCleanupRegistered)
+                        return;
+
+                    g_oFrameCache.bCleanupRegistered = true;
+                    static thread_local FrameCacheCleanup s_oFrameCacheCleanup;
+                    (void)s_oFrameCacheCleanup;
+                }
+
+                FrameCacheCleanup::~FrameCacheCleanup()
+                {
+                    CoroutineFrameAllocator::FlushCurrentThreadCache();
+                    g_oFrameCache.bThreadExited = true;
+                }
+            }
+
+            void* __YYAPI CoroutineFrameAllocator::Alloc(size_t _cbSize) noexcept
+            {
+                if (_cbSize > kMaxFrameSize)
+                    return Memory::Alloc(_cbSize);
+
+                const auto _uBucket = GetBucket(_cbSize);
+                if (auto _pFrame = g_oFrameCache.arrFreeLists[_uBucket])
+                {
+                    g_oFrameCache.arrFreeLists[_uBucket] = _pFrame->pNext;
+                    --g_oFrameCache.arrCounts[_uBucket];
+                    return _pFrame;
+                }
+
+                // 按桶的上限申请，释放时才能放回同一个桶
+                return Memory::Alloc((_uBucket + 1) * kGranularity);
+            }
+
+            void __YYAPI CoroutineFrameAllocator::Free(void* _pFrame, size_t _cbSize) noexcept
+            {
+                if (!_pFrame)
+                    return;
+
+                if (_cbSize <= kMaxFrameSize && !g_oFrameCache.bThreadExited)
+                {
+                    const auto _uBucket = GetBucket(_cbSize);
+                    if (g_oFrameCache.arrCounts[_uBucket] < kMaxCachedFrames)
+                    {
+                        RegisterCleanup();
+
+                        auto _pFreeFrame = static_cast<FreeFrame*>(_pFrame);
+                        _pFreeFrame->pNext = g_oFrameCache.arrFreeLists[_uBucket];
+                        g_oFrameCache.arrFreeLists[_uBucket] = _pFreeFrame;
+                        ++g_oFrameCache.arrCounts[_uBucket];
+                        return;
+                    }
+                }
+
+                Memory::Free(_pFrame);
+            }
+
+            void __YYAPI CoroutineFrameAllocator::FlushCurrentThreadCache() noexcept
+            {
+                for (size_t _uBucket = 0; _uBucket != kBucketCount; ++_uBucket)
+                {
+                    while (auto _pFrame = g_oFrameCache.arrFreeLists[_uBucket])
+                    {
+                        g_oFrameCache.arrFreeLists[_uBucket] = _pFrame->pNext;
+                        Memory::Free(_pFrame);
+                    }
+
+                    g_oFrameCache.arrCounts[_uBucket] = 0;
+                }
+            }
+        } // namespace Threading
+    } // namespace Base
+} // namespace YY
@@ -0,0 +1,108 @@
+﻿#include <YY/Base/Threading/CoroutineTrampoline.h>
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+
+__YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            namespace
+            {
+                struct TrampolineState
+                {
+                    CoroutineTrampoline::Entry* pFirst;
+                    CoroutineTrampoline::Entry* pLast;
+                    // 正在结束的协程个数，此时的 Resume 只排队
+                    uint32_t cCompletions;
+                    bool bRunning;
+                };
+
+                thread_local TrampolineState g_oTrampolineState;
+            }
+
+            void __YYAPI CoroutineTrampoline::Resume(Entry* _pEntry) noexcept
+            {
+                auto& _oState = g_oTrampolineState;
+                _pEntry->pNext = nullptr;
+                if (_oState.bRunning && _oState.cCompletions)
+                {
+                    if (_oState.pLast)
+                        _oState.pLast->pNext = _pEntry;
+                    else
+                        _oState.pFirst = _pEntry;
+
+                    _oState.pLast = _pEntry;
+                    return;
+                }
+
+                // 作为新的最外层同步恢复，外层排队中的协程留给外层继续恢复
+                const auto _oOuterState = _oState;
+                _oState = TrampolineState{};
+                _oState.bRunning = true;
+                // 协程恢复后 Entry 可能已经随帧释放，因此先取出句柄
+                auto _hCoroutine = _pEntry->hCoroutine;
+                for (;;)
+                {
+                    _hCoroutine.resume();
+
+                    auto _pPending = _oState.pFirst;
+                    if (!_pPending)
+                        break;
+
+                    _oState.pFirst = _pPending->pNext;
+                    if (_oState.pFirst == nullptr)
+                        _oState.pLast = nullptr;
+
+                    _hCoroutine = _pPending->hCoroutine;
+                }
+
+                _oState = _oOuterState;
+            }
+
+            bool __YYAPI CoroutineTrampoline::IsRunning() noexcept
+            {
+                return g_oTrampolineState.bRunning;
+            }
+
+            CoroutineTrampoline::CompletionScope::CompletionScope() noexcept
+            {
+                ++g_oTrampolineState.cCompletions;
+            }
+
+            CoroutineTrampoline::CompletionScope::~CompletionScope()
+            {
+                --g_oTrampolineState.cCompletions;
+            }
+
+            CoroutineTrampoline::BlockingScope::BlockingScope() noexcept
+                : cCompletions(g_oTrampolineState.cCompletions)
+                , bRunning(g_oTrampolineState.bRunning)
+            {
+                auto& _oState = g_oTrampolineState;
+                auto _pPending = _oState.pFirst;
+                _oState = TrampolineState{};
+
+                while (_pPending)
+                {
+                    // Resume 会改写 pNext，并且恢复后 Entry 可能已经随帧释放
+                    auto _pNext = _pPending->pNext;
+                    Resume(_pPending);
+                    _pPending = _pNext;
+                }
+            }
+
+            CoroutineTrampoline::BlockingScope::~BlockingScope()
+            {
+                // 作用域内的 Resume 都作为最外层执行完毕，队列一定为空
+                g_oTrampolineState.cCompletions = cCompletions;
+                g_oTrampolineState.bRunning = bRunning;
+            }
+        } // namespace Threading
+    } // namespace Base
+} // namespace YY
+
+#endif
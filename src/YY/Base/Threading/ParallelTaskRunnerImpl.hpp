@@ -1,10 +1,12 @@
 ﻿#pragma once
 
+#include <YY/Base/Memory/ThreadCacheAllocator.h>
 #include <YY/Base/Sync/InterlockedQueue.h>
-#include <YY/Base/Memory/UniquePtr.h>
 #include <YY/Base/Sync/Sync.h>
+#include <YY/Base/Utils/SystemInfo.h>
 
 #include "TaskRunnerImpl.h"
+#include "TaskPriorityQueue.h"
 
 #pragma pack(push, __YY_PACKING)
 
@@ -14,122 +16,15 @@ namespace YY
     {
         namespace Threading
         {
-            inline uint32_t __YYAPI BitsCount32(uint32_t _fBitMask)
-            {
-                _fBitMask = (_fBitMask & 0x55555555) + ((_fBitMask >> 1) & 0x55555555);
-                _fBitMask = (_fBitMask & 0x33333333) + ((_fBitMask >> 2) & 0x33333333);
-                _fBitMask = (_fBitMask & 0x0f0f0f0f) + ((_fBitMask >> 4) & 0x0f0f0f0f);
-                _fBitMask = (_fBitMask & 0x00ff00ff) + ((_fBitMask >> 8) & 0x00ff00ff);
-                _fBitMask = (_fBitMask & 0x0000ffff) + ((_fBitMask >> 16) & 0x0000ffff);
-                return _fBitMask;
-            }
-
-            inline uint32_t __YYAPI BitsCount64(uint64_t _fBitMask)
-            {
-                _fBitMask = (_fBitMask & 0x55555555'55555555) + ((_fBitMask >> 1) & 0x55555555'55555555);
-                _fBitMask = (_fBitMask & 0x33333333'33333333) + ((_fBitMask >> 2) & 0x33333333'33333333);
-                _fBitMask = (_fBitMask & 0x0f0f0f0f'0f0f0f0f) + ((_fBitMask >> 4) & 0x0f0f0f0f'0f0f0f0f);
-                _fBitMask = (_fBitMask & 0x00ff00ff'00ff00ff) + ((_fBitMask >> 8) & 0x00ff00ff'00ff00ff);
-                _fBitMask = (_fBitMask & 0x0000ffff'0000ffff) + ((_fBitMask >> 16) & 0x0000ffff'0000ffff);
-                _fBitMask = (_fBitMask & 0x00000000'ffffffff) + ((_fBitMask >> 32) & 0x00000000'ffffffff);
-                return static_cast<uint32_t>(_fBitMask);
-            }
-
-#ifdef _WIN32
-#ifdef _X86_
-#define BitsCount32(_fBitMask) static_cast<uint32_t>(__popcnt(_fBitMask))
-#elif defined(_AMD64_)
-#define BitsCount64(_fBitMask) static_cast<uint32_t>(__popcnt64(_fBitMask))
-#endif
-#endif
-
-            inline uint32_t __YYAPI BitsCount(uint32_t _fBitMask)
-            {
-                return BitsCount32(_fBitMask);
-            }
-
-            inline uint32_t __YYAPI BitsCount(uint64_t _fBitMask)
-            {
-                return BitsCount64(_fBitMask);
-            }
-
-#ifdef _WIN32
-            static uint32_t __YYAPI GetLogicalProcessorCount() noexcept
-            {
-                static uint32_t s_LogicalProcessorCount = 0;
-                if (s_LogicalProcessorCount != 0)
-                {
-                    return s_LogicalProcessorCount;
-                }
-                uint32_t _uLogicalProcessorCount = 0;
-
-                do
-                {
-                    DWORD _cbData = 0;
-                    if (!GetLogicalProcessorInformationEx(LOGICAL_PROCESSOR_RELATIONSHIP::RelationProcessorPackage, nullptr, &_cbData))
-                    {
-                        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
-                        {
-                            break;
-                        }
-                    }
-
-                    UniquePtr<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX> _pBuffer((SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)Alloc(_cbData));
-                    if (!_pBuffer)
-                        break;
-
-                    if (!GetLogicalProcessorInformationEx(LOGICAL_PROCESSOR_RELATIONSHIP::RelationProcessorPackage, _pBuffer, &_cbData))
-                        break;
-
-                    for (size_t i = 0; i != _pBuffer->Processor.GroupCount; ++i)
-                    {
-                        _uLogicalProcessorCount += BitsCount((uintptr_t)_pBuffer->Processor.GroupMask[i].Mask);
-                    }
-
-                } while (false);
-
+            class ParallelTaskRunnerImpl;
 
-                if (_uLogicalProcessorCount == 0)
-                {
-                    SYSTEM_INFO _oSystemInfo;
-                    GetNativeSystemInfo(&_oSystemInfo);
-
-                    _uLogicalProcessorCount = _oSystemInfo.dwNumberOfProcessors;
-                }
-
-                if (_uLogicalProcessorCount == 0)
-                    _uLogicalProcessorCount = 1;
-
-                // 防止意外的逻辑处理器数量发送变化，造成潜在的风险，特意使用原子操作
-                auto _uLast = Sync::CompareExchange(&s_LogicalProcessorCount, _uLogicalProcessorCount, 0);
-                return _uLast ? _uLast : _uLogicalProcessorCount;
-            }
-#else
-            static uint32_t __YYAPI GetLogicalProcessorCount() noexcept
-            {
-                static uint32_t s_LogicalProcessorCount = 0;
-                if (s_LogicalProcessorCount != 0)
-                {
-                    return s_LogicalProcessorCount;
-                }
-
-                const auto _uCount = get_nprocs();
-                if (_uCount)
-                {
-                    s_LogicalProcessorCount = _uCount;
-                }
-                else
-                {
-                    s_LogicalProcessorCount = 1;
-                }
-                return s_LogicalProcessorCount;
-            }
-#endif
+            // 当前线程正在执行的 ParallelTaskRunner，用于阻塞等待时帮助执行同一个 ParallelTaskRunner 中的任务
+            extern thread_local ParallelTaskRunnerImpl* g_pCurrentParallelTaskRunner;
 
             class ParallelTaskRunnerImpl : public ParallelTaskRunner
             {
             public:
-                InterlockedQueue<TaskEntry> oTaskQueue;
+                TaskPriorityQueue oTaskQueue;
 
                 // |uWeakCount| bPushLock | bStopWakeup | bPushLock |
                 // | 31  ~  3 |    2      |     1       |    0      |
@@ -170,8 +65,8 @@ namespace YY
 
                 uString szThreadDescription;
 
-                ParallelTaskRunnerImpl(uint32_t _uParallelMaximum, uString _szThreadDescription)
-                    : ParallelTaskRunner(_uParallelMaximum)
+                ParallelTaskRunnerImpl(uint32_t _uParallelMaximum, uString _szThreadDescription, uint32_t _uNumaNode = kAnyNumaNode)
+                    : ParallelTaskRunner(_uParallelMaximum, _uNumaNode)
                     , TaskRunnerFlags{ 0u }
                     , szThreadDescription(std::move(_szThreadDescription))
                 {
@@ -222,6 +117,7 @@ namespace YY
                 HRESULT __YYAPI PostTaskInternal(_In_ RefPtr<TaskEntry> _pTask) override
                 {
                     _pTask->hr = E_PENDING;
+                    const auto _ePriority = _pTask->ePriority;
 
                     if (TaskRunnerFlags.bStopWakeup)
                     {
@@ -229,7 +125,7 @@ namespace YY
                         return YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED);
                     }
 
-                    const auto _uParallelMaximum = uParallelMaximum ? uParallelMaximum : GetLogicalProcessorCount();
+                    const auto _uParallelMaximum = uParallelMaximum ? uParallelMaximum : GetEffectiveProcessorCount();
 
                     // 解除锁定，并且 WeakupCount + 1，也尝试提升 uParallelCurrent
                     TaskRunnerFlagsType _uOldFlags = TaskRunnerFlags;
@@ -271,7 +167,7 @@ namespace YY
                     {
                         AddRef();
                     }
-                    auto _hr = ThreadPool::PostTaskInternalWithoutAddRef(this);
+                    auto _hr = ThreadPool::PostTaskInternalWithoutAddRef(this, _ePriority, uNumaNode);
                     if (FAILED(_hr))
                     {
                         // 阻止后续再唤醒线程
@@ -286,6 +182,97 @@ namespace YY
 
                     return S_OK;
                 }
+
+                HRESULT __YYAPI PostTasksInternal(_In_ Span<TaskEntry*> _oTasks) override
+                {
+                    const auto _cTasks = uint32_t(_oTasks.GetSize());
+                    if (_cTasks == 0)
+                        return S_OK;
+
+                    for (auto _pTask : _oTasks)
+                    {
+                        _pTask->hr = E_PENDING;
+                    }
+                    const auto _ePriority = GetHighestPriority(_oTasks);
+
+                    if (TaskRunnerFlags.bStopWakeup)
+                    {
+                        for (auto _pTask : _oTasks)
+                        {
+                            RefPtr<TaskEntry>::FromPtr(_pTask)->Wakeup(YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED));
+                        }
+                        return YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED);
+                    }
+
+                    const auto _uParallelMaximum = uParallelMaximum ? uParallelMaximum : GetEffectiveProcessorCount();
+
+                    // 整批任务只锁定一次队列，WeakupCount 一次增加 _cTasks。
+                    // uParallelCurrent 的提升等价于逐个 PostTaskInternal 的结果：
+                    // 从第一个满足 uWakeupCount >= uParallelCurrent 的任务开始，每个任务提升一次，直到 _uParallelMaximum。
+                    TaskRunnerFlagsType _uOldFlags = TaskRunnerFlags;
+                    TaskRunnerFlagsType _uNewFlags;
+                    for (;;)
+                    {
+                        if (_uOldFlags.uWakeupCountAndPushLock & (1 << LockedQueuePushBitIndex))
+                        {
+                            YieldProcessor();
+                            _uOldFlags.fFlags64 = TaskRunnerFlags.fFlags64;
+                            continue;
+                        }
+
+                        _uNewFlags = _uOldFlags;
+                        _uNewFlags.uWakeupCountAndPushLock += WakeupOnceRaw * _cTasks | (1 << LockedQueuePushBitIndex);
+
+                        if (_uNewFlags.uParallelCurrent < _uParallelMaximum)
+                        {
+                            const int32_t _iFirstRaise = (std::max)(int32_t(_uOldFlags.uParallelCurrent) - _uOldFlags.uWakeupCount, 1);
+                            if (int32_t(_cTasks) >= _iFirstRaise)
+                            {
+                                _uNewFlags.uParallelCurrent = (std::min)(_uOldFlags.uParallelCurrent + (_cTasks - _iFirstRaise + 1), _uParallelMaximum);
+                            }
+                        }
+
+                        auto _uLast = Sync::CompareExchange(&TaskRunnerFlags.fFlags64, _uNewFlags.fFlags64, _uOldFlags.fFlags64);
+                        if (_uLast == _uOldFlags.fFlags64)
+                        {
+                            for (auto _pTask : _oTasks)
+                            {
+                                oTaskQueue.Push(_pTask);
+                            }
+                            Sync::BitReset(&TaskRunnerFlags.uWakeupCountAndPushLock, LockedQueuePushBitIndex);
+                            break;
+                        }
+
+                        _uOldFlags.fFlags64 = _uLast;
+                    }
+
+                    const auto _cNewThreads = _uNewFlags.uParallelCurrent - _uOldFlags.uParallelCurrent;
+                    if (_cNewThreads == 0)
+                        return S_OK;
+
+                    // 与 PostTaskInternal 相同，uParallelCurrent 从 0 提升时额外 AddRef 一次
+                    if (_uOldFlags.uParallelCurrent == 0u)
+                    {
+                        AddRef();
+                    }
+
+                    for (uint32_t _uIndex = 0; _uIndex != _cNewThreads; ++_uIndex)
+                    {
+                        auto _hr = ThreadPool::PostTaskInternalWithoutAddRef(this, _ePriority, uNumaNode);
+                        if (FAILED(_hr))
+                        {
+                            // 阻止后续再唤醒线程，并撤销尚未启动的线程
+                            Sync::BitSet(&TaskRunnerFlags.uWakeupCountAndPushLock, StopWakeupBitIndex);
+                            if (Sync::Subtract(&TaskRunnerFlags.uParallelCurrent, _cNewThreads - _uIndex) == 0u)
+                            {
+                                Release();
+                            }
+                            return _hr;
+                        }
+                    }
+
+                    return S_OK;
+                }
                 //
                 /////////////////////////////////////////////////////
 
@@ -310,10 +297,23 @@ namespace YY
 #if defined(_WIN32)
                     if(szThreadDescription.GetSize())
                         SetThreadDescription(GetCurrentThread(), szThreadDescription);
+
+                    // 系统线程池不区分 NUMA 节点，执行期间临时修改亲和性。Linux 线程池按节点分区，无需处理。
+                    GROUP_AFFINITY _oPreviousAffinity;
+                    const auto _bNumaNodeEntered = ThreadPool::EnterNumaNode(uNumaNode, &_oPreviousAffinity);
+#if YY_MEMORY_USE_THREAD_CACHE
+                    // 线程可能换了节点，线程缓存需要跟随当前节点
+                    Memory::ThreadCacheAllocator::RefreshCurrentThreadNumaNode();
+#endif
 #endif
 
                     ExecuteTaskRunner();
 
+#if defined(_WIN32)
+                    if (_bNumaNodeEntered)
+                        ThreadPool::LeaveNumaNode(_oPreviousAffinity);
+#endif
+
                     if (IsShared() == false
                         || TaskRunnerFlags.bInterrupt
                         || (TaskRunnerFlags.bStopWakeup && TaskRunnerFlags.uWakeupCount == 0))
@@ -326,9 +326,31 @@ namespace YY
 #endif
                 }
 
+                /// <summary>
+                /// 在阻塞等待的线程上帮助执行一个排队中的任务。
+                /// 等待中的任务已经占用了当前线程的并行名额，因此帮助执行不会超过 uParallelMaximum。
+                /// </summary>
+                /// <returns>没有可执行的任务时返回 false。</returns>
+                bool __YYAPI HelpExecuteTask()
+                {
+                    if (!IsShared() || TaskRunnerFlags.bInterrupt)
+                        return false;
+
+                    auto _pTask = PopTask();
+                    if (!_pTask)
+                        return false;
+
+                    _pTask->operator()();
+                    _pTask.Reset();
+                    // 等待中的任务仍然计入 uWakeupCount 并占用 uParallelCurrent，因此这里不会减到 0，也不需要调整 uParallelCurrent
+                    Sync::Subtract(&TaskRunnerFlags.uWakeupCountAndPushLock, uint32_t(WakeupOnceRaw));
+                    return true;
+                }
+
                 void __YYAPI ExecuteTaskRunner()
                 {
                     g_pTaskRunnerWeak = this;
+                    g_pCurrentParallelTaskRunner = this;
                     bool _bReleaseParallelCurrent = true;
                     for (;;)
                     {
@@ -357,6 +379,7 @@ namespace YY
                     if (_bReleaseParallelCurrent)
                         Sync::Decrement(&TaskRunnerFlags.uParallelCurrent);
 
+                    g_pCurrentParallelTaskRunner = nullptr;
                     g_pTaskRunnerWeak = nullptr;
                     return;
                 }
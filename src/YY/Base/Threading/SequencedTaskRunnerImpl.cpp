@@ -13,9 +13,17 @@ namespace YY
     {
         namespace Threading
         {
-            SequencedTaskRunnerImpl::SequencedTaskRunnerImpl(uString _szThreadDescription)
+            // RunOrPostTask 嵌套直接执行的最大层数
+            static constexpr uint32_t kMaxRunInlineDepth = 16;
+
+            // 当前线程嵌套直接执行的层数
+            static thread_local uint32_t g_uRunInlineDepth = 0;
+
+            SequencedTaskRunnerImpl::SequencedTaskRunnerImpl(uString _szThreadDescription, uint32_t _cQuantumTasks, TimeSpan _uQuantumTime)
                 : uWakeupCountAndPushLock(0u)
                 , szThreadDescription(std::move(_szThreadDescription))
+                , cQuantumTasks(_cQuantumTasks)
+                , uQuantumTime(_uQuantumTime)
             {
             }
 
@@ -62,6 +70,7 @@ namespace YY
             HRESULT __YYAPI SequencedTaskRunnerImpl::PostTaskInternal(RefPtr<TaskEntry> _pTask)
             {
                 _pTask->hr = E_PENDING;
+                const auto _ePriority = _pTask->ePriority;
 
                 auto _fFlags = uWakeupCountAndPushLock;
                 for (;;)
@@ -91,7 +100,68 @@ namespace YY
                 // 小于 WakeupOnceRaw说明之前是没有线程了
                 if (_fFlags < WakeupOnceRaw)
                 {
-                    auto _hr = ThreadPool::PostTaskInternal(this);
+                    ePoolPriority = _ePriority;
+                    auto _hr = ThreadPool::PostTaskInternal(this, _ePriority);
+                    if (FAILED(_hr))
+                    {
+                        // 阻止后续再唤醒线程
+                        Sync::BitSet(&uWakeupCountAndPushLock, StopWakeupBitIndex);
+                        CleanupTaskQueue();
+                        return _hr;
+                    }
+                }
+                return S_OK;
+            }
+
+            HRESULT __YYAPI SequencedTaskRunnerImpl::PostTasksInternal(Span<TaskEntry*> _oTasks)
+            {
+                const auto _cTasks = uint32_t(_oTasks.GetSize());
+                if (_cTasks == 0)
+                    return S_OK;
+
+                for (auto _pTask : _oTasks)
+                {
+                    _pTask->hr = E_PENDING;
+                }
+                const auto _ePriority = GetHighestPriority(_oTasks);
+
+                // 整批任务只锁定一次队列，唤醒计数一次增加 _cTasks
+                auto _fFlags = uWakeupCountAndPushLock;
+                for (;;)
+                {
+                    if (_fFlags & StopWakeupRaw)
+                    {
+                        for (auto _pTask : _oTasks)
+                        {
+                            RefPtr<TaskEntry>::FromPtr(_pTask)->Wakeup(YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED));
+                        }
+                        return YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED);
+                    }
+                    else if (_fFlags & (1 << LockedQueuePushBitIndex))
+                    {
+                        YieldProcessor();
+                        _fFlags = uWakeupCountAndPushLock;
+                        continue;
+                    }
+
+                    const auto _uLast = Sync::CompareExchange(&uWakeupCountAndPushLock, _fFlags + WakeupOnceRaw * _cTasks + (1u << LockedQueuePushBitIndex), _fFlags);
+                    if (_uLast == _fFlags)
+                    {
+                        for (auto _pTask : _oTasks)
+                        {
+                            oTaskQueue.Push(_pTask);
+                        }
+                        Sync::BitReset(&uWakeupCountAndPushLock, LockedQueuePushBitIndex);
+                        break;
+                    }
+                    _fFlags = _uLast;
+                }
+
+                // 串行执行，最多只需要一个线程
+                if (_fFlags < WakeupOnceRaw)
+                {
+                    ePoolPriority = _ePriority;
+                    auto _hr = ThreadPool::PostTaskInternal(this, _ePriority);
                     if (FAILED(_hr))
                     {
                         // 阻止后续再唤醒线程
@@ -103,6 +173,64 @@ namespace YY
                 return S_OK;
             }
 
+            HRESULT __YYAPI SequencedTaskRunnerImpl::RunOrPostTaskInternal(RefPtr<TaskEntry> _pTask)
+            {
+                // 只有完全空闲（没有任务、没有锁定、没有停止）时才能取得执行权，取得后 uWakeupCount = 1，
+                // 其他线程随后投递的任务只会排队，不会再唤醒线程池，从而保证串行以及投递顺序。
+                if (g_uRunInlineDepth >= kMaxRunInlineDepth
+                    || Sync::CompareExchange(&uWakeupCountAndPushLock, uint32_t(WakeupOnceRaw), 0u) != 0u)
+                {
+                    return PostTaskInternal(std::move(_pTask));
+                }
+
+                _pTask->hr = E_PENDING;
+                ePoolPriority = _pTask->ePriority;
+
+                auto _pPreviousTaskRunnerWeak = g_pTaskRunnerWeak;
+                g_pTaskRunnerWeak = this;
+                ++g_uRunInlineDepth;
+
+                try
+                {
+                    _pTask->operator()();
+                }
+                catch (...)
+                {
+                    --g_uRunInlineDepth;
+                    g_pTaskRunnerWeak = std::move(_pPreviousTaskRunnerWeak);
+                    LeaveInlineExecution();
+                    throw;
+                }
+
+                --g_uRunInlineDepth;
+                g_pTaskRunnerWeak = std::move(_pPreviousTaskRunnerWeak);
+                LeaveInlineExecution();
+                return S_OK;
+            }
+
+            void __YYAPI SequencedTaskRunnerImpl::LeaveInlineExecution() noexcept
+            {
+                const auto _uNewWakeupCountAndPushLock = Sync::Subtract(&uWakeupCountAndPushLock, WakeupOnceRaw);
+                if ((_uNewWakeupCountAndPushLock & InterruptRaw)
+                    || (_uNewWakeupCountAndPushLock < WakeupOnceRaw && (_uNewWakeupCountAndPushLock & StopWakeupRaw)))
+                {
+                    // 与 operator() 相同，被中断或者 Join 时清理队列并唤醒等待者
+                    CleanupTaskQueue();
+                    return;
+                }
+
+                if (_uNewWakeupCountAndPushLock < WakeupOnceRaw)
+                    return;
+
+                // 执行期间有新任务排队，这些任务投递时没有唤醒线程池，需要由这里负责
+                auto _hr = ThreadPool::PostTaskInternal(this, ePoolPriority);
+                if (FAILED(_hr))
+                {
+                    Sync::BitSet(&uWakeupCountAndPushLock, StopWakeupBitIndex);
+                    CleanupTaskQueue();
+                }
+            }
+
             void __YYAPI SequencedTaskRunnerImpl::operator()()
             {
 #if defined(_WIN32)
@@ -110,11 +238,28 @@ namespace YY
                     SetThreadDescription(GetCurrentThread(), szThreadDescription);
 #endif
 
-                ExecuteTaskRunner();
+                bool _bRequeued = false;
+                while (ExecuteTaskRunner())
+                {
+                    if (IsShared() == false || bInterrupt)
+                        break;
 
-                if (IsShared() == false
-                    || bInterrupt
-                    || (bStopWakeup && uWakeupCount == 0))
+                    // 时间片已经用完，重新排队到线程池末尾，让其他 TaskRunner 先执行。
+                    // uWakeupCount 依然不为 0，因此 PostTaskInternal 不会重复唤醒，重新排队只能由这里负责。
+                    // 沿用唤醒时的优先级，否则高优先级的序列让出一次后就降为 Normal。
+                    if (SUCCEEDED(ThreadPool::PostTaskInternal(this, ePoolPriority)))
+                    {
+                        _bRequeued = true;
+                        break;
+                    }
+
+                    // 重新排队失败，继续在当前线程执行
+                }
+
+                if (!_bRequeued
+                    && (IsShared() == false
+                        || bInterrupt
+                        || (bStopWakeup && uWakeupCount == 0)))
                 {
                     CleanupTaskQueue();
                 }
@@ -125,10 +270,14 @@ namespace YY
 #endif
             }
 
-            void __YYAPI SequencedTaskRunnerImpl::ExecuteTaskRunner()
+            bool __YYAPI SequencedTaskRunnerImpl::ExecuteTaskRunner()
             {
                 g_pTaskRunnerWeak = this;
 
+                const auto _uQuantumEnd = uQuantumTime == TimeSpan::GetMax() ? TickCount::GetMax() : TickCount::GetNow() + uQuantumTime;
+                uint32_t _cExecutedTasks = 0;
+                bool _bYield = false;
+
                 for (;;)
                 {
                     // 理论上 ExecuteTaskRunner 执行时引用计数 = 2，因为执行器拥有一次引用计数
@@ -149,9 +298,17 @@ namespace YY
 
                     if (_uNewWakeupCountAndPushLock < WakeupOnceRaw)
                         break;
+
+                    ++_cExecutedTasks;
+                    if ((cQuantumTasks && _cExecutedTasks >= cQuantumTasks)
+                        || (_uQuantumEnd != TickCount::GetMax() && _cExecutedTasks % kQuantumTimeCheckInterval == 0 && TickCount::GetNow() >= _uQuantumEnd))
+                    {
+                        _bYield = true;
+                        break;
+                    }
                 }
                 g_pTaskRunnerWeak = nullptr;
-                return;
+                return _bYield;
             }
 
             void __YYAPI SequencedTaskRunnerImpl::CleanupTaskQueue() noexcept
@@ -1,7 +1,6 @@
 ﻿#pragma once
-#include <YY/Base/Sync/InterlockedQueue.h>
-
 #include "TaskRunnerImpl.h"
+#include "TaskPriorityQueue.h"
 
 #pragma pack(push, __YY_PACKING)
 
@@ -15,7 +14,7 @@ namespace YY
             {
                 friend YY::Base::Threading::ThreadPool;
             private:
-                InterlockedQueue<TaskEntry> oTaskQueue;
+                TaskPriorityQueue oTaskQueue;
 
                 union
                 {
@@ -43,8 +42,21 @@ namespace YY
 
                 uString szThreadDescription;
 
+                // 每个时间片最多执行的任务数量，0 表示不限制
+                uint32_t cQuantumTasks;
+                // 每个时间片最长的执行时间，TimeSpan::GetMax() 表示不限制
+                TimeSpan uQuantumTime;
+                // 唤醒线程池时使用的优先级，时间片用完重新排队时沿用。只由使 uWakeupCount 从 0 变为非 0 的线程写入
+                TaskPriority ePoolPriority = TaskPriority::Normal;
+
+                // 读取当前时间有一定开销，每执行这么多个任务才检查一次 uQuantumTime
+                static constexpr uint32_t kQuantumTimeCheckInterval = 16;
+
             public:
-                SequencedTaskRunnerImpl(uString _szThreadDescription = uString());
+                SequencedTaskRunnerImpl(
+                    uString _szThreadDescription = uString(),
+                    uint32_t _cQuantumTasks = 0,
+                    TimeSpan _uQuantumTime = TimeSpan::GetMax());
 
                 ~SequencedTaskRunnerImpl() override;
 
@@ -65,9 +77,22 @@ namespace YY
             private:
                 HRESULT __YYAPI PostTaskInternal(_In_ RefPtr<TaskEntry> _pTask) override;
 
+                HRESULT __YYAPI PostTasksInternal(_In_ Span<TaskEntry*> _oTasks) override;
+
+                HRESULT __YYAPI RunOrPostTaskInternal(_In_ RefPtr<TaskEntry> _pTask) override;
+
+                /// <summary>
+                /// RunOrPostTaskInternal 直接执行任务后交还执行权。期间有新任务投递时，由这里唤醒线程池继续执行。
+                /// </summary>
+                void __YYAPI LeaveInlineExecution() noexcept;
+
                 void __YYAPI CleanupTaskQueue() noexcept;
 
-                void __YYAPI ExecuteTaskRunner();
+                /// <summary>
+                /// 执行队列中的任务。
+                /// </summary>
+                /// <returns>时间片用完并且仍有剩余任务时返回 true，调用者需要重新排队。</returns>
+                bool __YYAPI ExecuteTaskRunner();
             };
         }
     }
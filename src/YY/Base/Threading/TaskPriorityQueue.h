@@ -0,0 +1,89 @@
+﻿#pragma once
+#include <YY/Base/Sync/InterlockedQueue.h>
+#include <YY/Base/Threading/TaskRunner.h>
+
+#pragma pack(push, __YY_PACKING)
+
+namespace YY
+{
+    namespace Base
+    {
+        namespace Threading
+        {
+            /// <summary>
+            /// 返回第 _uPopCount 次 Pop 时应该优先尝试的优先级，用于避免低优先级任务饿死。
+            /// 每 8 次 Pop 优先尝试 Normal，每 32 次 Pop 优先尝试 Background，其余时候从 UserBlocking 开始。
+            /// </summary>
+            inline TaskPriority __YYAPI GetStarvationBoostPriority(_In_ uint32_t _uPopCount) noexcept
+            {
+                constexpr uint32_t kNormalBoostInterval = 8;
+                constexpr uint32_t kBackgroundBoostInterval = 32;
+
+                if (_uPopCount % kBackgroundBoostInterval == 0)
+                    return TaskPriority::Background;
+                else if (_uPopCount % kNormalBoostInterval == 0)
+                    return TaskPriority::Normal;
+
+                return TaskPriority::UserBlocking;
+            }
+
+            /// <summary>
+            /// 按 TaskPriority 分级的任务队列，接口与 InterlockedQueue<TaskEntry> 相同（单生产者、单消费者，由调用者加锁）。
+            ///
+            /// Pop 优先返回高优先级的任务。为了避免低优先级任务饿死，按 GetStarvationBoostPriority 定期优先尝试 Normal 以及 Background，
+            /// 因此只要队列非空，低优先级任务至少能获得固定比例的执行机会。
+            /// </summary>
+            class TaskPriorityQueue
+            {
+            private:
+                InterlockedQueue<TaskEntry> arrTaskQueue[size_t(TaskPriority::Count)];
+                uint32_t uPopCount = 0;
+
+            public:
+                _Ret_maybenull_ TaskEntry* Pop() noexcept
+                {
+                    const auto _eFirst = GetStarvationBoostPriority(++uPopCount);
+                    if (_eFirst != TaskPriority::UserBlocking)
+                    {
+                        if (auto _pTask = arrTaskQueue[size_t(_eFirst)].Pop())
+                            return _pTask;
+                    }
+
+                    for (auto& _oTaskQueue : arrTaskQueue)
+                    {
+                        if (auto _pTask = _oTaskQueue.Pop())
+                            return _pTask;
+                    }
+
+                    return nullptr;
+                }
+
+                void Push(_In_ TaskEntry* _pTask)
+                {
+                    auto _uPriority = size_t(_pTask->ePriority);
+                    if (_uPriority >= size_t(TaskPriority::Count))
+                        _uPriority = size_t(TaskPriority::Normal);
+
+                    arrTaskQueue[_uPriority].Push(_pTask);
+                }
+            };
+
+            /// <summary>
+            /// 返回一组任务中的最高优先级，用于决定唤醒线程池线程时使用的优先级。
+            /// </summary>
+            inline TaskPriority __YYAPI GetHighestPriority(_In_ Span<TaskEntry*> _oTasks) noexcept
+            {
+                auto _eHighest = TaskPriority::Background;
+                for (auto _pTask : _oTasks)
+                {
+                    if (_pTask->ePriority < _eHighest)
+                        _eHighest = _pTask->ePriority;
+                }
+
+                return _eHighest;
+            }
+        }
+    }
+} // namespace YY::Base::Threading
+
+#pragma pack(pop)
@@ -2,6 +2,7 @@
 
 #include <YY/Base/Exception.h>
 #include <YY/Base/Sync/Sync.h>
+#include <YY/Base/Threading/CoroutineTrampoline.h>
 
 #include "ThreadTaskRunnerImpl.h"
 #include "SequencedTaskRunnerImpl.h"
@@ -46,8 +47,50 @@ namespace YY
                 }
             }
 
-            bool __YYAPI TaskEntry::WaitTask(YY::TimeSpan _oTimeout)
+            // 阻塞等待期间帮助执行其他任务的最大嵌套层数，避免被帮助的任务再次等待时调用栈无限加深
+            static constexpr uint32_t kMaxHelpWhileWaitingDepth = 4;
+            static thread_local uint32_t g_uHelpWhileWaitingDepth = 0;
+
+            thread_local ParallelTaskRunnerImpl* g_pCurrentParallelTaskRunner = nullptr;
+
+            /// <summary>
+            /// 帮助执行一个当前线程可以安全执行的排队任务。
+            /// 只帮助当前线程所在、并且通过 SetHelpWhileWaiting 开启了帮助的 ParallelTaskRunner：它不要求顺序，并且等待中的任务已经占用了当前线程的并行名额。
+            /// </summary>
+            /// <returns>没有可执行的任务时返回 false。</returns>
+            static bool __YYAPI HelpExecuteTaskWhileWaiting()
             {
+                if (g_uHelpWhileWaitingDepth >= kMaxHelpWhileWaitingDepth)
+                    return false;
+
+                auto _pParallelTaskRunner = g_pCurrentParallelTaskRunner;
+                if (!_pParallelTaskRunner || !_pParallelTaskRunner->IsHelpWhileWaiting())
+                    return false;
+
+                // RunOrPostTask 等可能在 ParallelTaskRunner 的任务中内联执行其他 TaskRunner 的任务，这时不能帮助执行
+                if (g_pTaskRunnerWeak.Get().Get() != _pParallelTaskRunner)
+                    return false;
+
+                ++g_uHelpWhileWaitingDepth;
+                bool _bExecuted;
+                try
+                {
+                    _bExecuted = _pParallelTaskRunner->HelpExecuteTask();
+                }
+                catch (...)
+                {
+                    --g_uHelpWhileWaitingDepth;
+                    throw;
+                }
+                --g_uHelpWhileWaitingDepth;
+                return _bExecuted;
+            }
+
+            bool __YYAPI WaitForPendingResult(const volatile HRESULT* _phrResult, TimeSpan _oTimeout)
+            {
+                if (*_phrResult != E_PENDING)
+                    return true;
+
                 DWORD _uMilliseconds;
                 auto _iTimeoutMilliseconds = _oTimeout.GetTotalMilliseconds();
                 if (_iTimeoutMilliseconds <= 0)
@@ -64,7 +107,38 @@ namespace YY
                 }
 
                 HRESULT _hrTarget = E_PENDING;
-                return WaitOnAddress(&hr, &_hrTarget, sizeof(_hrTarget), _uMilliseconds);
+                if (_uMilliseconds == 0)
+                    return WaitOnAddress((volatile void*)_phrResult, &_hrTarget, sizeof(_hrTarget), 0);
+
+#if defined(_HAS_CXX20) && _HAS_CXX20
+                CoroutineTrampoline::BlockingScope _oTrampolineScope;
+#endif
+                if (_uMilliseconds != UINT32_MAX)
+                {
+                    // 有超时的等待不帮助执行其他任务，否则被帮助的任务可能让等待远远超过超时时间
+                    const auto _bReportBlocked = ThreadPool::EnterBlockingWait();
+                    const auto _bResult = WaitOnAddress((volatile void*)_phrResult, &_hrTarget, sizeof(_hrTarget), _uMilliseconds);
+                    if (_bReportBlocked)
+                        ThreadPool::LeaveBlockingWait();
+                    return _bResult;
+                }
+
+                while (*_phrResult == E_PENDING)
+                {
+                    if (HelpExecuteTaskWhileWaiting())
+                        continue;
+
+                    const auto _bReportBlocked = ThreadPool::EnterBlockingWait();
+                    WaitOnAddress((volatile void*)_phrResult, &_hrTarget, sizeof(_hrTarget), UINT32_MAX);
+                    if (_bReportBlocked)
+                        ThreadPool::LeaveBlockingWait();
+                }
+                return true;
+            }
+
+            bool __YYAPI TaskEntry::WaitTask(YY::TimeSpan _oTimeout)
+            {
+                return WaitForPendingResult(&hr, _oTimeout);
             }
 
             bool __YYAPI TaskEntry::Cancel()
@@ -244,7 +318,7 @@ namespace YY
             HRESULT __YYAPI TaskRunner::PostDelayTask(TimeSpan _uAfter, std::function<void(void)>&& _pfnTaskCallback)
             {
                 auto _uExpire = TickCount::GetNow() + _uAfter;
-                auto _pTimer = RefPtr<Timer>::Create();
+                auto _pTimer = RefPtr<Timer>::CreateFromPool();
                 if (!_pTimer)
                     return E_OUTOFMEMORY;
 
@@ -263,6 +337,97 @@ namespace YY
                 return PostTaskInternal(_pTask);
             }
 
+            HRESULT __YYAPI TaskRunner::PostTask(std::function<void(void)>&& _pfnTaskCallback, TaskPriority _ePriority)
+            {
+                if (_ePriority >= TaskPriority::Count)
+                    return E_INVALIDARG;
+
+                auto _pTask = RefPtr<TaskEntry>::Create();
+                if (!_pTask)
+                    return E_OUTOFMEMORY;
+
+                _pTask->ePriority = _ePriority;
+                _pTask->pfnTaskCallback = std::move(_pfnTaskCallback);
+                return PostTaskInternal(_pTask);
+            }
+
+            HRESULT __YYAPI TaskRunner::RunOrPostTask(std::function<void(void)>&& _pfnTaskCallback)
+            {
+                auto _pTask = RefPtr<TaskEntry>::Create();
+                if (!_pTask)
+                    return E_OUTOFMEMORY;
+
+                _pTask->pfnTaskCallback = std::move(_pfnTaskCallback);
+                return RunOrPostTaskInternal(std::move(_pTask));
+            }
+
+            HRESULT __YYAPI TaskRunner::RunOrPostTaskInternal(RefPtr<TaskEntry> _pTask)
+            {
+                return PostTaskInternal(std::move(_pTask));
+            }
+
+            HRESULT __YYAPI TaskRunner::PostTasks(Span<std::function<void(void)>> _oTaskCallbacks, TaskPriority _ePriority)
+            {
+                if (_ePriority >= TaskPriority::Count)
+                    return E_INVALIDARG;
+
+                // 限制单批的数量，避免唤醒计数溢出；每批使用栈上的缓冲区，不需要额外申请内存
+                constexpr size_t kMaxPostTasksBatch = 256;
+                TaskEntry* _ppTasks[kMaxPostTasksBatch];
+
+                auto _pTaskCallbacks = _oTaskCallbacks.GetData();
+                auto _cRemaining = _oTaskCallbacks.GetSize();
+
+                HRESULT _hr = S_OK;
+                while (_cRemaining)
+                {
+                    const auto _cBatch = (std::min)(_cRemaining, kMaxPostTasksBatch);
+                    size_t _cTasks = 0;
+                    for (; _cTasks != _cBatch; ++_cTasks)
+                    {
+                        auto _pTask = RefPtr<TaskEntry>::Create();
+                        if (!_pTask)
+                            break;
+
+                        _pTask->ePriority = _ePriority;
+                        _pTask->pfnTaskCallback = std::move(_pTaskCallbacks[_cTasks]);
+                        _ppTasks[_cTasks] = _pTask.Detach();
+                    }
+
+                    // 内存不足时只投递已经创建的部分，保持与逐个 PostTask 相同的顺序语义
+                    if (_cTasks != _cBatch)
+                        _hr = E_OUTOFMEMORY;
+
+                    if (_cTasks)
+                    {
+                        auto _hrPost = PostTasksInternal(Span<TaskEntry*>(_ppTasks, _cTasks));
+                        if (FAILED(_hrPost) && SUCCEEDED(_hr))
+                            _hr = _hrPost;
+                    }
+
+                    if (FAILED(_hr))
+                        break;
+
+                    _pTaskCallbacks += _cBatch;
+                    _cRemaining -= _cBatch;
+                }
+
+                return _hr;
+            }
+
+            HRESULT __YYAPI TaskRunner::PostTasksInternal(Span<TaskEntry*> _oTasks)
+            {
+                HRESULT _hr = S_OK;
+                for (auto _pTask : _oTasks)
+                {
+                    auto _hrPost = PostTaskInternal(RefPtr<TaskEntry>::FromPtr(_pTask));
+                    if (FAILED(_hrPost) && SUCCEEDED(_hr))
+                        _hr = _hrPost;
+                }
+
+                return _hr;
+            }
+
             RefPtr<SequencedTaskRunner> __YYAPI SequencedTaskRunner::GetCurrent()
             {
                 auto _pTaskRunner = g_pTaskRunnerWeak.Get();
@@ -277,6 +442,11 @@ namespace YY
                 return RefPtr<SequencedTaskRunnerImpl>::Create(std::move(_szThreadDescription));
             }
 
+            RefPtr<SequencedTaskRunner> __YYAPI SequencedTaskRunner::Create(uint32_t _cQuantumTasks, TimeSpan _uQuantumTime, uString _szThreadDescription)
+            {
+                return RefPtr<SequencedTaskRunnerImpl>::Create(std::move(_szThreadDescription), _cQuantumTasks, _uQuantumTime);
+            }
+
             HRESULT __YYAPI TaskRunner::SendTask(std::function<void(void)>&& pfnTaskCallback)
             {
                 // 调用者的跟执行者属于同一个TaskRunner，这时我们直接调用 _pfnCallback，避免各种等待以及任务投递开销。
@@ -313,7 +483,7 @@ namespace YY
                     return nullptr;
 
                 auto _uCurrent = TickCount::GetNow();
-                auto _pTimer = RefPtr<Timer>::Create();
+                auto _pTimer = RefPtr<Timer>::CreateFromPool();
                 if (!_pTimer)
                     return nullptr;
 
@@ -335,7 +505,7 @@ namespace YY
                 if (!_pfnTaskCallback)
                     return nullptr;
 
-                auto _pWait = RefPtr<Wait>::Create();
+                auto _pWait = RefPtr<Wait>::CreateFromPool();
                 if (!_pWait)
                     return nullptr;
 
@@ -411,6 +581,20 @@ namespace YY
                 return _pTaskRunner;
             }
 
+            RefPtr<ThreadTaskRunner> __YYAPI ThreadTaskRunner::Create(const ThreadTaskRunnerOptions& _oOptions)
+            {
+                auto _pTaskRunner = RefPtr<ThreadTaskRunnerImpl>::Create(_oOptions);
+                if (_pTaskRunner)
+                {
+                    auto _hr = _oOptions.bDedicatedThread ? ThreadPool::CreateDedicatedThread(_pTaskRunner.Get()) : ThreadPool::PostTaskInternal(_pTaskRunner.Get());
+                    if (FAILED(_hr))
+                    {
+                        return nullptr;
+                    }
+                }
+                return _pTaskRunner;
+            }
+
             RefPtr<ThreadTaskRunner> __YYAPI ThreadTaskRunner::GetCurrent()
             {
                 auto _pTaskRunner = g_pTaskRunnerWeak.Get();
@@ -471,6 +655,10 @@ namespace YY
                     throw Exception(L"尚未调用 BindCurrentThread。", E_INVALIDARG);
                 }
 
+#if defined(_HAS_CXX20) && _HAS_CXX20
+                // 可能在协程内嵌套运行消息循环
+                CoroutineTrampoline::BlockingScope _oTrampolineScope;
+#endif
                 auto _uResult = _pThreadTaskRunnerImpl->RunTaskRunnerLoop();
                 return _uResult;
             }
@@ -506,6 +694,11 @@ namespace YY
                 return RefPtr<ParallelTaskRunnerImpl>::Create(_uParallelMaximum, std::move(_szThreadDescription));
             }
 
+            RefPtr<ParallelTaskRunner> __YYAPI ParallelTaskRunner::Create(uint32_t _uParallelMaximum, uint32_t _uNumaNode, uString _szThreadDescription) noexcept
+            {
+                return RefPtr<ParallelTaskRunnerImpl>::Create(_uParallelMaximum, std::move(_szThreadDescription), _uNumaNode);
+            }
+
             void __YYAPI Wait::OnCompleted(AsyncOperation<DWORD>* _pAsyncInfo, AsyncStatus _eStatus)
             {
                 auto _pThis = YY::RefPtr<Wait>::FromPtr(this);
@@ -1,9 +1,15 @@
 ﻿#include "ThreadPool.Linux.h"
 
 #include <signal.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
 
 #include <YY/Base/Sync/Sync.h>
 #include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Utils/SystemInfo.h>
+
+#include "TaskPriorityQueue.h"
 
 __YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
 
@@ -11,33 +17,169 @@ namespace YY::Base::Threading
 {
     constexpr uint32_t MinThreadsCount = 10;
     constexpr uint32_t MaxThreadsCount = 500;
+    // 最多按多少个 NUMA 节点分区，更多的节点按编号取余合并到已有分区
+    constexpr uint32_t kMaxNumaNodeCount = 8;
+
+    // 当前线程所属的线程池，非线程池线程为 nullptr
+    static thread_local ThreadPool* g_pCurrentThreadPool = nullptr;
 
-    HRESULT __YYAPI ThreadPool::ExecuteTask(ThreadPoolSimpleCallback _pfnCallback, void* _pUserData) noexcept
+    // 所有分区的线程总数，MaxThreadsCount 限制的是这个总数而不是单个分区的线程数
+    static volatile uint32_t g_uThreadCount = 0;
+    // 正在阻塞等待的线程池线程数，这些线程不占用 MaxThreadsCount 的名额
+    static volatile uint32_t g_uBlockedThreadCount = 0;
+
+    /// <summary>
+    /// 读取 sysfs 中的编号列表（比如 "0-7,16-23"），依次对每个编号调用 _pfnCallback，_pfnCallback 返回 false 时停止。
+    /// </summary>
+    /// <returns>至少有一个编号被 _pfnCallback 接受时返回 true。</returns>
+    template<typename Callback>
+    static bool __YYAPI ReadIdList(_In_z_ const char* _szPath, Callback&& _pfnCallback) noexcept
     {
-        auto _pThread = oIdleThreadQueue.Pop();
-        if (_pThread)
+        auto _pFile = fopen(_szPath, "re");
+        if (!_pFile)
+            return false;
+
+        char _szList[1024];
+        const auto _cchList = fread(_szList, 1, sizeof(_szList) - 1, _pFile);
+        fclose(_pFile);
+        _szList[_cchList] = '\0';
+
+        bool _bAny = false;
+        for (const char* _szItem = _szList;;)
         {
-            _pThread->pUserData = _pUserData;
-            _pThread->pfnCallback = _pfnCallback;
+            char* _szEnd;
+            const auto _uBegin = strtoul(_szItem, &_szEnd, 10);
+            if (_szEnd == _szItem)
+                break;
+
+            auto _uEnd = _uBegin;
+            if (*_szEnd == '-')
+            {
+                _szItem = _szEnd + 1;
+                _uEnd = strtoul(_szItem, &_szEnd, 10);
+                if (_szEnd == _szItem)
+                    break;
+            }
+
+            for (auto _uId = _uBegin; _uId <= _uEnd; ++_uId)
+            {
+                if (!_pfnCallback(uint32_t(_uId)))
+                    return _bAny;
+
+                _bAny = true;
+            }
+
+            if (*_szEnd != ',')
+                break;
+            _szItem = _szEnd + 1;
+        }
+
+        return _bAny;
+    }
+
+    /// <summary>
+    /// 读取 NUMA 节点包含的处理器。
+    /// </summary>
+    static bool __YYAPI GetNumaNodeCpuSet(_In_ uint32_t _uNumaNode, _Out_ cpu_set_t* _pCpuSet) noexcept
+    {
+        CPU_ZERO(_pCpuSet);
+
+        char _szPath[64];
+        snprintf(_szPath, sizeof(_szPath), "/sys/devices/system/node/node%u/cpulist", _uNumaNode);
+        return ReadIdList(
+            _szPath,
+            [_pCpuSet](uint32_t _uProcessor)
+            {
+                if (_uProcessor >= CPU_SETSIZE)
+                    return false;
+
+                CPU_SET(_uProcessor, _pCpuSet);
+                return true;
+            });
+    }
 
-            pthread_kill(_pThread->hThread, SIGUSR1);
+    HRESULT __YYAPI ThreadPool::ExecuteTask(ThreadPoolSimpleCallback _pfnCallback, void* _pUserData, TaskPriority _ePriority, uint32_t _uNumaNode) noexcept
+    {
+        auto _pPartitions = GetPartitions();
+        const auto _cPartitions = GetPartitionCount();
+
+        uint32_t _uPartition;
+        if (_cPartitions == 1)
+            _uPartition = 0;
+        else if (_uNumaNode != kAnyNumaNode)
+            _uPartition = GetPartitionIndex(_uNumaNode);
+        else if (g_pCurrentThreadPool)
+            _uPartition = uint32_t(g_pCurrentThreadPool - _pPartitions);
+        else
+            _uPartition = GetPartitionIndex(Utils::GetCurrentNumaNode());
+
+        auto& _oPartition = _pPartitions[_uPartition];
+        if (_oPartition.TryWakeupIdleThread(_pfnCallback, _pUserData))
             return S_OK;
+
+        if (_uNumaNode == kAnyNumaNode)
+        {
+            // 不限定节点时，唤醒其他分区的空闲线程比创建新线程的代价低得多
+            for (uint32_t _uIndex = 1; _uIndex < _cPartitions; ++_uIndex)
+            {
+                if (_pPartitions[(_uPartition + _uIndex) % _cPartitions].TryWakeupIdleThread(_pfnCallback, _pUserData))
+                    return S_OK;
+            }
         }
 
-        for (auto uCurrentThreadCount = uThreadCount;;)
+        return _oPartition.CreateThreadOrQueueTask(_pfnCallback, _pUserData, _ePriority, _uNumaNode != kAnyNumaNode && _cPartitions > 1);
+    }
+
+    bool __YYAPI ThreadPool::TryWakeupIdleThread(ThreadPoolSimpleCallback _pfnCallback, void* _pUserData) noexcept
+    {
+        auto _pThread = oIdleThreadQueue.Pop();
+        if (!_pThread)
+            return false;
+
+        _pThread->pUserData = _pUserData;
+        _pThread->pfnCallback = _pfnCallback;
+
+        pthread_kill(_pThread->hThread, SIGUSR1);
+        return true;
+    }
+
+    HRESULT __YYAPI ThreadPool::CreateThreadOrQueueTask(ThreadPoolSimpleCallback _pfnCallback, void* _pUserData, TaskPriority _ePriority, bool _bPinned) noexcept
+    {
+        for (auto uCurrentThreadCount = g_uThreadCount;;)
         {
-            if (uCurrentThreadCount >= MaxThreadsCount)
+            // 阻塞等待的线程不计入上限，否则所有线程都在等待排队中的任务时将永远无法完成。
+            // 限定节点的任务只能由本分区执行，本分区没有正在运行的线程时即使达到上限也要创建，否则任务永远无法开始。
+            if (uCurrentThreadCount >= MaxThreadsCount + g_uBlockedThreadCount && (!_bPinned || uThreadCount > uBlockedThreadCount))
             {
                 // 达到线程创建上限
                 auto _pTask = New<ThreadPoolTaskEntry>(_pfnCallback, _pUserData);
                 if(!_pTask)
                     return E_OUTOFMEMORY;
 
-                oPendingTaskQueue.Push(_pTask);
+                if (_bPinned)
+                {
+                    oPinnedPendingTaskQueue.Push(_pTask, _ePriority);
+
+                    // 其他分区不会窃取这个任务，本分区的线程可能刚好在排队前进入空闲，需要再唤醒一次
+                    TryWakeupIdleThread(nullptr, nullptr);
+                    return S_OK;
+                }
+
+                oPendingTaskQueue.Push(_pTask, _ePriority);
+
+                // 当前分区没有空闲线程，唤醒其他分区的一个空闲线程窃取刚排队的任务
+                auto _pPartitions = GetPartitions();
+                const auto _cPartitions = GetPartitionCount();
+                const auto _uPartition = uint32_t(this - _pPartitions);
+                for (uint32_t _uIndex = 1; _uIndex < _cPartitions; ++_uIndex)
+                {
+                    if (_pPartitions[(_uPartition + _uIndex) % _cPartitions].TryWakeupIdleThread(nullptr, nullptr))
+                        break;
+                }
                 return S_OK;
             }
 
-            const auto _uLast = Sync::CompareExchange(&uThreadCount, uCurrentThreadCount + 1, uCurrentThreadCount);
+            const auto _uLast = Sync::CompareExchange(&g_uThreadCount, uCurrentThreadCount + 1, uCurrentThreadCount);
             if (_uLast == uCurrentThreadCount)
             {
                 break;
@@ -46,10 +188,13 @@ namespace YY::Base::Threading
             uCurrentThreadCount = _uLast;
         }
 
-        _pThread = New<ThreadInfoEntry>();
+        Sync::Increment(&uThreadCount);
+
+        auto _pThread = New<ThreadInfoEntry>();
         if (!_pThread)
         {
             Sync::Decrement(&uThreadCount);
+            Sync::Decrement(&g_uThreadCount);
             return E_OUTOFMEMORY;
         }
 
@@ -70,6 +215,7 @@ namespace YY::Base::Threading
         }
 
         Sync::Decrement(&uThreadCount);
+        Sync::Decrement(&g_uThreadCount);
         Delete(_pThread);
 
         // TODO: 错误代码转换
@@ -83,6 +229,16 @@ namespace YY::Base::Threading
         sigaddset(&set, SIGUSR1);
         int signo;
 
+        g_pCurrentThreadPool = this;
+
+        if (GetPartitionCount() > 1)
+        {
+            // 分区内的线程固定在对应节点上，任务申请的内存按照首次访问原则也会落在该节点
+            cpu_set_t _oCpuSet;
+            if (GetNumaNodeCpuSet(uNumaNode, &_oCpuSet))
+                pthread_setaffinity_np(pthread_self(), sizeof(_oCpuSet), &_oCpuSet);
+        }
+
         for (;;)
         {
             if (_pThread->pfnCallback)
@@ -94,7 +250,7 @@ namespace YY::Base::Threading
 
             for (;;)
             {
-                auto _pTask = oPendingTaskQueue.Pop();
+                auto _pTask = PopOrStealPendingTask();
                 if (!_pTask)
                     break;
 
@@ -117,14 +273,128 @@ namespace YY::Base::Threading
         }
 
         Sync::Decrement(&uThreadCount);
+        Sync::Decrement(&g_uThreadCount);
         Delete(_pThread);
         pthread_detach(pthread_self());
         return nullptr;
     }
     
-    ThreadPool* __YYAPI ThreadPool::Get() noexcept
+    void __YYAPI ThreadPool::PendingTaskQueue::Push(ThreadPoolTaskEntry* _pTask, TaskPriority _ePriority) noexcept
+    {
+        auto _uPriority = size_t(_ePriority);
+        if (_uPriority >= size_t(TaskPriority::Count))
+            _uPriority = size_t(TaskPriority::Normal);
+
+        arrQueue[_uPriority].Push(_pTask);
+    }
+
+    ThreadPoolTaskEntry* __YYAPI ThreadPool::PendingTaskQueue::Pop() noexcept
+    {
+        // 与 TaskPriorityQueue 相同，定期优先尝试低优先级，避免 Background 任务在持续的高优先级负载下饿死
+        const auto _eFirst = GetStarvationBoostPriority(Sync::Increment(&uPopCount));
+        if (_eFirst != TaskPriority::UserBlocking)
+        {
+            if (auto _pTask = arrQueue[size_t(_eFirst)].Pop())
+                return _pTask;
+        }
+
+        for (auto& _oQueue : arrQueue)
+        {
+            if (auto _pTask = _oQueue.Pop())
+                return _pTask;
+        }
+
+        return nullptr;
+    }
+
+    ThreadPoolTaskEntry* __YYAPI ThreadPool::PopOrStealPendingTask() noexcept
     {
-        static ThreadPool s_ThreadPool;
-        return &s_ThreadPool;
+        // 限定节点的任务只有本分区能执行，优先处理
+        if (auto _pTask = oPinnedPendingTaskQueue.Pop())
+            return _pTask;
+
+        if (auto _pTask = oPendingTaskQueue.Pop())
+            return _pTask;
+
+        // 线程数上限是全局的，一个分区饱和时其他分区的空闲线程也不会再增加，只能由它们窃取排队的任务。
+        // 只窃取不限定节点的任务，限定节点的任务必须留在对应节点上执行。
+        auto _pPartitions = GetPartitions();
+        const auto _cPartitions = GetPartitionCount();
+        const auto _uPartition = uint32_t(this - _pPartitions);
+        for (uint32_t _uIndex = 1; _uIndex < _cPartitions; ++_uIndex)
+        {
+            if (auto _pTask = _pPartitions[(_uPartition + _uIndex) % _cPartitions].oPendingTaskQueue.Pop())
+                return _pTask;
+        }
+
+        return nullptr;
+    }
+
+    bool __YYAPI ThreadPool::EnterBlockingWait() noexcept
+    {
+        if (!g_pCurrentThreadPool)
+            return false;
+
+        Sync::Increment(&g_uBlockedThreadCount);
+        Sync::Increment(&g_pCurrentThreadPool->uBlockedThreadCount);
+        return true;
+    }
+
+    void __YYAPI ThreadPool::LeaveBlockingWait() noexcept
+    {
+        Sync::Decrement(&g_pCurrentThreadPool->uBlockedThreadCount);
+        Sync::Decrement(&g_uBlockedThreadCount);
+    }
+
+    ThreadPool* __YYAPI ThreadPool::GetPartitions() noexcept
+    {
+        static ThreadPool s_arrThreadPools[kMaxNumaNodeCount];
+        return s_arrThreadPools;
+    }
+
+    uint32_t __YYAPI ThreadPool::GetPartitionCount() noexcept
+    {
+        static const uint32_t s_cPartitions = InitializePartitions();
+        return s_cPartitions;
+    }
+
+    uint32_t __YYAPI ThreadPool::InitializePartitions() noexcept
+    {
+        auto _pPartitions = GetPartitions();
+        uint32_t _cPartitions = 0;
+
+        // 节点编号可能不连续（比如只有 node0 与 node2 在线），分区按在线节点的顺序记录真实的节点编号
+        ReadIdList(
+            "/sys/devices/system/node/online",
+            [_pPartitions, &_cPartitions](uint32_t _uNumaNode)
+            {
+                if (_cPartitions == kMaxNumaNodeCount)
+                    return false;
+
+                _pPartitions[_cPartitions++].uNumaNode = _uNumaNode;
+                return true;
+            });
+
+        // 不支持 NUMA 的内核没有 /sys/devices/system/node
+        if (_cPartitions == 0)
+        {
+            _pPartitions[0].uNumaNode = 0;
+            _cPartitions = 1;
+        }
+
+        return _cPartitions;
+    }
+
+    uint32_t __YYAPI ThreadPool::GetPartitionIndex(uint32_t _uNumaNode) noexcept
+    {
+        const auto _cPartitions = GetPartitionCount();
+        auto _pPartitions = GetPartitions();
+        for (uint32_t _uPartition = 0; _uPartition != _cPartitions; ++_uPartition)
+        {
+            if (_pPartitions[_uPartition].uNumaNode == _uNumaNode)
+                return _uPartition;
+        }
+
+        return _uNumaNode % _cPartitions;
     }
 }
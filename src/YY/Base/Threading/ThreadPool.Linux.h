@@ -4,6 +4,7 @@
 #include <YY/Base/ErrorCode.h>
 #include <YY/Base/Sync/InterlockedQueue.h>
 #include <YY/Base/Sync/InterlockedSingleLinkedList.h>
+#include <YY/Base/Threading/TaskRunner.h>
 
 #pragma pack(push, __YY_PACKING)
 
@@ -28,41 +29,69 @@ namespace YY::Base::Threading
         ThreadPool* pThreadPool = nullptr;
     };
 
+    /// <summary>
+    /// 按 NUMA 节点分区的线程池，每个在线节点一个 ThreadPool 实例（分区），分区内的线程固定在该节点的处理器上执行。
+    /// 不限定节点的任务优先交给当前节点的分区，当前分区没有空闲线程时先唤醒其他分区的空闲线程，最后才在当前分区创建新线程。
+    /// 线程数上限由所有分区共享。达到上限后任务在分区内排队，空闲线程会先处理自己分区的排队任务，再从其他分区窃取不限定节点的任务。
+    /// 限定节点的任务只会由该节点分区的线程执行。
+    /// </summary>
     class ThreadPool
     {
     private:
-        InterlockedSingleLinkedList<ThreadInfoEntry> oIdleThreadQueue;
-        InterlockedQueue<ThreadPoolTaskEntry> oPendingTaskQueue;
-
+        // 线程数达到上限时排队的任务，按 TaskPriority 分级，空闲线程优先取高优先级的任务
+        struct PendingTaskQueue
+        {
+            InterlockedQueue<ThreadPoolTaskEntry> arrQueue[size_t(TaskPriority::Count)];
+            // Pop 的调用次数，用于定期优先取低优先级的任务
+            volatile uint32_t uPopCount = 0;
+
+            void __YYAPI Push(_In_ ThreadPoolTaskEntry* _pTask, _In_ TaskPriority _ePriority) noexcept;
+
+            _Ret_maybenull_ ThreadPoolTaskEntry* __YYAPI Pop() noexcept;
+        };
+
+        InterlockedSingleLinkedList<ThreadInfoEntry, ProducerType::Multi, ConsumerType::Multi> oIdleThreadQueue;
+        // 不限定节点的排队任务，其他分区的空闲线程可以窃取
+        PendingTaskQueue oPendingTaskQueue;
+        // 限定到本分区节点的排队任务，只能由本分区的线程执行
+        PendingTaskQueue oPinnedPendingTaskQueue;
+        // 本分区的 NUMA 节点编号，节点编号可能不连续，因此不能用分区下标代替
+        uint32_t uNumaNode = 0;
+        // 本分区的线程数以及其中正在阻塞等待的线程数
         volatile uint32_t uThreadCount = 0;
+        volatile uint32_t uBlockedThreadCount = 0;
 
         constexpr ThreadPool() = default;
 
     public:
         template<typename Task>
-        static HRESULT __YYAPI PostTaskInternalWithoutAddRef(_In_ Task* _pTask) noexcept
+        static HRESULT __YYAPI PostTaskInternalWithoutAddRef(_In_ Task* _pTask, _In_ TaskPriority _ePriority = TaskPriority::Normal, _In_ uint32_t _uNumaNode = kAnyNumaNode) noexcept
         {
-            return Get()->ExecuteTask(
+            return ExecuteTask(
                 [](_In_ void* _pUserData)
                 {
                     auto _pTask = reinterpret_cast<Task*>(_pUserData);
                     _pTask->operator()();
                 },
-                _pTask);
+                _pTask,
+                _ePriority,
+                _uNumaNode);
         }
 
         template<typename Task>
-        static HRESULT __YYAPI PostTaskInternal(_In_ Task* _pTask) noexcept
+        static HRESULT __YYAPI PostTaskInternal(_In_ Task* _pTask, _In_ TaskPriority _ePriority = TaskPriority::Normal, _In_ uint32_t _uNumaNode = kAnyNumaNode) noexcept
         {
             _pTask->AddRef();
-            auto _hr = Get()->ExecuteTask(
+            auto _hr = ExecuteTask(
                 [](_In_ void* _pUserData)
                 {
                     auto _pTask = reinterpret_cast<Task*>(_pUserData);
                     _pTask->operator()();
                     _pTask->Release();
                 },
-                _pTask);
+                _pTask,
+                _ePriority,
+                _uNumaNode);
 
             if (FAILED(_hr))
             {
@@ -71,12 +100,73 @@ namespace YY::Base::Threading
             return _hr;
         }
 
+        /// <summary>
+        /// 新建一个不属于线程池的线程执行 _pTask，_pTask 返回后线程结束。适合需要长期独占线程的任务。
+        /// </summary>
+        template<typename Task>
+        static HRESULT __YYAPI CreateDedicatedThread(_In_ Task* _pTask) noexcept
+        {
+            _pTask->AddRef();
+            pthread_t _hThread;
+            const auto _iResult = pthread_create(&_hThread, nullptr,
+                [](void* _pUserData) -> void*
+                {
+                    auto _pTask = reinterpret_cast<Task*>(_pUserData);
+                    _pTask->operator()();
+                    _pTask->Release();
+                    return nullptr;
+                }, _pTask);
+
+            if (_iResult != 0)
+            {
+                _pTask->Release();
+                return E_FAIL;
+            }
+
+            pthread_detach(_hThread);
+            return S_OK;
+        }
+
+        /// <summary>
+        /// 当前线程即将阻塞等待时调用，通知线程池当前线程已经阻塞，线程池可以据此补充线程。
+        /// </summary>
+        /// <returns>当前线程是线程池线程并且已经通知线程池时返回 true，此时等待结束后需要调用 LeaveBlockingWait。</returns>
+        static bool __YYAPI EnterBlockingWait() noexcept;
+
+        static void __YYAPI LeaveBlockingWait() noexcept;
+
     private:
         void* TaskExecuteRoutine(ThreadInfoEntry* _pThread) noexcept;
 
-        static _Ret_notnull_ ThreadPool* __YYAPI Get() noexcept;
+        /// <summary>
+        /// 返回所有分区。分区下标不是 NUMA 节点编号，节点编号保存在分区的 uNumaNode 中。
+        /// </summary>
+        static _Ret_notnull_ ThreadPool* __YYAPI GetPartitions() noexcept;
+
+        static uint32_t __YYAPI GetPartitionCount() noexcept;
+
+        /// <summary>
+        /// 读取在线的 NUMA 节点，每个节点初始化一个分区。
+        /// </summary>
+        /// <returns>分区数，至少为 1。</returns>
+        static uint32_t __YYAPI InitializePartitions() noexcept;
+
+        /// <summary>
+        /// 返回 NUMA 节点对应的分区下标。超出分区数量的节点按编号取余合并到已有分区。
+        /// </summary>
+        static uint32_t __YYAPI GetPartitionIndex(_In_ uint32_t _uNumaNode) noexcept;
+
+        static HRESULT __YYAPI ExecuteTask(_In_ ThreadPoolSimpleCallback _pfnCallback, _In_opt_ void* _pUserData, _In_ TaskPriority _ePriority, _In_ uint32_t _uNumaNode) noexcept;
+
+        bool __YYAPI TryWakeupIdleThread(_In_ ThreadPoolSimpleCallback _pfnCallback, _In_opt_ void* _pUserData) noexcept;
+
+        /// <param name="_bPinned">任务是否限定在本分区的节点上执行。限定节点的任务不会被其他分区窃取。</param>
+        HRESULT __YYAPI CreateThreadOrQueueTask(_In_ ThreadPoolSimpleCallback _pfnCallback, _In_opt_ void* _pUserData, _In_ TaskPriority _ePriority, _In_ bool _bPinned) noexcept;
 
-        HRESULT __YYAPI ExecuteTask(_In_ ThreadPoolSimpleCallback _pfnCallback, _In_opt_ void* _pUserData) noexcept;
+        /// <summary>
+        /// 先从当前分区取排队的任务（限定节点的优先），没有时再从其他分区窃取不限定节点的任务。
+        /// </summary>
+        _Ret_maybenull_ ThreadPoolTaskEntry* __YYAPI PopOrStealPendingTask() noexcept;
     };
 }
 
@@ -8,6 +8,47 @@ namespace YY
     {
         namespace Threading
         {
+            // 当前线程正在执行的线程池回调，通知过 CallbackMayRunLong 后置空
+            static thread_local PTP_CALLBACK_INSTANCE g_pCallbackInstance = nullptr;
+
+            bool __YYAPI ThreadPool::EnterBlockingWait() noexcept
+            {
+                auto _pInstance = g_pCallbackInstance;
+                if (!_pInstance)
+                    return false;
+
+                // 同一个回调只需要通知一次，系统线程池会在可运行的线程不足时补充线程
+                g_pCallbackInstance = nullptr;
+                CallbackMayRunLong(_pInstance);
+                return true;
+            }
+
+            void __YYAPI ThreadPool::LeaveBlockingWait() noexcept
+            {
+                // CallbackMayRunLong 无法撤销，回调返回后系统线程池会自动回收多余的线程
+            }
+
+            bool __YYAPI ThreadPool::EnterNumaNode(uint32_t _uNumaNode, GROUP_AFFINITY* _pPreviousAffinity) noexcept
+            {
+                if (_uNumaNode == kAnyNumaNode || _uNumaNode > MAXUSHORT)
+                    return false;
+
+                GROUP_AFFINITY _oAffinity = {};
+                if (!GetNumaNodeProcessorMaskEx(USHORT(_uNumaNode), &_oAffinity) || _oAffinity.Mask == 0)
+                    return false;
+
+                return SetThreadGroupAffinity(GetCurrentThread(), &_oAffinity, _pPreviousAffinity) != FALSE;
+            }
+
+            void __YYAPI ThreadPool::LeaveNumaNode(const GROUP_AFFINITY& _oPreviousAffinity) noexcept
+            {
+                SetThreadGroupAffinity(GetCurrentThread(), &_oPreviousAffinity, nullptr);
+            }
+
+            void __YYAPI ThreadPool::SetCurrentCallbackInstance(PTP_CALLBACK_INSTANCE _pInstance) noexcept
+            {
+                g_pCallbackInstance = _pInstance;
+            }
         }
     }
 }
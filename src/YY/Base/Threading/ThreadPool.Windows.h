@@ -2,6 +2,7 @@
 
 #include <YY/Base/Memory/RefPtr.h>
 #include <YY/Base/ErrorCode.h>
+#include <YY/Base/Threading/TaskRunner.h>
 
 #pragma pack(push, __YY_PACKING)
 
@@ -14,36 +15,45 @@ namespace YY
             class ThreadPool
             {
             public:
+                /// <summary>
+                /// 系统线程池不区分 NUMA 节点，_uNumaNode 只用于与 Linux 版本保持一致，需要固定节点的任务在执行时自行调用 EnterNumaNode。
+                /// </summary>
                 template<typename Task>
-                static HRESULT __YYAPI PostTaskInternalWithoutAddRef(_In_ Task* _pTask) noexcept
+                static HRESULT __YYAPI PostTaskInternalWithoutAddRef(_In_ Task* _pTask, _In_ TaskPriority _ePriority = TaskPriority::Normal, _In_ uint32_t _uNumaNode = kAnyNumaNode) noexcept
                 {
+                    UNREFERENCED_PARAMETER(_uNumaNode);
                     auto _bRet = TrySubmitThreadpoolCallback(
                         [](_Inout_ PTP_CALLBACK_INSTANCE _pInstance,
                             _In_   PVOID _pContext)
                         {
                             auto _pTask = reinterpret_cast<Task*>(_pContext);
+                            SetCurrentCallbackInstance(_pInstance);
                             _pTask->operator()();
+                            SetCurrentCallbackInstance(nullptr);
                         },
                         _pTask,
-                        nullptr);
+                        GetCallbackEnviron(_ePriority));
 
                     return _bRet ? S_OK : HRESULT_From_LSTATUS(GetLastError());
                 }
 
                 template<typename Task>
-                static HRESULT __YYAPI PostTaskInternal(_In_ Task* _pTask) noexcept
+                static HRESULT __YYAPI PostTaskInternal(_In_ Task* _pTask, _In_ TaskPriority _ePriority = TaskPriority::Normal, _In_ uint32_t _uNumaNode = kAnyNumaNode) noexcept
                 {
+                    UNREFERENCED_PARAMETER(_uNumaNode);
                     _pTask->AddRef();
                     auto _bRet = TrySubmitThreadpoolCallback(
                         [](_Inout_ PTP_CALLBACK_INSTANCE _pInstance,
                             _In_   PVOID _pContext)
                         {
                             auto _pTask = reinterpret_cast<Task*>(_pContext);
+                            SetCurrentCallbackInstance(_pInstance);
                             _pTask->operator()();
+                            SetCurrentCallbackInstance(nullptr);
                             _pTask->Release();
                         },
                         _pTask,
-                        nullptr);
+                        GetCallbackEnviron(_ePriority));
 
                     if (!_bRet)
                     {
@@ -54,6 +64,90 @@ namespace YY
 
                     return S_OK;
                 }
+
+                /// <summary>
+                /// 新建一个不属于线程池的线程执行 _pTask，_pTask 返回后线程结束。适合需要长期独占线程的任务。
+                /// </summary>
+                template<typename Task>
+                static HRESULT __YYAPI CreateDedicatedThread(_In_ Task* _pTask) noexcept
+                {
+                    _pTask->AddRef();
+                    auto _hThread = CreateThread(
+                        nullptr,
+                        0,
+                        [](_In_ LPVOID _pContext) -> DWORD
+                        {
+                            auto _pTask = reinterpret_cast<Task*>(_pContext);
+                            _pTask->operator()();
+                            _pTask->Release();
+                            return 0;
+                        },
+                        _pTask,
+                        0,
+                        nullptr);
+
+                    if (!_hThread)
+                    {
+                        auto _hr = HRESULT_From_LSTATUS(GetLastError());
+                        _pTask->Release();
+                        return _hr;
+                    }
+
+                    CloseHandle(_hThread);
+                    return S_OK;
+                }
+
+                /// <summary>
+                /// 当前线程即将阻塞等待时调用，通知线程池当前线程已经阻塞，线程池可以据此补充线程。
+                /// </summary>
+                /// <returns>当前线程是线程池线程并且已经通知线程池时返回 true，此时等待结束后需要调用 LeaveBlockingWait。</returns>
+                static bool __YYAPI EnterBlockingWait() noexcept;
+
+                static void __YYAPI LeaveBlockingWait() noexcept;
+
+                /// <summary>
+                /// 将当前线程的亲和性限定到 _uNumaNode 的处理器上。
+                /// </summary>
+                /// <param name="_pPreviousAffinity">返回原来的亲和性，需要传给 LeaveNumaNode 恢复。</param>
+                /// <returns>成功修改亲和性时返回 true，此时需要调用 LeaveNumaNode。</returns>
+                static bool __YYAPI EnterNumaNode(_In_ uint32_t _uNumaNode, _Out_ GROUP_AFFINITY* _pPreviousAffinity) noexcept;
+
+                static void __YYAPI LeaveNumaNode(_In_ const GROUP_AFFINITY& _oPreviousAffinity) noexcept;
+
+            private:
+                static void __YYAPI SetCurrentCallbackInstance(_In_opt_ PTP_CALLBACK_INSTANCE _pInstance) noexcept;
+
+                /// <summary>
+                /// 返回指定优先级对应的线程池回调环境。线程池优先调度高优先级的回调。
+                /// </summary>
+                static _Ret_maybenull_ PTP_CALLBACK_ENVIRON __YYAPI GetCallbackEnviron(_In_ TaskPriority _ePriority) noexcept
+                {
+#if _WIN32_WINNT >= 0x0601
+                    if (_ePriority == TaskPriority::Normal)
+                        return nullptr;
+
+                    struct CallbackEnvirons
+                    {
+                        TP_CALLBACK_ENVIRON oUserBlocking;
+                        TP_CALLBACK_ENVIRON oBackground;
+
+                        CallbackEnvirons() noexcept
+                        {
+                            InitializeThreadpoolEnvironment(&oUserBlocking);
+                            SetThreadpoolCallbackPriority(&oUserBlocking, TP_CALLBACK_PRIORITY_HIGH);
+                            InitializeThreadpoolEnvironment(&oBackground);
+                            SetThreadpoolCallbackPriority(&oBackground, TP_CALLBACK_PRIORITY_LOW);
+                        }
+                    };
+                    static CallbackEnvirons s_oCallbackEnvirons;
+
+                    return _ePriority == TaskPriority::UserBlocking ? &s_oCallbackEnvirons.oUserBlocking : &s_oCallbackEnvirons.oBackground;
+#else
+                    // Windows 7 之前的线程池不支持回调优先级
+                    UNREFERENCED_PARAMETER(_ePriority);
+                    return nullptr;
+#endif
+                }
             };
         }
     }
@@ -5,6 +5,11 @@
 
 #include "TaskRunnerDispatchImpl.h"
 
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 __YY_IGNORE_INCONSISTENT_ANNOTATION_FOR_FUNCTION()
 
 namespace YY
@@ -13,6 +18,94 @@ namespace YY
     {
         namespace Threading
         {
+            /// <summary>
+            /// 在作用域内按照 ThreadTaskRunnerOptions 修改当前线程的亲和性以及调度优先级，离开作用域时还原。
+            /// </summary>
+            class ThreadSchedulingScope
+            {
+            private:
+#if defined(_WIN32)
+                GROUP_AFFINITY oPreviousAffinity = {};
+                int iPreviousPriority = THREAD_PRIORITY_ERROR_RETURN;
+#else
+                cpu_set_t oPreviousCpuSet;
+                int iPreviousPolicy = -1;
+                sched_param oPreviousParam = {};
+#endif
+                bool bAffinityChanged = false;
+
+            public:
+                ThreadSchedulingScope(_In_ uint64_t _fProcessorAffinityMask, _In_ ThreadSchedulingPriority _ePriority) noexcept
+                {
+#if defined(_WIN32)
+                    if (_fProcessorAffinityMask)
+                    {
+                        GROUP_AFFINITY _oAffinity = {};
+                        if (GetThreadGroupAffinity(GetCurrentThread(), &_oAffinity))
+                        {
+                            _oAffinity.Mask = KAFFINITY(_fProcessorAffinityMask);
+                            bAffinityChanged = SetThreadGroupAffinity(GetCurrentThread(), &_oAffinity, &oPreviousAffinity) != FALSE;
+                        }
+                    }
+
+                    if (_ePriority != ThreadSchedulingPriority::Default)
+                    {
+                        iPreviousPriority = GetThreadPriority(GetCurrentThread());
+                        const auto _iPriority = _ePriority == ThreadSchedulingPriority::TimeCritical ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+                        if (iPreviousPriority != THREAD_PRIORITY_ERROR_RETURN && !SetThreadPriority(GetCurrentThread(), _iPriority))
+                            iPreviousPriority = THREAD_PRIORITY_ERROR_RETURN;
+                    }
+#else
+                    if (_fProcessorAffinityMask && pthread_getaffinity_np(pthread_self(), sizeof(oPreviousCpuSet), &oPreviousCpuSet) == 0)
+                    {
+                        cpu_set_t _oCpuSet;
+                        CPU_ZERO(&_oCpuSet);
+                        for (uint32_t _uProcessor = 0; _uProcessor != 64; ++_uProcessor)
+                        {
+                            if (_fProcessorAffinityMask & (uint64_t(1) << _uProcessor))
+                                CPU_SET(_uProcessor, &_oCpuSet);
+                        }
+
+                        bAffinityChanged = pthread_setaffinity_np(pthread_self(), sizeof(_oCpuSet), &_oCpuSet) == 0;
+                    }
+
+                    if (_ePriority != ThreadSchedulingPriority::Default && pthread_getschedparam(pthread_self(), &iPreviousPolicy, &oPreviousParam) == 0)
+                    {
+                        // 实时调度策略需要 CAP_SYS_NICE 或者 RLIMIT_RTPRIO，没有权限时保持原来的调度策略
+                        const int _iPolicy = _ePriority == ThreadSchedulingPriority::TimeCritical ? SCHED_FIFO : SCHED_RR;
+                        sched_param _oParam = {};
+                        _oParam.sched_priority = _ePriority == ThreadSchedulingPriority::TimeCritical ? sched_get_priority_max(_iPolicy) : sched_get_priority_min(_iPolicy);
+                        if (pthread_setschedparam(pthread_self(), _iPolicy, &_oParam) != 0)
+                            iPreviousPolicy = -1;
+                    }
+                    else
+                    {
+                        iPreviousPolicy = -1;
+                    }
+#endif
+                }
+
+                ThreadSchedulingScope(const ThreadSchedulingScope&) = delete;
+                ThreadSchedulingScope& operator=(const ThreadSchedulingScope&) = delete;
+
+                ~ThreadSchedulingScope()
+                {
+#if defined(_WIN32)
+                    if (iPreviousPriority != THREAD_PRIORITY_ERROR_RETURN)
+                        SetThreadPriority(GetCurrentThread(), iPreviousPriority);
+
+                    if (bAffinityChanged)
+                        SetThreadGroupAffinity(GetCurrentThread(), &oPreviousAffinity, nullptr);
+#else
+                    if (iPreviousPolicy != -1)
+                        pthread_setschedparam(pthread_self(), iPreviousPolicy, &oPreviousParam);
+
+                    if (bAffinityChanged)
+                        pthread_setaffinity_np(pthread_self(), sizeof(oPreviousCpuSet), &oPreviousCpuSet);
+#endif
+                }
+            };
+
             ThreadTaskRunnerImpl::ThreadTaskRunnerImpl(uint32_t _uThreadId, bool _bBackgroundLoop, uString _szThreadDescription)
                 : uWakeupCountAndPushLock(_bBackgroundLoop ? (BackgroundLoopRaw) : 0)
                 , uThreadId(_uThreadId)
@@ -20,6 +113,16 @@ namespace YY
             {
             }
 
+            ThreadTaskRunnerImpl::ThreadTaskRunnerImpl(const ThreadTaskRunnerOptions& _oOptions)
+                : uWakeupCountAndPushLock(_oOptions.bBackgroundLoop ? (BackgroundLoopRaw) : 0)
+                , uThreadId(0u)
+                , szThreadDescription(_oOptions.szThreadDescription)
+                , fProcessorAffinityMask(_oOptions.fProcessorAffinityMask)
+                , ePriority(_oOptions.ePriority)
+                , uBusyPollTime(_oOptions.uBusyPollTime)
+            {
+            }
+
             ThreadTaskRunnerImpl::~ThreadTaskRunnerImpl()
             {
                 CleanupTaskQueue();
@@ -193,6 +296,11 @@ namespace YY
                                 }
                             }
 
+                            if (uBusyPollTime.GetTicks() > 0 && BusyPoll(_oCurrent))
+                            {
+                                continue;
+                            }
+
                             // uWakeupCount 已经归零，准备进入睡眠状态
                             const auto _uTimerWakeupTickCount = ThreadTaskRunnerTimerManger::GetMinimumWakeupTickCount();
                             const auto _uWaitWakeupTickCount = ThreadTaskRunnerWaitManger::GetMinimumWakeupTickCount();
@@ -257,6 +365,27 @@ namespace YY
                 return _oMsg.wParam;
             }
 
+            bool __YYAPI ThreadTaskRunnerImpl::BusyPoll(TickCount _oCurrent) noexcept
+            {
+                const auto _uTimerWakeupTickCount = ThreadTaskRunnerTimerManger::GetMinimumWakeupTickCount();
+                const auto _uWaitWakeupTickCount = ThreadTaskRunnerWaitManger::GetMinimumWakeupTickCount();
+                const auto _uExpire = (std::min)(_oCurrent + uBusyPollTime, (std::min)(_uTimerWakeupTickCount, _uWaitWakeupTickCount));
+
+                Sync::BitSet(&uWakeupCountAndPushLock, BusyPollingBitIndex);
+                while (uWakeupCountAndPushLock / WakeupOnceRaw < uTaskRunnerReentryCount)
+                {
+                    if (IsShared() == false || bInterrupt || TickCount::GetNow() >= _uExpire)
+                        break;
+
+                    YieldProcessor();
+                }
+
+                // 清除标记前投递的任务不会唤醒线程，所以清除后必须重新检查任务数
+                Sync::BitReset(&uWakeupCountAndPushLock, BusyPollingBitIndex);
+                uPendingTaskCount = uWakeupCountAndPushLock / WakeupOnceRaw;
+                return uPendingTaskCount >= uTaskRunnerReentryCount;
+            }
+
             void __YYAPI ThreadTaskRunnerImpl::EnableWakeup(bool _bEnable)
             {
                 if (_bEnable)
@@ -291,10 +420,53 @@ namespace YY
                 // 因为刚才 uWakeupCountAndPushLock 已经将第一个标记位设置位 1
                 // 所以我们再 uWakeupCountAndPushLock += 1即可。
                 // uWakeupCount + 1 <==> uWakeupCountAndPushLock + 2 <==> (uWakeupCountAndPushLock | 1) + 1
-                if (Sync::Add(&uWakeupCountAndPushLock, uint32_t(UnlockQueuePushLockBitAndWakeupOnceRaw)) < WakeupOnceRaw * (2u + uTaskRunnerReentryCount))
+                const auto _uNewWakeupCountAndPushLock = Sync::Add(&uWakeupCountAndPushLock, uint32_t(UnlockQueuePushLockBitAndWakeupOnceRaw));
+                if (_uNewWakeupCountAndPushLock < WakeupOnceRaw * (2u + uTaskRunnerReentryCount) && (_uNewWakeupCountAndPushLock & BusyPollingRaw) == 0)
                 {
                     // 为 1 是说明当前正在等待输入消息，并且未主动唤醒
                     // 如果唤醒失败处理，暂时不做处理，可能是当前系统资源不足，既然已经加入了队列我们先这样吧。
+                    // 忙等待时线程会自行发现新任务，无需唤醒。
+                    Wakeup();
+                }
+                return S_OK;
+            }
+
+            HRESULT __YYAPI ThreadTaskRunnerImpl::PostTasksInternal(Span<TaskEntry*> _oTasks)
+            {
+                const auto _cTasks = uint32_t(_oTasks.GetSize());
+                if (_cTasks == 0)
+                    return S_OK;
+
+                for (auto _pTask : _oTasks)
+                {
+                    _pTask->hr = E_PENDING;
+                }
+
+                if (bStopWakeup)
+                {
+                    for (auto _pTask : _oTasks)
+                    {
+                        RefPtr<TaskEntry>::FromPtr(_pTask)->Wakeup(YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED));
+                    }
+                    return YY::Base::HRESULT_From_LSTATUS(ERROR_CANCELLED);
+                }
+
+                for (;;)
+                {
+                    if (!Sync::BitSet(&uWakeupCountAndPushLock, LockedQueuePushBitIndex))
+                    {
+                        for (auto _pTask : _oTasks)
+                        {
+                            oTaskQueue.Push(_pTask);
+                        }
+                        break;
+                    }
+                }
+
+                // 与 PostTaskInternal 相同，解除锁定并且 uWakeupCount += _cTasks，只在增加前线程处于等待状态时唤醒一次。
+                const auto _uNewWakeupCountAndPushLock = Sync::Add(&uWakeupCountAndPushLock, uint32_t(WakeupOnceRaw * _cTasks - (1u << LockedQueuePushBitIndex)));
+                if (_uNewWakeupCountAndPushLock - WakeupOnceRaw * (_cTasks - 1) < WakeupOnceRaw * (2u + uTaskRunnerReentryCount) && (_uNewWakeupCountAndPushLock & BusyPollingRaw) == 0)
+                {
                     Wakeup();
                 }
                 return S_OK;
@@ -394,7 +566,10 @@ namespace YY
                     SetThreadDescription(GetCurrentThread(), szThreadDescription);
 #endif
 
-                RunTaskRunnerLoop();
+                {
+                    ThreadSchedulingScope _oSchedulingScope(fProcessorAffinityMask, ePriority);
+                    RunTaskRunnerLoop();
+                }
 
                 uThreadId = UINT32_MAX;
                 g_pTaskRunnerWeak = nullptr;
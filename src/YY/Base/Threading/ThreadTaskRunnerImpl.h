@@ -8,6 +8,7 @@
 #include <YY/Base/Threading/ProcessThreads.h>
 
 #include "TaskRunnerImpl.h"
+#include "TaskPriorityQueue.h"
 #include "ThreadTaskRunnerTimerManger.h"
 #include "ThreadTaskRunnerWaitManger.h"
 
@@ -32,10 +33,10 @@ namespace YY
                 , public ThreadTaskRunnerWaitManger
             {
             private:
-                InterlockedQueue<TaskEntry> oTaskQueue;
+                TaskPriorityQueue oTaskQueue;
 
-                // |uWeakupCount| bStopWakeup | bPushLock |
-                // | 31   ~   2 |     1       |    0      |
+                // |uWeakupCount| bBusyPolling | bBackgroundLoop | bInterrupt | bStopWakeup | bPushLock |
+                // | 31   ~   5 |      4       |        3        |     2      |     1       |    0      |
                 union
                 {
                     volatile uint32_t uWakeupCountAndPushLock;
@@ -45,7 +46,9 @@ namespace YY
                         volatile uint32_t bStopWakeup : 1;
                         volatile uint32_t bInterrupt : 1;
                         volatile uint32_t bBackgroundLoop : 1;
-                        uint32_t uWakeupCount : 28;
+                        // 正在忙等待，投递任务时无需唤醒线程
+                        volatile uint32_t bBusyPolling : 1;
+                        uint32_t uWakeupCount : 27;
                     };
                 };
                 enum : uint32_t
@@ -54,10 +57,12 @@ namespace YY
                     StopWakeupBitIndex,
                     InterruptBitIndex,
                     BackgroundLoopIndex,
+                    BusyPollingBitIndex,
                     WakeupCountStartBitIndex,
                     StopWakeupRaw = 1 << StopWakeupBitIndex,
                     InterruptRaw = 1 << InterruptBitIndex,
                     BackgroundLoopRaw = 1 << BackgroundLoopIndex,
+                    BusyPollingRaw = 1 << BusyPollingBitIndex,
                     WakeupOnceRaw = 1 << WakeupCountStartBitIndex,
                     UnlockQueuePushLockBitAndWakeupOnceRaw = WakeupOnceRaw - (1u << LockedQueuePushBitIndex),
                     TerminateTaskRunnerRaw = StopWakeupRaw | InterruptRaw,
@@ -68,10 +73,18 @@ namespace YY
                 uint32_t uPendingTaskCount = 0;
                 uint32_t uProcessedTaskCount = 0;
                 uString szThreadDescription;
+                uint64_t fProcessorAffinityMask = 0;
+                ThreadSchedulingPriority ePriority = ThreadSchedulingPriority::Default;
+                TimeSpan uBusyPollTime;
 
             public:
                 ThreadTaskRunnerImpl(_In_ uint32_t _uThreadId = Threading::GetCurrentThreadId(), _In_ bool _bBackgroundLoop = false, uString _szThreadDescription = uString());
 
+                /// <summary>
+                /// 创建一个尚未绑定线程的TaskRunner，需要投递到线程池或者独占线程后执行。
+                /// </summary>
+                ThreadTaskRunnerImpl(_In_ const ThreadTaskRunnerOptions& _oOptions);
+
                 /// <summary>
                 /// 从线程池借用一个线程，执行TaskRunner。
                 /// </summary>
@@ -109,6 +122,8 @@ namespace YY
             private:
                 HRESULT __YYAPI PostTaskInternal(_In_ RefPtr<TaskEntry> _pTask) override;
 
+                HRESULT __YYAPI PostTasksInternal(_In_ Span<TaskEntry*> _oTasks) override;
+
                 HRESULT __YYAPI SetTimerInternal(_In_ RefPtr<Timer> _pTask) override;
 
                 HRESULT __YYAPI SetWaitInternal(_In_ RefPtr<WaitAsyncOperation> _pTask) override;
@@ -128,6 +143,12 @@ namespace YY
                 /// </summary>
                 /// <returns></returns>
                 uintptr_t __YYAPI RunBackgroundLoop();
+
+                /// <summary>
+                /// 任务队列为空时忙等待新任务，最长 uBusyPollTime，并且不超过下一个定时器或者等待的到期时间。
+                /// </summary>
+                /// <returns>等到了新任务时返回 true，此时 uPendingTaskCount 已经更新。</returns>
+                bool __YYAPI BusyPoll(_In_ TickCount _oCurrent) noexcept;
             };
         }
     }
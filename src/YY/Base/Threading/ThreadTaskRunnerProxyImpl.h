@@ -21,7 +21,7 @@ namespace YY
                 static constexpr auto kTimerTaskTimerId = 100;
 
             private:
-                InterlockedQueue<TaskEntry> oTaskQueue;
+                TaskPriorityQueue oTaskQueue;
 
                 union
                 {
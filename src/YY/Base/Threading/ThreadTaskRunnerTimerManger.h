@@ -51,9 +51,10 @@ namespace YY
                 TimingWheelSimpleList arrTimingWheelOthers;
 
                 // TimingWheel的位图缓存，加速轮子的遍历过程
-                BitMap<sizeof(arrTimingWheel1) / sizeof(arrTimingWheel1[0])> oTimingWheel1BitMap;
-                BitMap<sizeof(arrTimingWheel2) / sizeof(arrTimingWheel2[0])> oTimingWheel2BitMap;
-                BitMap<sizeof(arrTimingWheel3) / sizeof(arrTimingWheel3[0])> oTimingWheel3BitMap;
+                // 时间轮只在所属线程中访问，因此使用非原子位图。
+                BitMap<sizeof(arrTimingWheel1) / sizeof(arrTimingWheel1[0]), false> oTimingWheel1BitMap;
+                BitMap<sizeof(arrTimingWheel2) / sizeof(arrTimingWheel2[0]), false> oTimingWheel2BitMap;
+                BitMap<sizeof(arrTimingWheel3) / sizeof(arrTimingWheel3[0]), false> oTimingWheel3BitMap;
 
             protected:
                 ThreadTaskRunnerTimerManger()
@@ -2,9 +2,26 @@
 
 #include <YY/Base/Utils/SystemInfo.h>
 
+#include <YY/Base/Sync/Interlocked.h>
+#include <YY/Base/Time/TickCount.h>
+
+#if defined(_WIN32)
 #define WIN32_NO_STATUS
 #include <YY/Base/Shared/Windows/km.h>
 
+#include <YY/Base/Memory/Alloc.h>
+#include <YY/Base/Memory/UniquePtr.h>
+#else
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/sysinfo.h>
+#include <sys/syscall.h>
+#endif
+
 namespace YY
 {
     namespace Base
@@ -50,7 +67,503 @@ namespace YY
 
                 return _uOsVersion;
             }
+
+            static uint32_t __YYAPI CountBits(KAFFINITY _fMask) noexcept
+            {
+                uint32_t _cBits = 0;
+                for (; _fMask; _fMask &= _fMask - 1)
+                {
+                    ++_cBits;
+                }
+                return _cBits;
+            }
+
+            static ProcessorInfo __YYAPI QueryProcessorTopology() noexcept
+            {
+                ProcessorInfo _oInfo;
+
+                do
+                {
+                    DWORD _cbData = 0;
+                    if (!GetLogicalProcessorInformationEx(LOGICAL_PROCESSOR_RELATIONSHIP::RelationAll, nullptr, &_cbData))
+                    {
+                        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+                            break;
+                    }
+
+                    UniquePtr<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX> _pBuffer((SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)Memory::Alloc(_cbData));
+                    if (!_pBuffer)
+                        break;
+
+                    if (!GetLogicalProcessorInformationEx(LOGICAL_PROCESSOR_RELATIONSHIP::RelationAll, _pBuffer, &_cbData))
+                        break;
+
+                    for (DWORD _cbOffset = 0; _cbOffset < _cbData;)
+                    {
+                        auto _pEntry = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*)((char*)_pBuffer.Get() + _cbOffset);
+                        switch (_pEntry->Relationship)
+                        {
+                        case LOGICAL_PROCESSOR_RELATIONSHIP::RelationProcessorCore:
+                        {
+                            ++_oInfo.cPhysicalCores;
+                            uint32_t _cCoreProcessors = 0;
+                            for (WORD _uGroup = 0; _uGroup != _pEntry->Processor.GroupCount; ++_uGroup)
+                            {
+                                _cCoreProcessors += CountBits(_pEntry->Processor.GroupMask[_uGroup].Mask);
+                            }
+                            _oInfo.cLogicalProcessors += _cCoreProcessors;
+                            if (_cCoreProcessors > _oInfo.cSmtSiblings)
+                                _oInfo.cSmtSiblings = _cCoreProcessors;
+                            break;
+                        }
+                        case LOGICAL_PROCESSOR_RELATIONSHIP::RelationNumaNode:
+                            ++_oInfo.cNumaNodes;
+                            break;
+                        case LOGICAL_PROCESSOR_RELATIONSHIP::RelationCache:
+                        {
+                            const auto& _oCache = _pEntry->Cache;
+                            if (_oCache.Type != PROCESSOR_CACHE_TYPE::CacheData && _oCache.Type != PROCESSOR_CACHE_TYPE::CacheUnified)
+                                break;
+
+                            // 同一级缓存会按核心（或者核心组）重复出现，只取第一个
+                            uint32_t* _pcbCache = nullptr;
+                            if (_oCache.Level == 1)
+                                _pcbCache = &_oInfo.cbL1DataCache;
+                            else if (_oCache.Level == 2)
+                                _pcbCache = &_oInfo.cbL2Cache;
+                            else if (_oCache.Level == 3)
+                                _pcbCache = &_oInfo.cbL3Cache;
+
+                            if (_pcbCache && *_pcbCache == 0)
+                                *_pcbCache = _oCache.CacheSize;
+
+                            if (_oInfo.cbCacheLine == 0)
+                                _oInfo.cbCacheLine = _oCache.LineSize;
+                            break;
+                        }
+                        default:
+                            break;
+                        }
+
+                        if (_pEntry->Size == 0)
+                            break;
+                        _cbOffset += _pEntry->Size;
+                    }
+                } while (false);
+
+                if (_oInfo.cLogicalProcessors == 0)
+                {
+                    SYSTEM_INFO _oSystemInfo;
+                    GetNativeSystemInfo(&_oSystemInfo);
+                    _oInfo.cLogicalProcessors = _oSystemInfo.dwNumberOfProcessors;
+                }
+
+                // 与 Linux 相同，读取失败时也至少有一个 NUMA 节点
+                if (_oInfo.cNumaNodes == 0)
+                    _oInfo.cNumaNodes = 1;
+
+                return _oInfo;
+            }
+
+            static uint32_t __YYAPI QueryEffectiveProcessorCount(_In_ const ProcessorInfo& _oTopology) noexcept
+            {
+                uint32_t _cProcessors = _oTopology.cLogicalProcessors;
+
+                // 亲和性只能描述一个处理器组，与系统掩码相同时说明没有限制（可能跨越多个处理器组）
+                DWORD_PTR _fProcessMask = 0;
+                DWORD_PTR _fSystemMask = 0;
+                if (GetProcessAffinityMask(GetCurrentProcess(), &_fProcessMask, &_fSystemMask) && _fProcessMask && _fProcessMask != _fSystemMask)
+                {
+                    const auto _cAffinity = CountBits(_fProcessMask);
+                    if (_cAffinity < _cProcessors)
+                        _cProcessors = _cAffinity;
+                }
+
+                // 作业对象的 CPU 硬上限，CpuRate 以及 MaxRate 的单位都是全部处理器的万分之一
+                JOBOBJECT_CPU_RATE_CONTROL_INFORMATION _oCpuRate = {};
+                if (QueryInformationJobObject(NULL, JobObjectCpuRateControlInformation, &_oCpuRate, sizeof(_oCpuRate), nullptr)
+                    && (_oCpuRate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_ENABLE))
+                {
+                    uint32_t _uRate = 0;
+                    if (_oCpuRate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP)
+                        _uRate = _oCpuRate.CpuRate;
+                    else if (_oCpuRate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_MIN_MAX_RATE)
+                        _uRate = _oCpuRate.MaxRate;
+
+                    if (_uRate)
+                    {
+                        const auto _cLimit = uint32_t((uint64_t(_oTopology.cLogicalProcessors) * _uRate + 9999) / 10000);
+                        if (_cLimit < _cProcessors)
+                            _cProcessors = _cLimit;
+                    }
+                }
+
+                return _cProcessors;
+            }
+
+            uint32_t __YYAPI GetCurrentNumaNode() noexcept
+            {
+                PROCESSOR_NUMBER _oProcessorNumber;
+                GetCurrentProcessorNumberEx(&_oProcessorNumber);
+
+                USHORT _uNumaNode = 0;
+                if (!GetNumaProcessorNodeEx(&_oProcessorNumber, &_uNumaNode))
+                    return 0;
+
+                return _uNumaNode;
+            }
+#else
+            static bool __YYAPI ReadFileText(_In_z_ const char* _szPath, _Out_writes_(_cchBuffer) char* _szBuffer, _In_ size_t _cchBuffer) noexcept
+            {
+                _szBuffer[0] = '\0';
+                auto _pFile = fopen(_szPath, "re");
+                if (!_pFile)
+                    return false;
+
+                const auto _cchRead = fread(_szBuffer, 1, _cchBuffer - 1, _pFile);
+                fclose(_pFile);
+                _szBuffer[_cchRead] = '\0';
+                return _cchRead != 0;
+            }
+
+            static bool __YYAPI ReadFileUInt32(_In_z_ const char* _szPath, _Out_ uint32_t* _puValue) noexcept
+            {
+                *_puValue = 0;
+                char _szBuffer[64];
+                if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                    return false;
+
+                char* _szEnd;
+                *_puValue = uint32_t(strtoul(_szBuffer, &_szEnd, 10));
+                return _szEnd != _szBuffer;
+            }
+
+            /// <summary>
+            /// 解析内核使用的列表格式（比如 "0-3,8,10-11"），返回列表中的元素个数。
+            /// </summary>
+            static uint32_t __YYAPI CountListItems(_In_z_ const char* _szList, _Out_opt_ uint32_t* _puFirst = nullptr) noexcept
+            {
+                uint32_t _cItems = 0;
+                for (;;)
+                {
+                    char* _szEnd;
+                    const auto _uBegin = uint32_t(strtoul(_szList, &_szEnd, 10));
+                    if (_szEnd == _szList)
+                        break;
+
+                    auto _uEnd = _uBegin;
+                    if (*_szEnd == '-')
+                    {
+                        _szList = _szEnd + 1;
+                        _uEnd = uint32_t(strtoul(_szList, &_szEnd, 10));
+                        if (_szEnd == _szList)
+                            break;
+                    }
+
+                    if (_cItems == 0 && _puFirst)
+                        *_puFirst = _uBegin;
+
+                    if (_uEnd >= _uBegin)
+                        _cItems += _uEnd - _uBegin + 1;
+
+                    if (*_szEnd != ',')
+                        break;
+                    _szList = _szEnd + 1;
+                }
+
+                return _cItems;
+            }
+
+            static ProcessorInfo __YYAPI QueryProcessorTopology() noexcept
+            {
+                ProcessorInfo _oInfo;
+                _oInfo.cLogicalProcessors = uint32_t(get_nprocs());
+
+                char _szPath[PATH_MAX];
+                char _szBuffer[256];
+                const auto _cConfiguredProcessors = uint32_t(get_nprocs_conf());
+                for (uint32_t _uProcessor = 0; _uProcessor != _cConfiguredProcessors; ++_uProcessor)
+                {
+                    // 每个物理核心只统计编号最小的逻辑处理器
+                    snprintf(_szPath, sizeof(_szPath), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", _uProcessor);
+                    if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                        continue;
+
+                    uint32_t _uFirst = 0;
+                    const auto _cSiblings = CountListItems(_szBuffer, &_uFirst);
+                    if (_cSiblings == 0 || _uFirst != _uProcessor)
+                        continue;
+
+                    ++_oInfo.cPhysicalCores;
+                    if (_cSiblings > _oInfo.cSmtSiblings)
+                        _oInfo.cSmtSiblings = _cSiblings;
+                }
+
+                for (uint32_t _uIndex = 0;; ++_uIndex)
+                {
+                    snprintf(_szPath, sizeof(_szPath), "/sys/devices/system/cpu/cpu0/cache/index%u/type", _uIndex);
+                    if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                        break;
+
+                    if (strncmp(_szBuffer, "Data", 4) != 0 && strncmp(_szBuffer, "Unified", 7) != 0)
+                        continue;
+
+                    uint32_t _uLevel;
+                    snprintf(_szPath, sizeof(_szPath), "/sys/devices/system/cpu/cpu0/cache/index%u/level", _uIndex);
+                    if (!ReadFileUInt32(_szPath, &_uLevel))
+                        continue;
+
+                    // 大小的格式为 "32K"、"1024K" 或者 "32M"
+                    snprintf(_szPath, sizeof(_szPath), "/sys/devices/system/cpu/cpu0/cache/index%u/size", _uIndex);
+                    if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                        continue;
+
+                    char* _szUnit;
+                    uint32_t _cbSize = uint32_t(strtoul(_szBuffer, &_szUnit, 10));
+                    if (*_szUnit == 'K')
+                        _cbSize *= 1024;
+                    else if (*_szUnit == 'M')
+                        _cbSize *= 1024 * 1024;
+
+                    if (_uLevel == 1)
+                        _oInfo.cbL1DataCache = _cbSize;
+                    else if (_uLevel == 2)
+                        _oInfo.cbL2Cache = _cbSize;
+                    else if (_uLevel == 3)
+                        _oInfo.cbL3Cache = _cbSize;
+
+                    if (_oInfo.cbCacheLine == 0)
+                    {
+                        snprintf(_szPath, sizeof(_szPath), "/sys/devices/system/cpu/cpu0/cache/index%u/coherency_line_size", _uIndex);
+                        ReadFileUInt32(_szPath, &_oInfo.cbCacheLine);
+                    }
+                }
+
+                if (ReadFileText("/sys/devices/system/node/online", _szBuffer, sizeof(_szBuffer)))
+                    _oInfo.cNumaNodes = CountListItems(_szBuffer);
+
+                // 不支持 NUMA 的内核没有 /sys/devices/system/node
+                if (_oInfo.cNumaNodes == 0)
+                    _oInfo.cNumaNodes = 1;
+
+                return _oInfo;
+            }
+
+            static uint32_t __YYAPI MinCpuLimit(_In_ uint32_t _cLimit, _In_ uint32_t _cOtherLimit) noexcept
+            {
+                // 0 表示没有限制
+                if (_cLimit == 0)
+                    return _cOtherLimit;
+                if (_cOtherLimit == 0)
+                    return _cLimit;
+                return _cLimit < _cOtherLimit ? _cLimit : _cOtherLimit;
+            }
+
+            static uint32_t __YYAPI QuotaToCpuLimit(_In_ int64_t _iQuota, _In_ int64_t _iPeriod) noexcept
+            {
+                if (_iQuota <= 0 || _iPeriod <= 0)
+                    return 0;
+
+                // 配额不足一个处理器时仍然按一个处理器计算
+                return uint32_t((_iQuota + _iPeriod - 1) / _iPeriod);
+            }
+
+            // cgroup v2：cpu.max 的格式为 "$MAX $PERIOD"，$MAX 为 "max" 表示没有限制
+            static uint32_t __YYAPI ReadCGroupV2CpuLimit(_In_z_ const char* _szDirectory) noexcept
+            {
+                char _szPath[PATH_MAX];
+                char _szBuffer[64];
+                snprintf(_szPath, sizeof(_szPath), "%s/cpu.max", _szDirectory);
+                if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                    return 0;
+
+                char* _szEnd;
+                const auto _iQuota = strtoll(_szBuffer, &_szEnd, 10);
+                if (_szEnd == _szBuffer)
+                    return 0;
+
+                return QuotaToCpuLimit(_iQuota, strtoll(_szEnd, nullptr, 10));
+            }
+
+            // cgroup v1：cpu.cfs_quota_us 为 -1 表示没有限制
+            static uint32_t __YYAPI ReadCGroupV1CpuLimit(_In_z_ const char* _szDirectory) noexcept
+            {
+                char _szPath[PATH_MAX];
+                char _szBuffer[64];
+                snprintf(_szPath, sizeof(_szPath), "%s/cpu.cfs_quota_us", _szDirectory);
+                if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                    return 0;
+                const auto _iQuota = strtoll(_szBuffer, nullptr, 10);
+
+                snprintf(_szPath, sizeof(_szPath), "%s/cpu.cfs_period_us", _szDirectory);
+                if (!ReadFileText(_szPath, _szBuffer, sizeof(_szBuffer)))
+                    return 0;
+
+                return QuotaToCpuLimit(_iQuota, strtoll(_szBuffer, nullptr, 10));
+            }
+
+            /// <summary>
+            /// 从 _szMountPoint + _szCGroupPath 开始逐级向上读取 CPU 配额，返回其中最严格的限制。
+            /// 容器内 /proc/self/cgroup 中的路径可能属于宿主机，不存在的目录会被忽略，最终仍然会读取挂载点本身。
+            /// </summary>
+            static uint32_t __YYAPI GetCGroupCpuLimit(
+                _In_z_ const char* _szMountPoint,
+                _In_z_ const char* _szCGroupPath,
+                _In_ uint32_t(__YYAPI* _pfnReadCpuLimit)(const char* _szDirectory)) noexcept
+            {
+                char _szDirectory[PATH_MAX];
+                const auto _cchDirectory = snprintf(_szDirectory, sizeof(_szDirectory), "%s%s", _szMountPoint, _szCGroupPath);
+                if (_cchDirectory <= 0 || size_t(_cchDirectory) >= sizeof(_szDirectory))
+                    return 0;
+
+                const auto _cchMountPoint = strlen(_szMountPoint);
+                uint32_t _cLimit = 0;
+                for (;;)
+                {
+                    _cLimit = MinCpuLimit(_cLimit, _pfnReadCpuLimit(_szDirectory));
+
+                    auto _szSlash = strrchr(_szDirectory, '/');
+                    if (!_szSlash || size_t(_szSlash - _szDirectory) < _cchMountPoint)
+                        break;
+
+                    *_szSlash = '\0';
+                }
+
+                return _cLimit;
+            }
+
+            static bool __YYAPI HasCGroupController(_In_z_ const char* _szControllers, _In_z_ const char* _szController) noexcept
+            {
+                const auto _cchController = strlen(_szController);
+                for (auto _szItem = _szControllers;;)
+                {
+                    auto _szComma = strchr(_szItem, ',');
+                    const auto _cchItem = _szComma ? size_t(_szComma - _szItem) : strlen(_szItem);
+                    if (_cchItem == _cchController && strncmp(_szItem, _szController, _cchController) == 0)
+                        return true;
+
+                    if (!_szComma)
+                        return false;
+                    _szItem = _szComma + 1;
+                }
+            }
+
+            /// <summary>
+            /// 返回 cgroup CPU 配额对应的处理器数（向上取整），没有限制时返回 0。
+            /// </summary>
+            static uint32_t __YYAPI QueryCGroupCpuLimit() noexcept
+            {
+                char _szCGroups[4096];
+                if (!ReadFileText("/proc/self/cgroup", _szCGroups, sizeof(_szCGroups)))
+                    return 0;
+
+                uint32_t _cLimit = 0;
+                // 每行的格式为 "hierarchy-ID:controller-list:cgroup-path"，cgroup v2 的 controller-list 为空
+                for (auto _szLine = _szCGroups; *_szLine;)
+                {
+                    auto _szLineEnd = strchr(_szLine, '\n');
+                    if (_szLineEnd)
+                        *_szLineEnd = '\0';
+
+                    auto _szControllers = strchr(_szLine, ':');
+                    auto _szCGroupPath = _szControllers ? strchr(_szControllers + 1, ':') : nullptr;
+                    if (_szCGroupPath)
+                    {
+                        *_szCGroupPath++ = '\0';
+                        ++_szControllers;
+
+                        if (*_szControllers == '\0')
+                        {
+                            _cLimit = MinCpuLimit(_cLimit, GetCGroupCpuLimit("/sys/fs/cgroup", _szCGroupPath, ReadCGroupV2CpuLimit));
+                        }
+                        else if (HasCGroupController(_szControllers, "cpu"))
+                        {
+                            const auto _szMountPoint = access("/sys/fs/cgroup/cpu,cpuacct", F_OK) == 0 ? "/sys/fs/cgroup/cpu,cpuacct" : "/sys/fs/cgroup/cpu";
+                            _cLimit = MinCpuLimit(_cLimit, GetCGroupCpuLimit(_szMountPoint, _szCGroupPath, ReadCGroupV1CpuLimit));
+                        }
+                    }
+
+                    if (!_szLineEnd)
+                        break;
+                    _szLine = _szLineEnd + 1;
+                }
+
+                return _cLimit;
+            }
+
+            static uint32_t __YYAPI QueryEffectiveProcessorCount(_In_ const ProcessorInfo& _oTopology) noexcept
+            {
+                uint32_t _cProcessors = _oTopology.cLogicalProcessors;
+
+                cpu_set_t _oCpuSet;
+                CPU_ZERO(&_oCpuSet);
+                if (sched_getaffinity(0, sizeof(_oCpuSet), &_oCpuSet) == 0)
+                {
+                    const auto _cAffinity = uint32_t(CPU_COUNT(&_oCpuSet));
+                    if (_cAffinity)
+                        _cProcessors = _cAffinity;
+                }
+
+                return MinCpuLimit(_cProcessors, QueryCGroupCpuLimit());
+            }
+
+            uint32_t __YYAPI GetCurrentNumaNode() noexcept
+            {
+                unsigned _uProcessor = 0;
+                unsigned _uNumaNode = 0;
+                if (syscall(SYS_getcpu, &_uProcessor, &_uNumaNode, nullptr) != 0)
+                    return 0;
+
+                return _uNumaNode;
+            }
 #endif
+
+            static const ProcessorInfo& __YYAPI GetProcessorTopology() noexcept
+            {
+                static const ProcessorInfo s_oTopology = QueryProcessorTopology();
+                return s_oTopology;
+            }
+
+            // 有效处理器数的缓存，0 表示尚未读取
+            static volatile uint32_t g_cEffectiveProcessors = 0;
+            // 缓存过期的时间（秒）。使用 32 位保存，读写都是原子的，32 位平台上也不会读到撕裂的值
+            static volatile uint32_t g_uEffectiveProcessorsExpireSeconds = 0;
+            static volatile uint32_t g_fEffectiveProcessorsRefreshLock = 0;
+
+            uint32_t __YYAPI GetEffectiveProcessorCount() noexcept
+            {
+                constexpr uint32_t kRefreshIntervalSeconds = 1;
+
+                auto _cProcessors = g_cEffectiveProcessors;
+                const auto _uNowSeconds = uint32_t(TickCount::GetNow().GetTotalSeconds());
+                if (_cProcessors && _uNowSeconds < g_uEffectiveProcessorsExpireSeconds)
+                    return _cProcessors;
+
+                // 只允许一个线程刷新缓存。其他线程继续使用旧值，第一次读取时没有旧值，只能自己读取但不写入缓存
+                const bool _bLocked = !Sync::BitSet(&g_fEffectiveProcessorsRefreshLock, 0);
+                if (!_bLocked && _cProcessors)
+                    return _cProcessors;
+
+                _cProcessors = QueryEffectiveProcessorCount(GetProcessorTopology());
+                if (_cProcessors == 0)
+                    _cProcessors = 1;
+
+                if (_bLocked)
+                {
+                    Sync::Exchange(&g_cEffectiveProcessors, _cProcessors);
+                    Sync::Exchange(&g_uEffectiveProcessorsExpireSeconds, _uNowSeconds + kRefreshIntervalSeconds);
+                    Sync::BitReset(&g_fEffectiveProcessorsRefreshLock, 0);
+                }
+
+                return _cProcessors;
+            }
+
+            ProcessorInfo __YYAPI GetProcessorInfo() noexcept
+            {
+                auto _oInfo = GetProcessorTopology();
+                _oInfo.cEffectiveProcessors = GetEffectiveProcessorCount();
+                return _oInfo;
+            }
         }
     }
 }